@@ -0,0 +1,1455 @@
+// Directed tests for the Dock emulator. The irq_router, top_integration and
+// addr_decoder sections replay the RTL testbenches (HDL/src/*_tb.v) with the
+// same stimulus and expected values; the rest checks the transaction-mode
+// waits against the cycle model (single Docks and chains behind BRIDGE
+// windows) and loads a map built by ubitz_build_*_map.
+//
+// dock_emu_test --record <file> writes the model's pin vectors, which
+// HDL/src/top_vectors_tb.v replays through top; --replay <file> checks the
+// model against a recording (by ctest, against its own).
+#include "ubitz_dock_emu.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void fail(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    fputs("FAIL: ", stderr);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+    exit(1);
+}
+
+#define CHECK(cond, ...) do { if (!(cond)) fail(__VA_ARGS__); } while (0)
+
+// ------------------------------------------------------------------
+// irq_router_tb
+// ------------------------------------------------------------------
+
+static ubitz_emu_t s_e;
+
+// cfg_write/cfg_read tasks take two clk edges; the write lands on the second.
+static void tb_cfg_write(ubitz_emu_t *e, uint8_t idx, uint8_t d) {
+    ubitz_emu_advance(e, 1);
+    ubitz_emu_cfg_write(e, (uint8_t)(e->p.irq_base + idx), d);
+    ubitz_emu_advance(e, 1);
+}
+
+static uint8_t tb_cfg_read(ubitz_emu_t *e, uint8_t idx) {
+    ubitz_emu_advance(e, 2);
+    return ubitz_emu_cfg_read(e, (uint8_t)(e->p.irq_base + idx));
+}
+
+static void route_int(ubitz_emu_t *e, int slot, int ch, int en, int cpu) {
+    tb_cfg_write(e, (uint8_t)(slot * e->p.num_int_ch + ch), (uint8_t)((en ? 0x80 : 0x00) | cpu));
+}
+
+static void route_nmi(ubitz_emu_t *e, int slot, int en, int cpu) {
+    tb_cfg_write(e, (uint8_t)(e->num_int_src + slot), (uint8_t)((en ? 0x80 : 0x00) | cpu));
+}
+
+static void coal_snapshot(ubitz_emu_t *e, int slot, int ch, uint8_t *deliv, uint8_t *hits) {
+    tb_cfg_write(e, e->coal_snap, (uint8_t)(slot * e->p.num_int_ch + ch));
+    ubitz_emu_advance(e, 5);
+    *deliv = tb_cfg_read(e, (uint8_t)(e->coal_snap + 1));
+    *hits  = tb_cfg_read(e, (uint8_t)(e->coal_snap + 2));
+}
+
+static int pulse_irq_ack(ubitz_emu_t *e) {
+    ubitz_emu_advance(e, 1);
+    int slot = ubitz_emu_irq_ack(e);
+    ubitz_emu_advance(e, 1);
+    return slot;
+}
+
+static void test_irq_router(void) {
+    ubitz_emu_t *e = &s_e;
+    ubitz_emu_params_t p;
+    uint8_t rd, deliv, hits;
+    ubitz_emu_default_params(&p);
+    p.num_slots   = 3;
+    p.num_cpu_int = 2;
+    p.num_cpu_nmi = 1;
+    p.num_int_ch  = 2;
+    p.coal_tick_w = 2;
+    CHECK(ubitz_emu_init(e, &p), "irq_router params rejected");
+    const uint8_t coal_off = e->coal_off;
+    ubitz_emu_advance(e, 1);
+
+    // Test 0: reset defaults
+    CHECK(ubitz_emu_cpu_int(e) == 0 && ubitz_emu_cpu_nmi(e) == 0, "Test0: outputs not idle");
+
+    // Test 1: basic INT route and deassert
+    route_int(e, 0, 0, 1, 0);
+    ubitz_emu_advance(e, 1);
+    ubitz_emu_set_int(e, 0, 0, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0x1 && ubitz_emu_cpu_nmi(e) == 0, "Test1: cpu_int=%x", ubitz_emu_cpu_int(e));
+    ubitz_emu_set_int(e, 0, 0, false);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0, "Test1: cpu_int did not clear");
+
+    // Test 2: no queuing
+    route_int(e, 1, 0, 1, 1);
+    ubitz_emu_advance(e, 1);
+    ubitz_emu_set_int(e, 0, 0, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0x1, "Test2: expected INT0 active");
+    ubitz_emu_set_int(e, 1, 0, true);
+    ubitz_emu_advance(e, 1);
+    ubitz_emu_set_int(e, 1, 0, false);
+    ubitz_emu_advance(e, 1);
+    ubitz_emu_set_int(e, 0, 0, false);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0, "Test2: queued INT appeared cpu_int=%x", ubitz_emu_cpu_int(e));
+
+    // Test 3: unrouted ignored
+    route_int(e, 1, 0, 0, 0);
+    ubitz_emu_set_int(e, 1, 0, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0, "Test3: unrouted IRQ drove cpu_int");
+    route_int(e, 0, 0, 1, 0);
+    ubitz_emu_set_int(e, 0, 0, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0x1, "Test3: routed IRQ did not assert after unrouted");
+    ubitz_emu_set_int(e, 0, 0, false);
+    ubitz_emu_set_int(e, 1, 0, false);
+    ubitz_emu_advance(e, 1);
+
+    // Test 4: NMI priority over INT
+    route_nmi(e, 1, 1, 0);
+    route_int(e, 0, 0, 1, 0);
+    ubitz_emu_set_int(e, 0, 0, true);
+    ubitz_emu_set_nmi(e, 1, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_nmi(e) == 0x1 && ubitz_emu_cpu_int(e) == 0, "Test4: NMI not prioritized");
+    ubitz_emu_set_nmi(e, 1, false);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0x1, "Test4: INT not promoted after NMI cleared");
+    ubitz_emu_set_int(e, 0, 0, false);
+    ubitz_emu_advance(e, 1);
+
+    // Test 5: only one active at a time, two INTs
+    route_int(e, 1, 0, 1, 1);
+    ubitz_emu_set_int(e, 0, 0, true);
+    ubitz_emu_set_int(e, 1, 0, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0x1, "Test5: expected slot0 first");
+    ubitz_emu_set_int(e, 0, 0, false);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0x2, "Test5: expected slot1 promoted");
+    ubitz_emu_set_int(e, 1, 0, false);
+    ubitz_emu_advance(e, 1);
+
+    // Test 6: ack routing and does not clear
+    route_int(e, 0, 0, 1, 0);
+    ubitz_emu_set_int(e, 0, 0, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(pulse_irq_ack(e) == 0, "Test6: slot_ack not on slot0");
+    CHECK(ubitz_emu_cpu_int(e) == 0x1, "Test6: cpu_int cleared after ack");
+    ubitz_emu_set_int(e, 0, 0, false);
+    ubitz_emu_advance(e, 2);
+
+    // Test 7: ack when idle
+    CHECK(pulse_irq_ack(e) == -1, "Test7: slot_ack pulsed while idle");
+
+    // Test 8: reconfig disable while pending but not active
+    route_int(e, 0, 0, 1, 0);
+    route_int(e, 1, 0, 1, 1);
+    ubitz_emu_set_int(e, 0, 0, true);
+    ubitz_emu_advance(e, 1);
+    ubitz_emu_set_int(e, 1, 0, true);
+    ubitz_emu_advance(e, 1);
+    route_int(e, 1, 0, 0, 0);
+    ubitz_emu_advance(e, 1);
+    ubitz_emu_set_int(e, 0, 0, false);
+    ubitz_emu_set_int(e, 1, 0, false);
+    ubitz_emu_advance(e, 3);
+    CHECK(ubitz_emu_cpu_int(e) == 0, "Test8: disabled pending IRQ became active");
+    ubitz_emu_advance(e, 1);
+
+    // Test 9: out-of-range CPU index should not drive pins but still ack/block
+    route_int(e, 0, 0, 1, 3);
+    ubitz_emu_set_int(e, 0, 0, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0, "Test9: out-of-range route drove cpu_int");
+    CHECK(pulse_irq_ack(e) == 0, "Test9: slot_ack not pulsed for out-of-range route");
+    ubitz_emu_set_int(e, 0, 0, false);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0, "Test9: cpu_int not zero after clear");
+
+    // Test 10: minimum-gap coalescing (mode 0, 3 ticks) on slot0 ch0
+    route_int(e, 0, 0, 1, 0);
+    tb_cfg_write(e, coal_off, 0x03);
+    rd = tb_cfg_read(e, coal_off);
+    CHECK(rd == 0x03, "Test10: coalescing byte read back %02x", rd);
+    rd = tb_cfg_read(e, 0);
+    CHECK(rd == 0x80, "Test10: route entry read back %02x", rd);
+    coal_snapshot(e, 0, 0, &deliv, &hits);
+    ubitz_emu_set_int(e, 0, 0, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0x1, "Test10: first INT not delivered");
+    ubitz_emu_set_int(e, 0, 0, false);
+    ubitz_emu_advance(e, 2);
+    ubitz_emu_set_int(e, 0, 0, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0, "Test10: INT delivered inside min gap");
+    ubitz_emu_advance(e, 16);
+    CHECK(ubitz_emu_cpu_int(e) == 0x1, "Test10: INT not delivered after gap");
+    ubitz_emu_set_int(e, 0, 0, false);
+    ubitz_emu_advance(e, 2);
+    coal_snapshot(e, 0, 0, &deliv, &hits);
+    CHECK(deliv == 2 && hits == 1, "Test10: counters delivered=%u coalesced=%u", deliv, hits);
+    tb_cfg_write(e, coal_off, 0x00);
+
+    // Test 11: hold-off coalescing (mode 1, 2 ticks) on slot1 ch0
+    route_int(e, 1, 0, 1, 1);
+    tb_cfg_write(e, (uint8_t)(coal_off + 2), 0x82);
+    coal_snapshot(e, 1, 0, &deliv, &hits);
+    ubitz_emu_set_int(e, 1, 0, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0, "Test11: INT not held off");
+    ubitz_emu_set_int(e, 1, 0, false);
+    ubitz_emu_advance(e, 1);
+    ubitz_emu_set_int(e, 1, 0, true);
+    ubitz_emu_advance(e, 12);
+    CHECK(ubitz_emu_cpu_int(e) == 0x2, "Test11: INT not delivered after hold-off");
+    ubitz_emu_set_int(e, 1, 0, false);
+    ubitz_emu_advance(e, 2);
+    coal_snapshot(e, 1, 0, &deliv, &hits);
+    CHECK(deliv == 1 && hits == 1, "Test11: counters delivered=%u coalesced=%u", deliv, hits);
+    tb_cfg_write(e, (uint8_t)(coal_off + 2), 0x00);
+}
+
+// ------------------------------------------------------------------
+// Cycle-mode helpers (top_integration_tb / addr_decoder_tb tasks)
+// ------------------------------------------------------------------
+
+static ubitz_emu_pins_in_t  s_in;
+static ubitz_emu_pins_out_t s_out;
+
+static void clk(ubitz_emu_t *e, int n) {
+    while (n-- > 0) {
+        ubitz_emu_clock(e, &s_in, &s_out);
+    }
+}
+
+static void idle_pins(ubitz_emu_t *e) {
+    memset(&s_in, 0, sizeof(s_in));
+    s_in.iorq_n      = true;
+    s_in.mreq_n      = true;
+    s_in.r_w_        = true;
+    s_in.dev_ready_n = (uint8_t)((1u << e->p.num_slots) - 1);
+}
+
+static void io_cycle_expect_slot(ubitz_emu_t *e, uint32_t a, bool rd, int slot) {
+    s_in.addr   = a;
+    s_in.r_w_   = rd;
+    s_in.iorq_n = true;
+    clk(e, 1);
+    s_in.iorq_n = false;
+    clk(e, 1);
+    CHECK(!((s_out.cs_n >> slot) & 1), "addr %02x: slot %d not selected cs_n=%02x", a, slot, s_out.cs_n);
+    s_in.iorq_n = true;
+    clk(e, 1);
+    CHECK(s_out.cs_n == (uint8_t)((1u << e->p.num_slots) - 1), "cs_n did not return idle: %02x", s_out.cs_n);
+}
+
+// Host cycle that waits for /READY; returns read data (0xFF when nothing
+// drives dock_dout) and the clocks until /READY (1 = no wait) in *clks.
+static uint8_t host_io(ubitz_emu_t *e, uint32_t a, bool rd, uint8_t wd, int *clks) {
+    int n = 0;
+    s_in.addr     = a;
+    s_in.r_w_     = rd;
+    s_in.dock_din = wd;
+    s_in.iorq_n   = false;
+    clk(e, 1);
+    do {
+        clk(e, 1);
+        CHECK(++n <= 20, "host_io: no /READY at addr %02x", a);
+    } while (!s_out.ready_n);
+    uint8_t d = s_out.dock_doe ? s_out.dock_dout : 0xFF;
+    if (clks) {
+        *clks = n;
+    }
+    s_in.iorq_n = true;
+    clk(e, 2);
+    return d;
+}
+
+// ------------------------------------------------------------------
+// top_integration_tb (decoder/router sections; trace and services are not
+// modelled and report as absent)
+// ------------------------------------------------------------------
+
+static void init_tb_build(ubitz_emu_t *e, uint8_t slots, uint8_t ch, uint8_t irq_base,
+                          const uint8_t *cfg_init) {
+    ubitz_emu_params_t p;
+    ubitz_emu_default_params(&p);
+    p.addr_w      = 8;
+    p.num_win     = 4;
+    p.num_range_win = 4;
+    p.num_slots   = slots;
+    p.num_cpu_int = 2;
+    p.num_cpu_nmi = 1;
+    p.num_int_ch  = ch;
+    p.irq_base    = irq_base;
+    p.cfg_init    = cfg_init;
+    CHECK(ubitz_emu_init(e, &p), "top params rejected");
+    idle_pins(e);
+    clk(e, 4);
+}
+
+static void test_top_integration(void) {
+    ubitz_emu_t *e = &s_e;
+    int n;
+    uint8_t d;
+    init_tb_build(e, 3, 2, 0xC0, NULL);
+
+    ubitz_emu_cfg_write(e, 0x00, 0x10);
+    ubitz_emu_cfg_write(e, 0x04, 0xF0);
+    ubitz_emu_cfg_write(e, 0x08, 0x01);
+    ubitz_emu_cfg_write(e, 0x0C, 0xFF);
+    ubitz_emu_cfg_write(e, 0xC0 + 2, 0x80); // slot1,ch0 -> INT0
+
+    io_cycle_expect_slot(e, 0x10, true, 1);
+    ubitz_emu_set_int(e, 1, 0, true);
+    clk(e, 2);
+    CHECK(s_out.cpu_int == 0x1, "cpu_int not asserted for slot1,ch0: %x", s_out.cpu_int);
+    ubitz_emu_set_int(e, 1, 0, false);
+    clk(e, 2);
+    CHECK(s_out.cpu_int == 0, "cpu_int did not clear");
+
+    // Capability block and IRQ readback
+    CHECK(ubitz_emu_cfg_read(e, 0x00) == 0x55 && ubitz_emu_cfg_read(e, 0x01) == 0x44, "cap magic");
+    CHECK(ubitz_emu_cfg_read(e, 0x06) == 3, "cap NUM_SLOTS");
+    CHECK(ubitz_emu_cfg_read(e, 0x07) == 2, "cap NUM_TILE_INT_CH");
+    CHECK(ubitz_emu_cfg_read(e, 0x0A) == 0xC0, "cap IRQ_CFG_BASE");
+    CHECK(ubitz_emu_cfg_read(e, 0x0E) == 0x08, "cap SLOT_OFF");
+    CHECK(ubitz_emu_cfg_read(e, 0x11) == 0x09, "cap IRQ COAL_OFF");
+    CHECK(ubitz_emu_cfg_read(e, 0xC0 + 2) == 0x80, "IRQ route readback");
+    CHECK(ubitz_emu_cfg_read(e, 0x15) == 0x00, "cap TRACE_CFG_BASE (trace not modelled)");
+    CHECK(ubitz_emu_cfg_read(e, 0x18) == 0xFF, "cap SVC_SLOT (services not modelled)");
+
+    // Window 1 -> services slot 0, as programmed by the tb (otherwise its
+    // power-on catch-all would shadow window 2)
+    ubitz_emu_cfg_write(e, 0x01, 0x30);
+    ubitz_emu_cfg_write(e, 0x05, 0xF0);
+    ubitz_emu_cfg_write(e, 0x09, 0x00);
+    ubitz_emu_cfg_write(e, 0x0D, 0xFF);
+
+    // IRQ status window: window 2 (0x40-0x4F) flagged DOCK
+    ubitz_emu_cfg_write(e, 0x02, 0x40);
+    ubitz_emu_cfg_write(e, 0x06, 0xF0);
+    ubitz_emu_cfg_write(e, 0x0A, 0x20);
+    ubitz_emu_cfg_write(e, 0x0E, 0xFF);
+    ubitz_emu_cfg_write(e, 0xC0 + 3, 0x80); // slot1,ch1 -> INT0
+
+    d = host_io(e, 0x40, true, 0, &n);
+    CHECK(d == 0x00 && n == 1, "CAUSE idle=%02x in %d clocks", d, n);
+    ubitz_emu_set_int(e, 1, 0, true);
+    ubitz_emu_set_int(e, 1, 1, true);
+    clk(e, 3);
+    d = host_io(e, 0x40, true, 0, &n);
+    CHECK(d == 0x84 && n == 1, "CAUSE=%02x in %d clocks, expected slot1 ch0", d, n);
+    CHECK(s_out.cs_n == 0x7, "IRQ status read drove cs_n=%02x", s_out.cs_n);
+    d = host_io(e, 0x44, true, 0, NULL);
+    CHECK(d == 0x0C, "INT_PENDING[7:0]=%02x", d);
+
+    host_io(e, 0x48, false, 0x04, &n);
+    CHECK(n == 1, "IRQ mask write took %d clocks", n);
+    d = host_io(e, 0x48, true, 0, NULL);
+    CHECK(d == 0x04, "INT_MASK[7:0]=%02x", d);
+    d = host_io(e, 0x40, true, 0, NULL);
+    CHECK(d == 0x85, "CAUSE after mask=%02x", d);
+    d = host_io(e, 0x44, true, 0, NULL);
+    CHECK(d == 0x08, "INT_PENDING[7:0] after mask=%02x", d);
+    CHECK(s_out.cpu_int == 0x1, "cpu_int after mask=%x", s_out.cpu_int);
+
+    ubitz_emu_set_int(e, 1, 1, false);
+    clk(e, 3);
+    CHECK(s_out.cpu_int == 0, "masked route still drives cpu_int=%x", s_out.cpu_int);
+    host_io(e, 0x48, false, 0x00, NULL);
+    clk(e, 3);
+    CHECK(s_out.cpu_int == 0x1, "unmasked route not delivered: cpu_int=%x", s_out.cpu_int);
+    ubitz_emu_set_int(e, 1, 0, false);
+    clk(e, 3);
+    d = host_io(e, 0x40, true, 0, NULL);
+    CHECK(d == 0x00 && s_out.cpu_int == 0, "CAUSE=%02x cpu_int=%x after clear", d, s_out.cpu_int);
+
+    // A Host that keeps /IORQ low between cycles: the next DOCK access holds
+    // /READY low for a clock while the pending write is applied, instead of
+    // overwriting it
+    s_in.addr     = 0x48;
+    s_in.r_w_     = false;
+    s_in.dock_din = 0x02;
+    s_in.iorq_n   = false;
+    clk(e, 2);
+    s_in.addr     = 0x49;
+    s_in.dock_din = 0x00;
+    ubitz_emu_eval(e, &s_in, &s_out);
+    CHECK(!s_out.ready_n, "DOCK write over a pending one not stalled");
+    clk(e, 1);
+    CHECK(s_out.ready_n, "DOCK write stalled after the pending write was applied");
+    clk(e, 1);
+    s_in.addr = 0x48;
+    s_in.r_w_ = true;
+    ubitz_emu_eval(e, &s_in, &s_out);
+    CHECK(!s_out.ready_n, "DOCK read over a pending write not stalled");
+    clk(e, 1);
+    CHECK(s_out.ready_n && s_out.dock_doe && s_out.dock_dout == 0x02,
+          "INT_MASK[7:0]=%02x after back-to-back writes", s_out.dock_dout);
+    s_in.iorq_n = true;
+    clk(e, 2);
+    host_io(e, 0x48, false, 0x00, NULL);
+
+    // Transaction mode agrees on the same state
+    ubitz_emu_access_t acc;
+    ubitz_emu_io(e, 0x44, true, 0, false, &acc);
+    CHECK(acc.flags == UBITZ_EMU_F_DOCK && acc.wait == 0 && acc.data == 0x00, "io DOCK read");
+    CHECK(ubitz_emu_cfg_read(e, 0x14) == 0xA7, "features=%02x", ubitz_emu_cfg_read(e, 0x14));
+    CHECK(ubitz_emu_cfg_read(e, 0x1A) == 0x00, "sum1 without baked map");
+
+    // 8-slot / 4-channel build programmed from its capability block
+    init_tb_build(e, 8, 4, 0xA0, NULL);
+    uint8_t irq_base = ubitz_emu_cfg_read(e, 0x0A), num_ch = ubitz_emu_cfg_read(e, 0x07);
+    CHECK(ubitz_emu_cfg_read(e, 0x06) == 8 && num_ch == 4 && irq_base == 0xA0, "dut8 caps");
+    ubitz_emu_cfg_write(e, 0x00, 0x70);
+    ubitz_emu_cfg_write(e, ubitz_emu_cfg_read(e, 0x0D), 0xF0);
+    ubitz_emu_cfg_write(e, ubitz_emu_cfg_read(e, 0x0E), 0x07);
+    ubitz_emu_cfg_write(e, ubitz_emu_cfg_read(e, 0x0F), 0xFF);
+    ubitz_emu_cfg_write(e, (uint8_t)(irq_base + 7 * num_ch + 3), 0x81);
+    s_in.addr   = 0x70;
+    s_in.iorq_n = false;
+    clk(e, 1);
+    CHECK(s_out.cs_n == 0x7F, "dut8: slot 7 not selected cs_n=%02x", s_out.cs_n);
+    s_in.iorq_n = true;
+    ubitz_emu_set_int(e, 7, 3, true);
+    clk(e, 2);
+    CHECK(s_out.cpu_int == 0x2, "dut8: slot7,ch3 not routed to INT1 cpu_int=%x", s_out.cpu_int);
+
+    // Baked map: decodes and routes with no config writes
+    static uint8_t img[256];
+    memset(img, 0, sizeof(img));
+    img[0x00] = 0x60;
+    img[0x04] = 0xF0;
+    img[0x08] = 0x02;
+    memset(img + 0x0C, 0xFF, 4);
+    img[0x10] = 0xE0;                       // Bank region 0: ROM0 0xE0-0xFF
+    img[0x14] = 0xA5;
+    img[0xC0 + 2 * 2] = 0x81;
+    init_tb_build(e, 3, 2, 0xC0, img);
+    s_in.addr   = 0x65;
+    s_in.iorq_n = false;
+    clk(e, 1);
+    CHECK(s_out.cs_n == 0x3, "baked map: slot 2 not selected cs_n=%02x", s_out.cs_n);
+    s_in.iorq_n = true;
+    s_in.mreq_n = false;
+    ubitz_emu_eval(e, &s_in, &s_out);
+    CHECK(s_out.bank_cs_n, "baked map: Bank selected at 0x65");
+    s_in.addr = 0xE7;
+    ubitz_emu_eval(e, &s_in, &s_out);
+    CHECK(!s_out.bank_cs_n && s_out.mem0_cs_n && !s_out.mem1_cs_n, "baked map: ROM0 region");
+    s_in.mreq_n = true;
+    ubitz_emu_set_int(e, 2, 0, true);
+    clk(e, 2);
+    CHECK(s_out.cpu_int == 0x2, "baked map: slot2,ch0 not routed to INT1");
+    CHECK(ubitz_emu_cfg_read(e, 0x14) & 0x40, "baked map: feature bits");
+    CHECK(ubitz_emu_cfg_read(e, 0x1A) == 0x5B && ubitz_emu_cfg_read(e, 0x1B) == 0xED,
+          "baked map: sum=%02x%02x", ubitz_emu_cfg_read(e, 0x1B), ubitz_emu_cfg_read(e, 0x1A));
+    ubitz_emu_set_int(e, 2, 0, false);
+    clk(e, 2);
+    ubitz_emu_cfg_write(e, 0xC0 + 4, 0x80); // MCU moves the route
+    ubitz_emu_reset(e);                     // reset restores the baked route
+    CHECK(ubitz_emu_cfg_read(e, 0xC0 + 4) == 0x81, "baked route not restored by reset");
+
+    // Bank regions: ROM0/ROM1/ROM2 overlays on a RAM region covering all
+    init_tb_build(e, 3, 2, 0xC0, NULL);
+    uint8_t mem_off = ubitz_emu_cfg_read(e, 0x1D);
+    CHECK(mem_off == 0x10 && ubitz_emu_cfg_read(e, 0x1E) == 4, "bank: cap region offset=%02x",
+          mem_off);
+    static const uint8_t regions[4][2] = { { 0xE0, 0xA5 }, { 0xC0, 0xC4 },
+                                           { 0xD0, 0xE4 }, { 0x00, 0x88 } };
+    for (int r = 0; r < 4; ++r) {
+        ubitz_emu_cfg_write(e, (uint8_t)(mem_off + r), regions[r][0]);
+        ubitz_emu_cfg_write(e, (uint8_t)(mem_off + 4 + r), regions[r][1]);
+    }
+    static const struct { uint8_t addr, pins; } bank_pins[] = {
+        { 0x10, 0x2 }, { 0xE5, 0x1 }, { 0xC3, 0x0 }, { 0xDF, 0x3 }, // {MEM1, MEM0}
+    };
+    s_in.mreq_n = false;
+    for (size_t i = 0; i < sizeof(bank_pins) / sizeof(bank_pins[0]); ++i) {
+        s_in.addr = bank_pins[i].addr;
+        ubitz_emu_eval(e, &s_in, &s_out);
+        uint8_t pins = (uint8_t)((s_out.mem1_cs_n << 1) | s_out.mem0_cs_n);
+        CHECK(!s_out.bank_cs_n && pins == bank_pins[i].pins, "bank: %02x pins=%x",
+              bank_pins[i].addr, pins);
+    }
+    s_in.addr = 0x10;
+    for (int i = 0; i < 4; ++i) {
+        clk(e, 1);
+        CHECK(s_out.ready_n && s_out.cs_n == 0x7 && !s_out.bank_cs_n,
+              "bank: memory cycle ready_n=%d cs_n=%x", s_out.ready_n, s_out.cs_n);
+    }
+    s_in.iorq_n = false;
+    ubitz_emu_eval(e, &s_in, &s_out);
+    CHECK(s_out.bank_cs_n && s_out.mem0_cs_n && s_out.mem1_cs_n, "bank: selected with /IORQ low");
+    s_in.iorq_n = true;
+    s_in.mreq_n = true;
+    ubitz_emu_eval(e, &s_in, &s_out);
+    CHECK(s_out.bank_cs_n && s_out.mem0_cs_n && s_out.mem1_cs_n, "bank: selected without /MREQ");
+    ubitz_emu_cfg_write(e, (uint8_t)(mem_off + 7), 0x08);
+    uint8_t space = 0xFF;
+    CHECK(ubitz_emu_mem(e, 0x10, NULL) < 0, "bank: disabled region selected");
+    CHECK(ubitz_emu_mem(e, 0xE0, &space) == 0 && space == UBITZ_MEM_ROM0, "bank: ROM0 lost");
+}
+
+// ------------------------------------------------------------------
+// addr_decoder_tb (decode, priority, OP gating, ranges, posted writes)
+// ------------------------------------------------------------------
+
+static void init_decoder_tb(ubitz_emu_t *e) {
+    ubitz_emu_params_t p;
+    ubitz_emu_default_params(&p);
+    p.addr_w = 8;
+    p.num_win = 4;
+    p.num_range_win = 4;
+    CHECK(ubitz_emu_init(e, &p), "decoder params rejected");
+    static const uint8_t prog[][2] = {
+        { 0x00, 0x10 }, { 0x04, 0xF0 }, { 0x08, 1 },
+        { 0x01, 0x20 }, { 0x05, 0xF0 }, { 0x09, 2 },
+        { 0x02, 0x30 }, { 0x06, 0xF0 }, { 0x0A, 3 },
+        { 0x03, 0x00 }, { 0x07, 0x00 }, { 0x0B, 4 },
+        { 0x0C, 0x01 },                              // window 0 read-only
+    };
+    for (size_t i = 0; i < sizeof(prog) / sizeof(prog[0]); ++i) {
+        ubitz_emu_cfg_write(e, prog[i][0], prog[i][1]);
+    }
+    idle_pins(e);
+    clk(e, 2);
+}
+
+static void expect_io(ubitz_emu_t *e, uint32_t a, bool rd, int slot) {
+    ubitz_emu_access_t acc;
+    ubitz_emu_io(e, a, rd, 0x00, false, &acc);
+    CHECK(acc.slot == slot, "addr %02x %s: slot %d, expected %d", a, rd ? "rd" : "wr", acc.slot, slot);
+    io_cycle_expect_slot(e, a, rd, slot);
+}
+
+static void test_addr_decoder(void) {
+    ubitz_emu_t *e = &s_e;
+    init_decoder_tb(e);
+    expect_io(e, 0x10, true, 1);
+    expect_io(e, 0x23, true, 2);
+    expect_io(e, 0x3F, true, 3);
+    expect_io(e, 0x70, true, 4);  // catch-all
+
+    ubitz_emu_cfg_write(e, 0x01, 0x10);
+    ubitz_emu_cfg_write(e, 0x09, 0x00);
+    expect_io(e, 0x12, true, 1);  // window 0 wins the overlap
+    ubitz_emu_cfg_write(e, 0x01, 0x20);
+    ubitz_emu_cfg_write(e, 0x09, 0x02);
+
+    expect_io(e, 0x10, false, 4); // write falls through the read-only window
+    expect_io(e, 0x10, true, 1);
+
+    ubitz_emu_cfg_write(e, 0x02, 0x48);
+    ubitz_emu_cfg_write(e, 0x06, 0x5B);
+    ubitz_emu_cfg_write(e, 0x0A, 0x83); // range window -> slot 3
+    expect_io(e, 0x48, true, 3);
+    expect_io(e, 0x51, false, 3);
+    expect_io(e, 0x5B, true, 3);
+    expect_io(e, 0x47, true, 4);
+    expect_io(e, 0x5C, true, 4);
+    expect_io(e, 0x30, true, 4);
+
+    // Unmapped reads get the filler with no Tile and no wait
+    ubitz_emu_cfg_write(e, 0x0F, 0x00); // catch-all write-only
+    ubitz_emu_access_t acc;
+    ubitz_emu_io(e, 0x70, true, 0, false, &acc);
+    CHECK(acc.flags == UBITZ_EMU_F_UNMAPPED && acc.data == 0xFF && acc.wait == 0 &&
+          acc.slot == UBITZ_EMU_NO_SLOT, "unmapped read flags=%x data=%02x", acc.flags, acc.data);
+    s_in.addr   = 0x70;
+    s_in.r_w_   = true;
+    s_in.iorq_n = false;
+    clk(e, 2);
+    CHECK(!s_out.ff_oe_n && s_out.data_oe_n && s_out.ready_n && s_out.cs_n == 0x1F,
+          "unmapped read: ff_oe_n=%d data_oe_n=%d", s_out.ff_oe_n, s_out.data_oe_n);
+    s_in.iorq_n = true;
+    clk(e, 2);
+}
+
+// ------------------------------------------------------------------
+// Transaction-mode waits against the cycle model
+// ------------------------------------------------------------------
+
+static uint32_t s_busy;
+static uint8_t  s_last;
+
+static uint32_t tile_read(void *ctx, uint32_t addr, bool vector, uint8_t *data) {
+    (void)ctx;
+    *data = (uint8_t)(vector ? 0xE0 : addr ^ 0x5A);
+    return s_busy;
+}
+
+static uint32_t tile_write(void *ctx, uint32_t addr, uint8_t data) {
+    (void)ctx;
+    (void)addr;
+    s_last = data;
+    return s_busy;
+}
+
+// Clocks /READY is low for a Host cycle at addr; the Tile on slot keeps its
+// ready low until `busy` clocks after the first edge (/CS for normal cycles,
+// the drain /CS for posted ones, which starts one edge later).
+static uint32_t cycle_wait(ubitz_emu_t *e, uint32_t a, bool rd, uint8_t slot,
+                           uint32_t busy, uint32_t release_at) {
+    uint32_t low = 0, t = 0;
+    s_in.addr   = a;
+    s_in.r_w_   = rd;
+    s_in.iorq_n = false;
+    do {
+        if (busy && t == release_at) {
+            s_in.dev_ready_n |= (uint8_t)(1u << slot);
+        }
+        clk(e, 1);
+        ++t;
+        low += !s_out.ready_n;
+        CHECK(t < 64, "cycle_wait: no /READY at %02x", a);
+    } while (!s_out.ready_n);
+    return low;
+}
+
+static void test_waits(void) {
+    ubitz_emu_t *e = &s_e;
+    ubitz_emu_tile_t tile = { tile_read, tile_write, NULL, NULL };
+    ubitz_emu_access_t acc;
+
+    // Mapped cycles to a Tile that is busy for B clocks from /CS
+    for (uint32_t b = 0; b <= 6; ++b) {
+        init_decoder_tb(e);
+        ubitz_emu_attach(e, 2, &tile);
+        s_busy = b;
+        ubitz_emu_io(e, 0x21, true, 0, false, &acc);
+        CHECK(acc.slot == 2 && acc.data == (0x21 ^ 0x5A), "io read slot=%d data=%02x", acc.slot, acc.data);
+        if (b) {
+            s_in.dev_ready_n &= (uint8_t)~(1u << 2);
+            clk(e, 3); // level-style not-ready Tile, seen through the synchronizer
+        }
+        uint32_t w = cycle_wait(e, 0x21, true, 2, b, b + 1);
+        CHECK(acc.wait == w, "busy %u: transaction wait %u, cycle model %u", b, acc.wait, w);
+        s_in.iorq_n = true;
+        clk(e, 2);
+    }
+
+    // Posted write to slot 2 (its Tile busy B clocks from the drain /CS), then
+    // after `idle` clocks with /IORQ high a read of slot 1
+    for (uint32_t b = 0; b <= 4; ++b) {
+        for (uint32_t idle = 1; idle <= 9; ++idle) {
+            // cycle model
+            init_decoder_tb(e);
+            ubitz_emu_cfg_write(e, 0x09, 0x42); // window 1 posted -> slot 2
+            if (b) {
+                s_in.dev_ready_n &= (uint8_t)~(1u << 2);
+                clk(e, 3);
+            }
+            s_in.addr   = 0x22;
+            s_in.r_w_   = false;
+            s_in.iorq_n = false;
+            clk(e, 1);
+            CHECK(s_out.ready_n && s_out.post_le, "posted write not accepted at once");
+            s_in.iorq_n = true;
+            s_in.addr   = 0x10; // Host moves on; the drain keeps the posted address
+            for (uint32_t t = 0; t < idle; ++t) {
+                if (b && t == b + 1) {
+                    s_in.dev_ready_n |= 1u << 2;
+                }
+                clk(e, 1);
+                CHECK(s_out.post_oe_n || (s_out.addr_oe_n && s_out.post_addr == 0x22),
+                      "posted drain on Tile address %02x", s_out.post_addr);
+            }
+            bool later = b && b + 1 >= idle;
+            uint32_t w = cycle_wait(e, 0x10, true, 2, later, later ? b + 1 - idle : 0);
+
+            // transaction model: the posted cycle is one clock, then idle
+            init_decoder_tb(e);
+            ubitz_emu_cfg_write(e, 0x09, 0x42);
+            ubitz_emu_attach(e, 2, &tile);
+            s_busy = b;
+            ubitz_emu_io(e, 0x22, false, 0x99, false, &acc);
+            CHECK(acc.flags == UBITZ_EMU_F_POSTED && acc.wait == 0 && s_last == 0x99, "posted io");
+            ubitz_emu_advance(e, 1 + idle);
+            s_busy = 0;
+            ubitz_emu_io(e, 0x10, true, 0, false, &acc);
+            CHECK(acc.slot == 1 && acc.wait == w,
+                  "posted busy %u idle %u: transaction wait %u, cycle model %u", b, idle, acc.wait, w);
+        }
+    }
+
+    // Mode-2 vector fetch steered to the active INT slot
+    init_decoder_tb(e);
+    ubitz_emu_attach(e, 2, &tile);
+    ubitz_emu_cfg_write(e, 0xC0 + 2 * 2, 0x80);
+    ubitz_emu_set_int(e, 2, 0, true);
+    ubitz_emu_advance(e, 2);
+    ubitz_emu_io(e, 0x70, true, 0, true, &acc);
+    CHECK(acc.flags == UBITZ_EMU_F_VECTOR && acc.slot == 2 && acc.data == 0xE0, "vector fetch");
+    CHECK(ubitz_emu_irq_ack(e) == 2, "vector ack");
+    s_in.addr = 0x70;
+    s_in.irq_vec_cycle = true;
+    s_in.iorq_n = false;
+    clk(e, 1);
+    CHECK(s_out.cs_n == (uint8_t)(~(1u << 2) & 0x1F), "vector cycle cs_n=%02x", s_out.cs_n);
+}
+
+// ------------------------------------------------------------------
+// Docks chained behind BRIDGE windows (top_integration_tb bridge section)
+// ------------------------------------------------------------------
+
+#define MAX_CHAIN 3
+// /READY-low clocks each BRIDGE hop adds on top of the downstream wait
+// (BRIDGE_HOLD 3, same clk). top_integration_tb measures it on top.v and
+// prints "bridge: per-hop latency N clocks"; keep this equal to N.
+#define BRIDGE_HOP_CLKS 4u
+
+static ubitz_emu_t          s_chain[MAX_CHAIN];
+static ubitz_emu_pins_in_t  s_cin[MAX_CHAIN];
+static uint8_t              s_tile_ready[MAX_CHAIN]; // dev_ready_n of each Dock's Tiles
+static int                  s_acks;
+
+static void tile_ack(void *ctx) {
+    (void)ctx;
+    ++s_acks;
+}
+
+// Dock k of n: all but the last forward 0x80-0xFF to a downstream Dock in
+// slot 2 (0x10/F0 -> slot 1, 0x40/F0 DOCK); the last one has a Tile in slot 1
+// at 0x80/F0, its status window at 0x90/F0 and a posted window 0xA0/F0.
+static void init_chain(int n, bool attach) {
+    static const ubitz_emu_tile_t tile = { tile_read, tile_write, tile_ack, NULL };
+    for (int k = 0; k < n; ++k) {
+        ubitz_emu_t *e = &s_chain[k];
+        ubitz_emu_params_t p;
+        ubitz_emu_default_params(&p);
+        p.addr_w        = 8;
+        p.num_win       = 4;
+        p.num_range_win = 4;
+        p.num_slots     = 3;
+        p.num_cpu_int   = 2;
+        p.num_cpu_nmi   = 1;
+        CHECK(ubitz_emu_init(e, &p), "chain params rejected");
+        static const uint8_t fwd[4][3] = { { 0x10, 0xF0, 0x01 }, { 0x80, 0x80, 0x12 },
+                                           { 0x40, 0xF0, 0x20 }, { 0xFF, 0xFF, 0x00 } };
+        static const uint8_t leaf[4][3] = { { 0x80, 0xF0, 0x01 }, { 0x90, 0xF0, 0x20 },
+                                            { 0xA0, 0xF0, 0x41 }, { 0xFF, 0xFF, 0x00 } };
+        for (int w = 0; w < 4; ++w) {
+            const uint8_t *b = (k + 1 < n) ? fwd[w] : leaf[w];
+            ubitz_emu_cfg_write(e, (uint8_t)w, b[0]);
+            ubitz_emu_cfg_write(e, (uint8_t)(4 + w), b[1]);
+            ubitz_emu_cfg_write(e, (uint8_t)(8 + w), b[2]);
+        }
+        // Leaf Tile ch0 -> INT0, every bridge ch0 -> INT1 (head) / INT0
+        ubitz_emu_cfg_write(e, (uint8_t)(0xC0 + ((k + 1 < n) ? 4 : 2)), k == 0 && n > 1 ? 0x81 : 0x80);
+        if (k > 0 && attach) {
+            ubitz_emu_attach_dock(&s_chain[k - 1], 2, e);
+        }
+        if (k + 1 == n) {
+            ubitz_emu_attach(e, 1, &tile);
+        }
+        memset(&s_cin[k], 0, sizeof(s_cin[k]));
+        s_cin[k].iorq_n = true;
+        s_cin[k].r_w_   = true;
+        s_tile_ready[k] = 0x07;
+    }
+}
+
+// One clk edge of the whole chain, pin by pin: Dock k+1's Host side is Dock
+// k's slot 2. All pins are taken before the edge. s_cin[0] is the Host.
+static void chain_clk(int n) {
+    ubitz_emu_pins_out_t o[MAX_CHAIN];
+    for (int k = 0; k < n; ++k) {
+        if (k > 0) {
+            s_cin[k].addr          = s_cin[0].addr;
+            s_cin[k].iorq_n        = (o[k - 1].cs_n >> 2) & 1;
+            s_cin[k].r_w_          = o[k - 1].io_r_w_;
+            s_cin[k].irq_vec_cycle = (o[k - 1].slot_ack >> 2) & 1;
+            s_cin[k].irq_ack       = s_cin[k].irq_vec_cycle;
+        }
+        s_cin[k].dev_ready_n = s_tile_ready[k];
+        ubitz_emu_eval(&s_chain[k], &s_cin[k], &o[k]);
+    }
+    for (int k = 0; k + 1 < n; ++k) {
+        s_cin[k].dev_ready_n = (uint8_t)((s_tile_ready[k] & ~0x04) | (o[k + 1].ready_n << 2));
+        for (int c = 0; c < 2; ++c) {
+            ubitz_emu_set_int(&s_chain[k], 2, (uint8_t)c, (o[k + 1].cpu_int >> c) & 1);
+        }
+        ubitz_emu_set_nmi(&s_chain[k], 2, o[k + 1].cpu_nmi & 1);
+    }
+    for (int k = 0; k < n; ++k) {
+        ubitz_emu_clock(&s_chain[k], &s_cin[k], k == 0 ? &s_out : NULL);
+    }
+}
+
+// Host cycle on the chain head; the leaf Tile in slot 1 is released before
+// edge release_at (counted as in cycle_wait) when busy. Returns /READY-low
+// clocks, leaves /IORQ high after 3 idle clocks.
+static uint32_t chain_wait(int n, uint32_t a, bool rd, bool vec, uint32_t busy,
+                           uint32_t release_at) {
+    uint32_t low = 0, t = 0;
+    s_cin[0].addr          = a;
+    s_cin[0].r_w_          = rd;
+    s_cin[0].irq_vec_cycle = vec;
+    s_cin[0].irq_ack       = vec;
+    s_cin[0].iorq_n        = false;
+    do {
+        if (busy && t == release_at) {
+            s_tile_ready[n - 1] |= 0x02;
+        }
+        chain_clk(n);
+        ++t;
+        low += !s_out.ready_n;
+        CHECK(t < 64, "chain_wait: no /READY at %02x", a);
+    } while (!s_out.ready_n);
+    s_cin[0].iorq_n        = true;
+    s_cin[0].irq_vec_cycle = false;
+    s_cin[0].irq_ack       = false;
+    return low;
+}
+
+static void test_bridge(void) {
+    ubitz_emu_access_t acc;
+
+    // Waits over 0, 1 and 2 hops to the leaf Tile, busy B clocks from its /CS
+    for (int n = 1; n <= MAX_CHAIN; ++n) {
+        const uint32_t a = (n == 1) ? 0x81 : 0x85;
+        for (uint32_t b = 0; b <= 5; ++b) {
+            init_chain(n, false);
+            if (b) {
+                s_tile_ready[n - 1] &= (uint8_t)~0x02;
+                for (int i = 0; i < 3; ++i) {
+                    chain_clk(n);
+                }
+            }
+            uint32_t w = chain_wait(n, a, true, false, b, b + 1 + (uint32_t)(n - 1));
+
+            init_chain(n, true);
+            s_busy = b;
+            ubitz_emu_io(&s_chain[0], a, true, 0, false, &acc);
+            CHECK(acc.hops == n - 1 && acc.data == (uint8_t)(a ^ 0x5A), "hops %u data %02x",
+                  acc.hops, acc.data);
+            CHECK(acc.wait == w, "%d hops busy %u: transaction wait %u, cycle model %u",
+                  n - 1, b, acc.wait, w);
+            uint32_t leaf = b ? b + 3 : 1;
+            CHECK(w == leaf + BRIDGE_HOP_CLKS * (uint32_t)(n - 1), "%d hops busy %u: %u clocks",
+                  n - 1, b, w);
+        }
+    }
+    s_busy = 0;
+
+    // Downstream unmapped, DOCK window and posted write: the hold sets the pace
+    static const uint8_t other[3] = { 0xB0, 0x90, 0xA0 };
+    for (int n = 2; n <= MAX_CHAIN; ++n) {
+        for (int i = 0; i < 3; ++i) {
+            init_chain(n, false);
+            uint32_t w = chain_wait(n, other[i], i != 2, false, 0, 0);
+            init_chain(n, true);
+            ubitz_emu_io(&s_chain[0], other[i], i != 2, 0x33, false, &acc);
+            CHECK(acc.wait == w && w == BRIDGE_HOP_CLKS * (uint32_t)(n - 1), "%d hops addr %02x: %u vs %u",
+                  n - 1, other[i], acc.wait, w);
+            CHECK(acc.flags & UBITZ_EMU_F_BRIDGE, "addr %02x flags %x", other[i], acc.flags);
+        }
+    }
+
+    // A read of the leaf Tile `idle` clocks after a posted write to it
+    for (int n = 2; n <= MAX_CHAIN; ++n) {
+        for (uint32_t idle = 1; idle <= 9; ++idle) {
+            init_chain(n, false);
+            uint32_t pw = chain_wait(n, 0xA2, false, false, 0, 0);
+            for (uint32_t t = 0; t < idle; ++t) {
+                chain_clk(n);
+            }
+            uint32_t w = chain_wait(n, 0x85, true, false, 0, 0);
+
+            init_chain(n, true);
+            ubitz_emu_io(&s_chain[0], 0xA2, false, 0x77, false, &acc);
+            CHECK(acc.wait == pw && (acc.flags & UBITZ_EMU_F_POSTED) && s_last == 0x77,
+                  "bridged posted write: wait %u vs %u flags %x", acc.wait, pw, acc.flags);
+            ubitz_emu_advance(&s_chain[0], pw + 1 + idle);
+            ubitz_emu_io(&s_chain[0], 0x85, true, 0, false, &acc);
+            CHECK(acc.wait == w, "%d hops posted, idle %u: transaction wait %u, cycle model %u",
+                  n - 1, idle, acc.wait, w);
+        }
+    }
+
+    // Leaf INT through two bridges: CAUSE bit 5 on the head, the leaf's own
+    // CAUSE behind it, vector fetch and ack reach the leaf Tile
+    init_chain(MAX_CHAIN, true);
+    ubitz_emu_t *head = &s_chain[0], *tail = &s_chain[MAX_CHAIN - 1];
+    ubitz_emu_set_int(tail, 1, 0, true);
+    ubitz_emu_advance(head, 8);
+    CHECK(ubitz_emu_cpu_int(head) == 0x2, "bridged INT cpu_int=%x", ubitz_emu_cpu_int(head));
+    ubitz_emu_io(head, 0x40, true, 0, false, &acc);
+    CHECK(acc.data == 0xA8 && acc.hops == 0, "head CAUSE=%02x", acc.data);
+    ubitz_emu_io(head, 0x90, true, 0, false, &acc);
+    CHECK(acc.data == 0x84 && acc.hops == 2 && acc.wait == 8 &&
+          acc.flags == (UBITZ_EMU_F_BRIDGE | UBITZ_EMU_F_DOCK),
+          "leaf CAUSE=%02x hops %u wait %u flags %x", acc.data, acc.hops, acc.wait, acc.flags);
+    ubitz_emu_io(head, 0x00, true, 0, true, &acc);
+    CHECK(acc.data == 0xE0 && acc.slot == 2 && acc.hops == 2 && acc.wait == 9 &&
+          acc.flags == (UBITZ_EMU_F_BRIDGE | UBITZ_EMU_F_VECTOR),
+          "bridged vector data %02x wait %u flags %x", acc.data, acc.wait, acc.flags);
+    s_acks = 0;
+    CHECK(ubitz_emu_irq_ack(head) == 2 && s_acks == 1, "bridged ack");
+
+    // Idle chains are skipped in bulk and stay in step
+    ubitz_emu_advance(head, 1000000);
+    CHECK(tail->now == head->now && head->now == 8 + 1000000, "chain clk %llu/%llu",
+          (unsigned long long)head->now, (unsigned long long)tail->now);
+    ubitz_emu_set_int(tail, 1, 0, false);
+    ubitz_emu_advance(head, 8);
+    CHECK(ubitz_emu_cpu_int(head) == 0, "bridged INT did not clear");
+
+    // Same in cycle mode: INT arrives, the vector read takes the same 9 clocks
+    init_chain(MAX_CHAIN, false);
+    ubitz_emu_set_int(&s_chain[MAX_CHAIN - 1], 1, 0, true);
+    for (int i = 0; i < 8; ++i) {
+        chain_clk(MAX_CHAIN);
+    }
+    CHECK(s_out.cpu_int == 0x2, "cycle-mode bridged INT cpu_int=%x", s_out.cpu_int);
+    CHECK(chain_wait(MAX_CHAIN, 0x00, true, true, 0, 0) == 9, "cycle-mode bridged vector");
+    CHECK(ubitz_emu_cfg_read(&s_chain[0], 0x1C) == 3, "BRIDGE_HOLD cap");
+}
+
+// ------------------------------------------------------------------
+// Map from descriptors, as the Dock firmware builds it
+// ------------------------------------------------------------------
+
+static void test_bindings(void) {
+    ubitz_emu_t *e = &s_e;
+    ubitz_emu_params_t p;
+    static ubitz_cpu_desc_t cpu;
+    static ubitz_dev_desc_t devs[2];
+    const uint8_t slots[2] = { 1, 3 };
+    ubitz_decode_binding_t wins[UBITZ_MAX_WINDOWS];
+    ubitz_irq_binding_t irqs[UBITZ_MAX_IRQ_ROUTES];
+    int wc = 0, ic = 0;
+
+    memset(&cpu, 0, sizeof(cpu));
+    memset(devs, 0, sizeof(devs));
+    cpu.data_bus_width = 8;
+    cpu.addr_bus_width = 16;
+    cpu.window[0] = (ubitz_window_entry_t){ .function = 0x02, .instance = 0, .iowin = 0x0040,
+                                            .mask = 0xFFF0, .opsel = UBITZ_OP_ANY };
+    cpu.window[1] = (ubitz_window_entry_t){ .function = 0x03, .instance = 0, .iowin = 0x0080,
+                                            .mask = 0xFFF8, .opsel = UBITZ_OP_ANY,
+                                            .flags = UBITZ_WIN_FLAG_POSTED };
+    cpu.window[2] = (ubitz_window_entry_t){ .function = UBITZ_DOCK_IRQ_FUNCTION, .iowin = 0x00F0,
+                                            .mask = 0xFFF0, .opsel = UBITZ_OP_ANY };
+    cpu.introute[0] = (ubitz_introute_entry_t){ .function = 0x03, .channel = 0x01, .dest_pin = 1 };
+    devs[0].inst[0].function = 0x02;
+    devs[0].inst[0].data_bus_width = 8;
+    devs[1].inst[0].function = 0x03;
+    devs[1].inst[0].data_bus_width = 8;
+    devs[1].inst[0].int_channel = 0x01;
+
+    CHECK(ubitz_build_window_map(&cpu, devs, slots, 2, UBITZ_MAX_WINDOWS, wins, &wc), "window map");
+    CHECK(ubitz_build_irq_map(&cpu, devs, slots, 2, irqs, &ic), "irq map");
+
+    ubitz_emu_default_params(&p);
+    CHECK(ubitz_emu_init(e, &p), "default params rejected");
+    ubitz_emu_load_bindings(e, wins, wc, irqs, ic, NULL, 0);
+
+    ubitz_emu_access_t acc;
+    ubitz_emu_io(e, 0x0045, true, 0, false, &acc);
+    CHECK(acc.slot == 1 && !(acc.flags & UBITZ_EMU_F_UNMAPPED), "0x45 -> slot %d", acc.slot);
+    ubitz_emu_io(e, 0x0083, false, 0x11, false, &acc);
+    CHECK(acc.slot == 3 && (acc.flags & UBITZ_EMU_F_POSTED), "0x83 posted -> slot %d flags %x",
+          acc.slot, acc.flags);
+    ubitz_emu_advance(e, 8);
+    ubitz_emu_set_int(e, 3, 0, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0x2, "slot3 ch0 -> INT1 cpu_int=%x", ubitz_emu_cpu_int(e));
+    ubitz_emu_io(e, 0x00F0, true, 0, false, &acc);
+    CHECK((acc.flags & UBITZ_EMU_F_DOCK) && acc.data == 0x8C, "IRQ status CAUSE=%02x", acc.data);
+
+    // Idle time is skipped in bulk but coalescing still keeps clk time
+    ubitz_emu_set_int(e, 3, 0, false);
+    ubitz_emu_cfg_write(e, (uint8_t)(p.irq_base + e->coal_off + 6), 0x03); // 3-tick min gap
+    ubitz_emu_advance(e, 1000000);
+    ubitz_emu_set_int(e, 3, 0, true);
+    ubitz_emu_advance(e, 2);
+    CHECK(ubitz_emu_cpu_int(e) == 0x2, "delivered after idle");
+    ubitz_emu_set_int(e, 3, 0, false);
+    ubitz_emu_advance(e, 2);
+    ubitz_emu_set_int(e, 3, 0, true);
+    ubitz_emu_advance(e, 256);
+    CHECK(ubitz_emu_cpu_int(e) == 0, "delivered inside the min gap");
+    ubitz_emu_advance(e, 3 * 256);
+    CHECK(ubitz_emu_cpu_int(e) == 0x2, "not delivered after the min gap");
+    CHECK(e->now == 8 + 2 + 1000000 + 2 + 2 + 256 + 768, "clk count %llu", (unsigned long long)e->now);
+}
+
+// Window merging: one Function instance per binding, no more ranges than
+// comparators, ranges on the low windows.
+static void test_window_merge(void) {
+    static ubitz_cpu_desc_t cpu;
+    static ubitz_dev_desc_t devs[2];
+    const uint8_t slots[2] = { 1, 2 };
+    ubitz_decode_binding_t wins[UBITZ_MAX_WINDOWS];
+    int wc = 0;
+
+    memset(&cpu, 0, sizeof(cpu));
+    memset(devs, 0, sizeof(devs));
+    cpu.data_bus_width = 8;
+    cpu.addr_bus_width = 16;
+    for (int i = 0; i < 3; ++i) { // 0x10-0x3F: a range once merged
+        cpu.window[i] = (ubitz_window_entry_t){ .function = 0x02, .iowin = (uint32_t)(0x10 * (i + 1)),
+                                                .mask = 0xFFF0, .opsel = UBITZ_OP_ANY };
+    }
+    cpu.window[3] = (ubitz_window_entry_t){ .function = 0x02, .instance = 1, .iowin = 0x0040,
+                                            .mask = 0xFFF0, .opsel = UBITZ_OP_ANY };
+    cpu.window[4] = (ubitz_window_entry_t){ .function = 0x03, .iowin = 0x0080,
+                                            .mask = 0xFFFF, .opsel = UBITZ_OP_ANY };
+    devs[0].inst[0] = (typeof(devs[0].inst[0])){ .function = 0x02, .data_bus_width = 8 };
+    devs[0].inst[1] = (typeof(devs[0].inst[0])){ .function = 0x02, .instance = 1,
+                                                 .data_bus_width = 8 };
+    devs[1].inst[0] = (typeof(devs[0].inst[0])){ .function = 0x03, .data_bus_width = 8 };
+
+    CHECK(ubitz_build_window_map(&cpu, devs, slots, 2, 1, wins, &wc) && wc == 3,
+          "merged map: %d windows", wc);
+    CHECK(wins[0].type == UBITZ_WIN_RANGE && wins[0].win.iowin == 0x10 && wins[0].limit == 0x3F,
+          "range 0x10-0x3F not in window 0");
+    CHECK(wins[1].win.function == 0x03 && wins[2].win.function == 0x02 &&
+          wins[2].win.instance == 1 && wins[2].type == UBITZ_WIN_MASK,
+          "instance 1 merged into instance 0");
+
+    // No range comparators: the 0x10-0x3F run stays as descriptor windows
+    CHECK(ubitz_build_window_map(&cpu, devs, slots, 2, 0, wins, &wc), "mask-only map");
+    for (int i = 0; i < wc; ++i) {
+        CHECK(wins[i].type == UBITZ_WIN_MASK, "window %d is a range without comparators", i);
+    }
+    CHECK(wc == 4, "mask-only map: %d windows", wc); // 0x20 + 0x30 fold into one aligned block
+}
+
+// Bank regions from the CPU card's memory map, or the Bank descriptor alone.
+static void test_mem_bindings(void) {
+    ubitz_emu_t *e = &s_e;
+    ubitz_emu_params_t p;
+    static ubitz_cpu_desc_t cpu;
+    static ubitz_bank_desc_t bank;
+    static ubitz_cpu_memmap_t mm;
+    ubitz_mem_binding_t mems[UBITZ_MAX_MEM_REGIONS];
+    int mc = 0;
+    uint8_t space;
+
+    memset(&cpu, 0, sizeof(cpu));
+    memset(&bank, 0, sizeof(bank));
+    cpu.addr_bus_width  = 16;
+    bank.ram_addr_width = 16;
+    bank.rom_addr_width = 14;
+    ubitz_emu_default_params(&p);
+    CHECK(ubitz_emu_init(e, &p), "default params rejected");
+
+    // No memory map: ROM0 at the reset vector, RAM behind it
+    CHECK(ubitz_build_mem_map(&cpu, NULL, &bank, mems, &mc) && mc == 2, "fallback map %d", mc);
+    ubitz_emu_load_bindings(e, NULL, 0, NULL, 0, mems, mc);
+    CHECK(ubitz_emu_mem(e, 0x0000, &space) == 0 && space == UBITZ_MEM_ROM0, "Z80 ROM0 at 0");
+    CHECK(ubitz_emu_mem(e, 0x4000, &space) == 1 && space == UBITZ_MEM_RAM, "Z80 RAM at 0x4000");
+    CHECK(ubitz_emu_mem(e, 0x10000, NULL) < 0, "above the 16-bit space");
+    cpu.cpu_type = UBITZ_CPU_6502;
+    CHECK(ubitz_build_mem_map(&cpu, NULL, &bank, mems, &mc) && mems[0].base == 0xC000,
+          "6502 ROM0 base %lx", (unsigned long)mems[0].base);
+    ubitz_emu_load_bindings(e, NULL, 0, NULL, 0, mems, mc);
+    CHECK(ubitz_emu_mem(e, 0xFFFC, &space) == 0 && space == UBITZ_MEM_ROM0, "6502 reset vector");
+    CHECK(ubitz_emu_mem(e, 0x0000, &space) == 1 && space == UBITZ_MEM_RAM, "6502 zero page");
+
+    // Memory map: entries in table order, unused ones skipped
+    memcpy(mm.magic, "UMEM", 4);
+    for (int i = 0; i < UBITZ_MAX_MEM_REGIONS; ++i) {
+        mm.region[i] = (ubitz_mem_entry_t){ .space = UBITZ_MEM_UNUSED };
+    }
+    mm.region[0] = (ubitz_mem_entry_t){ .base = 0x0000, .size_log2 = 13, .space = UBITZ_MEM_ROM0 };
+    mm.region[2] = (ubitz_mem_entry_t){ .base = 0xE000, .size_log2 = 12, .space = UBITZ_MEM_ROM2 };
+    mm.region[3] = (ubitz_mem_entry_t){ .base = 0x0000, .size_log2 = 16, .space = UBITZ_MEM_RAM };
+    CHECK(ubitz_build_mem_map(&cpu, &mm, &bank, mems, &mc) && mc == 3, "memory map %d", mc);
+    ubitz_emu_load_bindings(e, NULL, 0, NULL, 0, mems, mc);
+    CHECK(ubitz_emu_mem(e, 0x1FFF, &space) == 0 && space == UBITZ_MEM_ROM0, "map ROM0");
+    CHECK(ubitz_emu_mem(e, 0xE800, &space) == 1 && space == UBITZ_MEM_ROM2, "map ROM2");
+    CHECK(ubitz_emu_mem(e, 0xFFFC, &space) == 2 && space == UBITZ_MEM_RAM, "map RAM");
+    mm.region[2].base = 0xE800; // not aligned to its 4 KiB size
+    CHECK(!ubitz_build_mem_map(&cpu, &mm, &bank, mems, &mc), "misaligned region accepted");
+    bank.rom_addr_width = 0;
+    mm.region[2].base = 0xE000;
+    CHECK(!ubitz_build_mem_map(&cpu, &mm, &bank, mems, &mc), "ROM region on a RAM-only Bank");
+
+    // 32-bit Host: SIZE stops at 31, so a full 32-bit RAM takes two regions
+    cpu.cpu_type        = 0;
+    cpu.addr_bus_width  = 32;
+    bank.ram_addr_width = 32;
+    bank.rom_addr_width = 16;
+    CHECK(ubitz_build_mem_map(&cpu, NULL, &bank, mems, &mc) && mc == 3 &&
+          mems[2].base == 0x80000000u && mems[2].size_log2 == 31, "32-bit fallback map %d", mc);
+    ubitz_emu_load_bindings(e, NULL, 0, NULL, 0, mems, mc);
+    CHECK(ubitz_emu_mem(e, 0x7FFFFFFFu, &space) == 1 && space == UBITZ_MEM_RAM, "32-bit RAM low half");
+    CHECK(ubitz_emu_mem(e, 0xFFFFFFF0u, &space) == 2 && space == UBITZ_MEM_RAM, "32-bit RAM high half");
+    mm.region[3] = (ubitz_mem_entry_t){ .base = 0, .size_log2 = 32, .space = UBITZ_MEM_RAM };
+    CHECK(!ubitz_build_mem_map(&cpu, &mm, &bank, mems, &mc), "SIZE 32 region accepted");
+}
+
+// The same descriptors with Function 0x03 behind a bridge card in slot 2:
+// ubitz_chain_split_map() gives each Dock its share of the chain map.
+static void test_chain_bindings(void) {
+    static ubitz_cpu_desc_t cpu;
+    static ubitz_dev_desc_t devs[2];
+    const uint8_t slots[2] = { 1, UBITZ_CHAIN_SLOT(1, 3) };
+    const uint8_t bridge_slot[UBITZ_MAX_HOPS] = { 2, UBITZ_NO_BRIDGE, UBITZ_NO_BRIDGE,
+                                                  UBITZ_NO_BRIDGE };
+    ubitz_decode_binding_t wins[UBITZ_MAX_WINDOWS], hw[UBITZ_MAX_WINDOWS];
+    ubitz_irq_binding_t irqs[UBITZ_MAX_IRQ_ROUTES], hi[UBITZ_MAX_IRQ_ROUTES];
+    int wc = 0, ic = 0, hwc = 0, hic = 0;
+    ubitz_emu_t *up = &s_chain[0], *dn = &s_chain[1];
+    ubitz_emu_params_t p;
+    static const ubitz_emu_tile_t tile = { tile_read, tile_write, tile_ack, NULL };
+
+    memset(&cpu, 0, sizeof(cpu));
+    memset(devs, 0, sizeof(devs));
+    cpu.data_bus_width = 8;
+    cpu.addr_bus_width = 16;
+    cpu.window[0] = (ubitz_window_entry_t){ .function = 0x02, .instance = 0, .iowin = 0x0040,
+                                            .mask = 0xFFF0, .opsel = UBITZ_OP_ANY };
+    cpu.window[1] = (ubitz_window_entry_t){ .function = 0x03, .instance = 0, .iowin = 0x0080,
+                                            .mask = 0xFFF8, .opsel = UBITZ_OP_ANY,
+                                            .flags = UBITZ_WIN_FLAG_POSTED };
+    cpu.window[2] = (ubitz_window_entry_t){ .function = UBITZ_DOCK_IRQ_FUNCTION, .iowin = 0x00F0,
+                                            .mask = 0xFFF0, .opsel = UBITZ_OP_ANY };
+    cpu.window[3] = (ubitz_window_entry_t){ .function = UBITZ_DOCK_IRQ_FUNCTION, .instance = 1,
+                                            .iowin = 0x00E0, .mask = 0xFFF0,
+                                            .opsel = UBITZ_OP_ANY };
+    cpu.introute[0] = (ubitz_introute_entry_t){ .function = 0x03, .channel = 0x01, .dest_pin = 1,
+                                                .coalesce = 0x03 };
+    devs[0].inst[0].function = 0x02;
+    devs[0].inst[0].data_bus_width = 8;
+    devs[1].inst[0].function = 0x03;
+    devs[1].inst[0].data_bus_width = 8;
+    devs[1].inst[0].int_channel = 0x01;
+
+    CHECK(ubitz_build_window_map(&cpu, devs, slots, 2, UBITZ_MAX_WINDOWS, wins, &wc),
+          "chain window map");
+    CHECK(ubitz_build_irq_map(&cpu, devs, slots, 2, irqs, &ic), "chain irq map");
+    ubitz_emu_default_params(&p);
+    CHECK(ubitz_emu_init(up, &p) && ubitz_emu_init(dn, &p), "default params rejected");
+    CHECK(ubitz_chain_split_map(1, bridge_slot, 2, wins, wc, irqs, ic, hw, &hwc, hi, &hic),
+          "split hop 1");
+    CHECK(hwc == 2 && hic == 1 && hi[0].slot == 3 && hi[0].route.coalesce == 0x03,
+          "hop 1 share: %d windows %d routes", hwc, hic);
+    ubitz_emu_load_bindings(dn, hw, hwc, hi, hic, NULL, 0);
+    CHECK(ubitz_chain_split_map(0, bridge_slot, 2, wins, wc, irqs, ic, hw, &hwc, hi, &hic),
+          "split hop 0");
+    CHECK(hwc == 4 && hic == 1 && hi[0].slot == 2 && hi[0].route.channel == 0x02 &&
+          hi[0].route.coalesce == 0, "hop 0 share: %d windows %d routes", hwc, hic);
+    ubitz_emu_load_bindings(up, hw, hwc, hi, hic, NULL, 0);
+    ubitz_emu_attach_dock(up, 2, dn);
+    ubitz_emu_attach(dn, 3, &tile);
+
+    ubitz_emu_access_t acc;
+    ubitz_emu_io(up, 0x0045, true, 0, false, &acc);
+    CHECK(acc.slot == 1 && acc.hops == 0, "0x45 -> slot %d hops %d", acc.slot, acc.hops);
+    ubitz_emu_io(up, 0x0083, false, 0x11, false, &acc);
+    CHECK(acc.slot == 2 && acc.hops == 1 && (acc.flags & UBITZ_EMU_F_POSTED) &&
+          (acc.flags & UBITZ_EMU_F_BRIDGE), "0x83 -> slot %d hops %d flags %x",
+          acc.slot, acc.hops, acc.flags);
+    ubitz_emu_advance(up, 8);
+    CHECK(s_last == 0x11, "posted write reached the downstream Tile (%02x)", s_last);
+
+    // Downstream Tile INT_CH0 -> its INT1 -> bridge slot ch1 -> head INT1
+    ubitz_emu_set_int(dn, 3, 0, true);
+    ubitz_emu_advance(up, 4);
+    CHECK(ubitz_emu_cpu_int(up) == 0x2, "bridged INT cpu_int=%x", ubitz_emu_cpu_int(up));
+    ubitz_emu_io(up, 0x00F0, true, 0, false, &acc);
+    CHECK((acc.flags & UBITZ_EMU_F_DOCK) && acc.hops == 0 && acc.data == 0xA9,
+          "head CAUSE=%02x", acc.data);
+    ubitz_emu_io(up, 0x00E0, true, 0, false, &acc);
+    CHECK((acc.flags & UBITZ_EMU_F_DOCK) && acc.hops == 1 && acc.data == 0x8C,
+          "downstream CAUSE=%02x hops %d", acc.data, acc.hops);
+}
+
+// ------------------------------------------------------------------
+// Shared vectors (HDL/src/top_vectors.hex, replayed by top_vectors_tb.v)
+//
+// One 128-bit record per line, byte 0 first:
+//   b0      kind: 0x00 clk step, 0x01 config write, 0xFF end
+//   step    b1 addr, b2 {irq_ack, irq_vec_cycle, r_w_, mreq_n, iorq_n},
+//           b3 dev_ready_n, b4 tile_int_req, b5 tile_nmi_req, b6 dock_din;
+//           expected pins after the edge: b8 {ready_n, io_r_w_, data_oe_n,
+//           data_dir, ff_oe_n, post_le, post_oe_n, addr_oe_n}, b9 cs_n,
+//           b10 {cpu_nmi, cpu_int}, b11 slot_ack, b12 {dock_doe, mem1_cs_n,
+//           mem0_cs_n, bank_cs_n}, b13 dock_dout, b14 post_addr
+//   config  b14 cfg_addr, b15 data
+// Build: top_integration_tb's dut (8-bit addresses, 4 windows, 3 slots x 2
+// INT channels, 2 CPU INT, 1 NMI, IRQ_CFG_BASE 0xC0).
+// ------------------------------------------------------------------
+
+#define VEC_BYTES  16
+#define VEC_STEP   0x00
+#define VEC_CFG    0x01
+#define VEC_END    0xFF
+#define VEC_STEPS  1500
+
+static uint32_t s_rng;
+
+static uint32_t rnd(uint32_t n) {
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return s_rng % n;
+}
+
+static void vec_put(FILE *f, const uint8_t *v) {
+    for (int i = 0; i < VEC_BYTES; i++) {
+        fprintf(f, "%02X", v[i]);
+    }
+    fputc('\n', f);
+}
+
+static void vec_cfg(ubitz_emu_t *e, FILE *f, uint8_t a, uint8_t d) {
+    uint8_t v[VEC_BYTES] = { VEC_CFG };
+    v[14] = a;
+    v[15] = d;
+    ubitz_emu_cfg_write(e, a, d);
+    if (f) {
+        vec_put(f, v);
+    }
+}
+
+static uint8_t s_int_lvl, s_nmi_lvl;
+
+static void vec_set_req(ubitz_emu_t *e, uint8_t ints, uint8_t nmis) {
+    for (uint8_t i = 0; i < e->p.num_slots * e->p.num_int_ch; i++) {
+        ubitz_emu_set_int(e, i / e->p.num_int_ch, i % e->p.num_int_ch, (ints >> i) & 1);
+    }
+    for (uint8_t s = 0; s < e->p.num_slots; s++) {
+        ubitz_emu_set_nmi(e, s, (nmis >> s) & 1);
+    }
+    s_int_lvl = ints;
+    s_nmi_lvl = nmis;
+}
+
+static void vec_pack_in(const ubitz_emu_pins_in_t *in, uint8_t *v) {
+    v[1] = (uint8_t)in->addr;
+    v[2] = (uint8_t)((in->irq_ack << 4) | (in->irq_vec_cycle << 3) | (in->r_w_ << 2) |
+                     (in->mreq_n << 1) | in->iorq_n);
+    v[3] = in->dev_ready_n;
+    v[4] = s_int_lvl;
+    v[5] = s_nmi_lvl;
+    v[6] = in->dock_din;
+}
+
+static void vec_pack_out(const ubitz_emu_pins_out_t *o, uint8_t *v) {
+    v[8]  = (uint8_t)((o->ready_n << 7) | (o->io_r_w_ << 6) | (o->data_oe_n << 5) |
+                      (o->data_dir << 4) | (o->ff_oe_n << 3) | (o->post_le << 2) |
+                      (o->post_oe_n << 1) | o->addr_oe_n);
+    v[9]  = o->cs_n;
+    v[10] = (uint8_t)(o->cpu_int | (o->cpu_nmi << 4));
+    v[11] = o->slot_ack;
+    v[12] = (uint8_t)((o->dock_doe << 3) | (o->mem1_cs_n << 2) | (o->mem0_cs_n << 1) |
+                      o->bank_cs_n);
+    v[13] = o->dock_dout;
+    v[14] = (uint8_t)o->post_addr;
+}
+
+static uint8_t s_busy_left[UBITZ_EMU_MAX_SLOTS];
+static uint8_t s_cs_prev;
+
+// Tiles hold /READY low for 0-4 clocks from the /CS falling edge.
+static void vec_tiles(const ubitz_emu_t *e) {
+    for (uint8_t s = 0; s < e->p.num_slots; s++) {
+        uint8_t bit = (uint8_t)(1u << s);
+        if (!(s_out.cs_n & bit) && (s_cs_prev & bit)) {
+            s_busy_left[s] = (uint8_t)rnd(5);
+        } else if (s_out.cs_n & bit) {
+            s_busy_left[s] = 0;
+        }
+        if (s_busy_left[s]) {
+            s_busy_left[s]--;
+            s_in.dev_ready_n &= (uint8_t)~bit;
+        } else {
+            s_in.dev_ready_n |= bit;
+        }
+    }
+    s_cs_prev = s_out.cs_n;
+}
+
+static void vec_step(ubitz_emu_t *e, FILE *f) {
+    uint8_t v[VEC_BYTES] = { VEC_STEP };
+    vec_pack_in(&s_in, v);
+    clk(e, 1);
+    vec_pack_out(&s_out, v);
+    vec_put(f, v);
+    vec_tiles(e);
+}
+
+// Holds the current I/O cycle for at least two clocks and until /READY.
+static int vec_hold_io(ubitz_emu_t *e, FILE *f) {
+    int n = 0;
+    do {
+        vec_step(e, f);
+        CHECK(++n < 64, "vectors: no /READY at %02x", s_in.addr);
+    } while (n < 2 || !s_out.ready_n);
+    return n;
+}
+
+// Reactive stimulus: the Host holds each I/O cycle until /READY, Tiles stay
+// busy a random number of clocks after /CS, interrupt requests toggle at
+// random and a pending CPU INT is answered with a Mode-2 vector cycle.
+static void vec_record(FILE *f) {
+    ubitz_emu_t *e = &s_e;
+    s_rng = 0x5EED2024u;
+    fputs("// Dock pin vectors, generated by dock_emu_test --record (Emu/dock_emu_test.c)\n"
+          "// and replayed by HDL/src/top_vectors_tb.v. Do not edit.\n", f);
+    init_tb_build(e, 3, 2, 0xC0, NULL);
+    s_cs_prev = s_out.cs_n;
+    uint8_t ints = 0, nmis = 0;
+    vec_set_req(e, 0, 0);
+
+    // w0 0x10/F0 -> slot 1, w1 0x20/F0 -> slot 2 posted, w2 0x40/F0 DOCK,
+    // w3 range 0x80..0x9F -> slot 0; ROM0 0xE0 (32 bytes), RAM elsewhere.
+    static const uint8_t cfg[][2] = {
+        { 0x00, 0x10 }, { 0x04, 0xF0 }, { 0x08, 0x01 }, { 0x0C, 0xFF },
+        { 0x01, 0x20 }, { 0x05, 0xF0 }, { 0x09, 0x42 }, { 0x0D, 0xFF },
+        { 0x02, 0x40 }, { 0x06, 0xF0 }, { 0x0A, 0x20 }, { 0x0E, 0xFF },
+        { 0x03, 0x80 }, { 0x07, 0x9F }, { 0x0B, 0x80 }, { 0x0F, 0xFF },
+        { 0x10, 0xE0 }, { 0x14, 0xA5 }, { 0x13, 0x00 }, { 0x17, 0x88 },
+        { 0xC0 + 2, 0x80 }, // slot 1 ch 0 -> INT0
+        { 0xC0 + 5, 0x81 }, // slot 2 ch 1 -> INT1
+        { 0xC0 + 6, 0x80 }, // slot 0 NMI -> NMI0
+    };
+    for (size_t i = 0; i < sizeof(cfg) / sizeof(cfg[0]); i++) {
+        vec_cfg(e, f, cfg[i][0], cfg[i][1]);
+    }
+
+    static const uint8_t io_addr[] = { 0x12, 0x1F, 0x23, 0x2C, 0x40, 0x44, 0x48,
+                                       0x49, 0x4C, 0x80, 0x9F, 0xA0, 0x05, 0x66 };
+    int steps = 0;
+    while (steps < VEC_STEPS) {
+        if (rnd(8) == 0) {
+            ints ^= (uint8_t)(1u << rnd(6));
+            vec_set_req(e, ints, nmis);
+        }
+        if (rnd(32) == 0) {
+            nmis ^= (uint8_t)(1u << rnd(3));
+            vec_set_req(e, ints, nmis);
+        }
+        uint32_t kind = rnd(10);
+        if (kind < 5 || (kind < 7 && s_out.cpu_int)) {
+            // I/O cycle (vector fetch when an INT is up), held until /READY
+            bool vec = kind >= 5;
+            s_in.addr          = vec ? 0x00 : io_addr[rnd(sizeof(io_addr))];
+            s_in.r_w_          = vec || rnd(2);
+            s_in.irq_vec_cycle = vec;
+            s_in.irq_ack       = vec;
+            s_in.dock_din      = (uint8_t)rnd(256);
+            s_in.iorq_n        = false;
+            steps += vec_hold_io(e, f);
+            if (!vec && (s_in.addr & 0xF0) == 0x40 && rnd(3) == 0) {
+                // Back-to-back DOCK access with /IORQ still low
+                s_in.addr     = io_addr[4 + rnd(5)];
+                s_in.r_w_     = rnd(2);
+                s_in.dock_din = (uint8_t)rnd(256);
+                steps += vec_hold_io(e, f);
+            }
+            s_in.iorq_n        = true;
+            s_in.irq_vec_cycle = false;
+            s_in.irq_ack       = false;
+        } else if (kind < 8) {
+            // Bank cycle
+            s_in.addr   = (uint8_t)rnd(256);
+            s_in.r_w_   = rnd(2);
+            s_in.mreq_n = false;
+            for (uint32_t n = 1 + rnd(3); n; n--) {
+                vec_step(e, f);
+                steps++;
+            }
+            s_in.mreq_n = true;
+        }
+        for (uint32_t n = rnd(3); n; n--) {
+            vec_step(e, f);
+            steps++;
+        }
+    }
+    uint8_t v[VEC_BYTES] = { VEC_END };
+    vec_put(f, v);
+}
+
+static void vec_replay(FILE *f) {
+    ubitz_emu_t *e = &s_e;
+    init_tb_build(e, 3, 2, 0xC0, NULL);
+    vec_set_req(e, 0, 0);
+    char line[256];
+    int rec = 0, steps = 0;
+    for (;;) {
+        CHECK(fgets(line, sizeof(line), f), "vectors: no end record after %d records", rec);
+        if (line[0] == '/' || line[0] == '\n') {
+            continue;
+        }
+        uint8_t v[VEC_BYTES];
+        for (int i = 0; i < VEC_BYTES; i++) {
+            unsigned b;
+            CHECK(sscanf(line + 2 * i, "%2x", &b) == 1, "vectors: bad record %d", rec);
+            v[i] = (uint8_t)b;
+        }
+        rec++;
+        if (v[0] == VEC_END) {
+            break;
+        } else if (v[0] == VEC_CFG) {
+            ubitz_emu_cfg_write(e, v[14], v[15]);
+            continue;
+        }
+        CHECK(v[0] == VEC_STEP, "vectors: record %d kind %02x", rec, v[0]);
+        s_in.addr          = v[1];
+        s_in.iorq_n        = v[2] & 1;
+        s_in.mreq_n        = (v[2] >> 1) & 1;
+        s_in.r_w_          = (v[2] >> 2) & 1;
+        s_in.irq_vec_cycle = (v[2] >> 3) & 1;
+        s_in.irq_ack       = (v[2] >> 4) & 1;
+        s_in.dev_ready_n   = v[3];
+        s_in.dock_din      = v[6];
+        vec_set_req(e, v[4], v[5]);
+        clk(e, 1);
+        uint8_t got[VEC_BYTES];
+        vec_pack_out(&s_out, got);
+        CHECK(memcmp(got + 8, v + 8, 7) == 0,
+              "vectors: step %d (record %d) got %02x %02x %02x %02x %02x %02x %02x", steps, rec,
+              got[8], got[9], got[10], got[11], got[12], got[13], got[14]);
+        steps++;
+    }
+    printf("Replayed %d vector steps.\n", steps);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 3 && (!strcmp(argv[1], "--record") || !strcmp(argv[1], "--replay"))) {
+        bool rec = !strcmp(argv[1], "--record");
+        FILE *f = fopen(argv[2], rec ? "w" : "r");
+        CHECK(f, "cannot open %s", argv[2]);
+        if (rec) {
+            vec_record(f);
+        } else {
+            vec_replay(f);
+        }
+        fclose(f);
+        return 0;
+    }
+    test_irq_router();
+    test_top_integration();
+    test_addr_decoder();
+    test_waits();
+    test_bridge();
+    test_bindings();
+    test_window_merge();
+    test_mem_bindings();
+    test_chain_bindings();
+    printf("All Dock emulator tests passed.\n");
+    return 0;
+}
@@ -0,0 +1,1034 @@
+#include "ubitz_dock_emu.h"
+#include <string.h>
+
+// addr_decoder_fsm states
+enum { S_IDLE = 0, S_ACTIVE = 1, S_POSTED = 2 };
+
+// Capability block addresses (top.v cap_byte)
+enum {
+    CAP_MAGIC0 = 0x00, CAP_MAGIC1, CAP_VERSION, CAP_ADDR_W, CAP_NUM_WIN,
+    CAP_NUM_RANGE_WIN, CAP_NUM_SLOTS, CAP_NUM_INT_CH, CAP_NUM_CPU_INT,
+    CAP_NUM_CPU_NMI, CAP_IRQ_BASE, CAP_CFG_BYTES, CAP_BASE_OFF, CAP_MASK_OFF,
+    CAP_SLOT_OFF, CAP_OP_OFF, CAP_NMI_OFF, CAP_COAL_OFF, CAP_COAL_SNAP,
+    CAP_COAL_TICK_W, CAP_FEATURES, CAP_TRACE_BASE, CAP_TRACE_DEPTH,
+    CAP_TRACE_ENTRY, CAP_SVC_SLOT, CAP_SVC_FIFO_LOG2, CAP_INIT_SUM0, CAP_INIT_SUM1,
+    CAP_BRIDGE_HOLD, CAP_MEM_OFF, CAP_NUM_MEM_REGION,
+};
+
+// Feature bits reported: range windows (if any), posted writes, coalescing,
+// DOCK windows, baked map (if any), BRIDGE windows. No bus trace, no services
+// slot.
+#define FEAT_RANGE    0x01
+#define FEAT_BASE     0xA6
+#define FEAT_CFG_INIT 0x40
+
+// Decoder SLOT byte fields (addr_decoder_cfg)
+#define SLOT_TYPE   0x80
+#define SLOT_POSTED 0x40
+#define SLOT_DOCK   0x20
+#define SLOT_BRIDGE 0x10
+
+typedef struct {
+    bool    valid;      // win_valid_mux
+    int8_t  win;        // matched window, -1 = none
+    uint8_t sel_slot;   // sel_slot_mux
+    bool    post_req;   // post_req_mux
+    bool    dock;       // dock_hit_mux
+    bool    bridge;     // bridge_hit_mux
+    bool    vector;     // Mode-2 override applied
+} decode_t;
+
+static int lowest_bit(uint32_t v) { return __builtin_ctz(v); }
+
+static uint8_t idx_width(unsigned n) {
+    uint8_t w = 1;
+    while ((1u << w) < n) {
+        ++w;
+    }
+    return w;
+}
+
+// ------------------------------------------------------------------
+// Decoder (addr_decoder_match + the vector override in addr_decoder)
+// ------------------------------------------------------------------
+
+static bool irq_int_active(const ubitz_emu_t *e) {
+    return e->active_valid && !e->active_is_nmi && (e->active_cpu_idx & 0x10) &&
+           e->active_slot < e->p.num_slots;
+}
+
+static int8_t match(const ubitz_emu_t *e, uint32_t addr, bool read) {
+    for (int w = 0; w < e->p.num_win; ++w) {
+        uint8_t op = e->op[w];
+        if (!(op == 0xFF || (op == 0x01 && read) || (op == 0x00 && !read))) {
+            continue;
+        }
+        bool hit;
+        if (w < e->p.num_range_win && (e->slot[w] & SLOT_TYPE)) {
+            hit = addr >= e->base[w] && addr <= e->mask[w];
+        } else {
+            hit = ((addr ^ e->base[w]) & e->mask[w]) == 0;
+        }
+        if (hit) {
+            return (int8_t)w;
+        }
+    }
+    return -1;
+}
+
+// addr_decoder bridge_slots: slots some BRIDGE (non-DOCK) window points at.
+static uint8_t bridge_slots(const ubitz_emu_t *e) {
+    uint8_t m = 0;
+    for (int w = 0; w < e->p.num_win; ++w) {
+        uint8_t sb = e->slot[w];
+        if ((sb & SLOT_BRIDGE) && !(sb & SLOT_DOCK) && (sb & 0x07) < e->p.num_slots) {
+            m |= (uint8_t)(1u << (sb & 0x07));
+        }
+    }
+    return m;
+}
+
+// Qualified decode of a Host cycle (/IORQ low) against the current state.
+static void decode(const ubitz_emu_t *e, uint32_t addr, bool read, bool vec_cycle,
+                   decode_t *d) {
+    d->win      = match(e, addr, read);
+    d->valid    = d->win >= 0;
+    d->sel_slot = d->valid ? (e->slot[d->win] & 0x07) : 0;
+    d->dock     = d->valid && (e->slot[d->win] & SLOT_DOCK);
+    d->bridge   = d->valid && (e->slot[d->win] & SLOT_BRIDGE) && !d->dock;
+    d->post_req = d->valid && !read && (e->slot[d->win] & SLOT_POSTED) && !d->dock &&
+                  !d->bridge;
+    d->vector   = false;
+    if (vec_cycle && irq_int_active(e)) {
+        d->vector   = true;
+        d->valid    = true;
+        d->sel_slot = e->active_slot;
+        d->post_req = false;
+        d->dock     = false;
+        d->bridge   = (bridge_slots(e) >> e->active_slot) & 1;
+    }
+}
+
+// ------------------------------------------------------------------
+// irq_router
+// ------------------------------------------------------------------
+
+static uint8_t host_read(const ubitz_emu_t *e, uint8_t a) {
+    switch (a & 0x0F) {
+    case 0x0:
+        if (!e->active_valid) {
+            return 0x00;
+        }
+        return (uint8_t)(0x80 | (e->active_is_nmi ? 0x40 : 0x00) |
+                         (((bridge_slots(e) >> e->active_slot) & 1) << 5) |
+                         (e->active_slot << 2) | e->active_ch);
+    case 0x1:
+        return e->pending_nmi;
+    case 0x4: case 0x5: case 0x6: case 0x7:
+        return (uint8_t)(e->pending_int >> (8 * (a & 0x3)));
+    case 0x8: case 0x9: case 0xA: case 0xB:
+        return (uint8_t)(e->host_mask >> (8 * (a & 0x3)));
+    default:
+        return 0x00;
+    }
+}
+
+static void host_write(ubitz_emu_t *e, uint8_t a, uint8_t d) {
+    if ((a & 0x0C) != 0x08) {
+        return;
+    }
+    for (int m = 0; m < e->num_int_src; ++m) {
+        if (m / 8 == (a & 0x3)) {
+            e->host_mask = (e->host_mask & ~(1u << m)) | ((uint32_t)((d >> (m % 8)) & 1) << m);
+        }
+    }
+    e->irq_quiet = false;
+}
+
+static void refresh_route_maps(ubitz_emu_t *e) {
+    e->int_en = e->coal_on = e->coal_hold = 0;
+    e->nmi_en = 0;
+    for (int i = 0; i < e->num_int_src; ++i) {
+        if (e->int_route[i] & 0x10) {
+            e->int_en |= 1u << i;
+        }
+        if (e->int_coal[i] & 0x7F) {
+            e->coal_on |= 1u << i;
+        }
+        if (e->int_coal[i] & 0x80) {
+            e->coal_hold |= 1u << i;
+        }
+    }
+    for (int s = 0; s < e->p.num_slots; ++s) {
+        if (e->nmi_route[s] & 0x10) {
+            e->nmi_en |= (uint8_t)(1u << s);
+        }
+    }
+}
+
+// One clk edge of irq_router. Returns true when any state changed, so a run
+// of edges with the same inputs that ends in a no-op can be skipped until the
+// next coalescing tick.
+static bool irq_step(ubitz_emu_t *e) {
+    const uint32_t tick_max = (1u << e->p.coal_tick_w) - 1;
+    const bool     tick     = e->prescale == tick_max;
+    const uint32_t req      = e->int_req & e->int_en;
+    const uint32_t rise     = req & ~e->req_q;
+    const uint32_t hold_ld  = e->coal_on & e->coal_hold & rise & ~e->coal_run;
+    const uint32_t gate     = e->coal_run | hold_ld;
+
+    uint32_t pend_int = req & ~gate & ~e->host_mask;
+    uint8_t  pend_nmi = e->nmi_req & e->nmi_en;
+
+    bool    valid  = e->active_valid;
+    bool    is_nmi = e->active_is_nmi;
+    uint8_t slot   = e->active_slot, ch = e->active_ch, cpu = e->active_cpu_idx;
+    uint32_t act_new = 0;
+
+    if (valid) {
+        if (is_nmi) {
+            valid = (e->nmi_req >> slot) & 1;
+        } else {
+            uint32_t bit = 1u << (slot * e->p.num_int_ch + ch);
+            valid = (e->int_req & bit) && !(e->host_mask & bit);
+        }
+    }
+    if (!valid) {
+        is_nmi = false;
+        slot = ch = cpu = 0;
+        if (pend_nmi) {
+            valid  = true;
+            is_nmi = true;
+            slot   = (uint8_t)lowest_bit(pend_nmi);
+            cpu    = e->nmi_route[slot];
+        } else if (pend_int) {
+            int i  = lowest_bit(pend_int);
+            valid  = true;
+            slot   = (uint8_t)(i / e->p.num_int_ch);
+            ch     = (uint8_t)(i % e->p.num_int_ch);
+            cpu    = e->int_route[i];
+            act_new = 1u << i;
+        }
+    }
+
+    // Coalescing timers and counters
+    const uint32_t load = hold_ld | (e->coal_on & ~e->coal_hold & act_new);
+    const uint32_t hits = rise & e->coal_run;
+    uint32_t run = e->coal_run;
+    for (uint32_t m = load | (tick ? run : 0); m; m &= m - 1) {
+        int i = lowest_bit(m);
+        if (load & (1u << i)) {
+            e->coal_cnt[i] = e->int_coal[i] & 0x7F;
+        } else {
+            e->coal_cnt[i]--;
+        }
+        run = e->coal_cnt[i] ? (run | (1u << i)) : (run & ~(1u << i));
+    }
+    if (act_new) {
+        int i = lowest_bit(act_new);
+        if (e->cnt_deliv[i] != 0xFF) {
+            e->cnt_deliv[i]++;
+        }
+    }
+    for (uint32_t m = hits; m; m &= m - 1) {
+        int i = lowest_bit(m);
+        if (e->cnt_coal[i] != 0xFF) {
+            e->cnt_coal[i]++;
+        }
+    }
+
+    bool changed = load || (tick && e->coal_run) || req != e->req_q ||
+                   pend_int != e->pending_int || pend_nmi != e->pending_nmi ||
+                   valid != e->active_valid || is_nmi != e->active_is_nmi ||
+                   slot != e->active_slot || ch != e->active_ch || cpu != e->active_cpu_idx;
+
+    e->coal_run       = run;
+    e->req_q          = req;
+    e->pending_int    = pend_int;
+    e->pending_nmi    = pend_nmi;
+    e->active_valid   = valid;
+    e->active_is_nmi  = is_nmi;
+    e->active_slot    = slot;
+    e->active_ch      = ch;
+    e->active_cpu_idx = cpu;
+    e->prescale       = (e->prescale + 1) & tick_max;
+    return changed;
+}
+
+uint8_t ubitz_emu_cpu_int(const ubitz_emu_t *e) {
+    if (e->active_valid && !e->active_is_nmi && (e->active_cpu_idx & 0x10) &&
+        (e->active_cpu_idx & 0x0F) < e->p.num_cpu_int) {
+        return (uint8_t)(1u << (e->active_cpu_idx & 0x0F));
+    }
+    return 0;
+}
+
+uint8_t ubitz_emu_cpu_nmi(const ubitz_emu_t *e) {
+    if (e->active_valid && e->active_is_nmi && (e->active_cpu_idx & 0x10) &&
+        (e->active_cpu_idx & 0x0F) < e->p.num_cpu_nmi) {
+        return (uint8_t)(1u << (e->active_cpu_idx & 0x0F));
+    }
+    return 0;
+}
+
+static uint8_t slot_ack_bits(const ubitz_emu_t *e, bool irq_ack) {
+    if (irq_ack && e->active_valid && !e->active_is_nmi && e->active_slot < e->p.num_slots) {
+        return (uint8_t)(1u << e->active_slot);
+    }
+    return 0;
+}
+
+// ------------------------------------------------------------------
+// Config bus
+// ------------------------------------------------------------------
+
+static void dec_write(ubitz_emu_t *e, uint8_t a, uint8_t d) {
+    if (a < e->mask_off) {
+        int w = a / e->cfg_bytes, b = a % e->cfg_bytes;
+        e->base[w] = ((e->base[w] & ~(0xFFu << (8 * b))) | ((uint32_t)d << (8 * b))) & e->addr_mask;
+    } else if (a < e->slot_off) {
+        int w = (a - e->mask_off) / e->cfg_bytes, b = (a - e->mask_off) % e->cfg_bytes;
+        e->mask[w] = ((e->mask[w] & ~(0xFFu << (8 * b))) | ((uint32_t)d << (8 * b))) & e->addr_mask;
+    } else if (a < e->op_off) {
+        e->slot[a - e->slot_off] = d & (SLOT_TYPE | SLOT_POSTED | SLOT_DOCK | SLOT_BRIDGE | 0x07);
+    } else if (a < e->dec_end) {
+        e->op[a - e->op_off] = d;
+    } else if (a < e->dec_end + e->p.num_mem_region * e->cfg_bytes) {
+        int r = (a - e->dec_end) / e->cfg_bytes, b = (a - e->dec_end) % e->cfg_bytes;
+        e->mem_base[r] = ((e->mem_base[r] & ~(0xFFu << (8 * b))) | ((uint32_t)d << (8 * b))) &
+                         e->addr_mask;
+    } else if (a < e->mem_end) {
+        e->mem_attr[a - e->dec_end - e->p.num_mem_region * e->cfg_bytes] = d;
+    }
+}
+
+static void irq_write(ubitz_emu_t *e, uint8_t idx, uint8_t d) {
+    uint8_t route = (uint8_t)(((d >> 3) & 0x10) | (d & 0x0F)); // {enable, dest[3:0]}
+    if (idx < e->num_int_src) {
+        e->int_route[idx] = route;
+    } else if (idx < e->coal_off) {
+        e->nmi_route[idx - e->nmi_off] = route;
+    } else if (idx < e->coal_snap) {
+        e->int_coal[idx - e->coal_off] = d;
+    } else if (idx == e->coal_snap) {
+        // Snapshot-and-clear (the CPLD does this a few clk later)
+        uint8_t sel = d & (uint8_t)((1u << idx_width(e->num_int_src)) - 1);
+        e->snap_sel = sel;
+        if (sel < e->num_int_src) {
+            e->snap_deliv     = e->cnt_deliv[sel];
+            e->snap_coal      = e->cnt_coal[sel];
+            e->cnt_deliv[sel] = 0;
+            e->cnt_coal[sel]  = 0;
+        }
+    }
+    refresh_route_maps(e);
+    e->irq_quiet = false;
+}
+
+static uint8_t irq_read(const ubitz_emu_t *e, uint8_t idx) {
+    if (idx < e->num_int_src) {
+        return (uint8_t)(((e->int_route[idx] & 0x10) << 3) | (e->int_route[idx] & 0x0F));
+    }
+    if (idx < e->coal_off) {
+        uint8_t r = e->nmi_route[idx - e->nmi_off];
+        return (uint8_t)(((r & 0x10) << 3) | (r & 0x0F));
+    }
+    if (idx < e->coal_snap) {
+        return e->int_coal[idx - e->coal_off];
+    }
+    if (idx == e->coal_snap) {
+        return e->snap_sel;
+    }
+    if (idx == e->coal_snap + 1) {
+        return e->snap_deliv;
+    }
+    if (idx == e->coal_snap + 2) {
+        return e->snap_coal;
+    }
+    return 0x00;
+}
+
+static uint8_t cap_byte(const ubitz_emu_t *e, uint8_t a) {
+    const ubitz_emu_params_t *p = &e->p;
+    switch (a) {
+    case CAP_MAGIC0:        return 0x55; // 'U'
+    case CAP_MAGIC1:        return 0x44; // 'D'
+    case CAP_VERSION:       return 0x01;
+    case CAP_ADDR_W:        return p->addr_w;
+    case CAP_NUM_WIN:       return p->num_win;
+    case CAP_NUM_RANGE_WIN: return p->num_range_win;
+    case CAP_NUM_SLOTS:     return p->num_slots;
+    case CAP_NUM_INT_CH:    return p->num_int_ch;
+    case CAP_NUM_CPU_INT:   return p->num_cpu_int;
+    case CAP_NUM_CPU_NMI:   return p->num_cpu_nmi;
+    case CAP_IRQ_BASE:      return p->irq_base;
+    case CAP_CFG_BYTES:     return e->cfg_bytes;
+    case CAP_BASE_OFF:      return 0x00;
+    case CAP_MASK_OFF:      return e->mask_off;
+    case CAP_SLOT_OFF:      return e->slot_off;
+    case CAP_OP_OFF:        return e->op_off;
+    case CAP_NMI_OFF:       return e->nmi_off;
+    case CAP_COAL_OFF:      return e->coal_off;
+    case CAP_COAL_SNAP:     return e->coal_snap;
+    case CAP_COAL_TICK_W:   return p->coal_tick_w;
+    case CAP_FEATURES:
+        return (uint8_t)(FEAT_BASE | (p->num_range_win ? FEAT_RANGE : 0) |
+                         (p->cfg_init ? FEAT_CFG_INIT : 0));
+    case CAP_SVC_SLOT:      return 0xFF;
+    case CAP_INIT_SUM0:     return (uint8_t)e->init_sum;
+    case CAP_INIT_SUM1:     return (uint8_t)(e->init_sum >> 8);
+    case CAP_BRIDGE_HOLD:   return p->bridge_hold;
+    case CAP_MEM_OFF:       return p->num_mem_region ? e->dec_end : 0x00;
+    case CAP_NUM_MEM_REGION: return p->num_mem_region;
+    default:                return 0x00;
+    }
+}
+
+void ubitz_emu_cfg_write(ubitz_emu_t *e, uint8_t addr, uint8_t data) {
+    if (addr < e->p.irq_base) {
+        dec_write(e, addr, data);
+    } else {
+        irq_write(e, (uint8_t)(addr - e->p.irq_base), data);
+    }
+}
+
+uint8_t ubitz_emu_cfg_read(ubitz_emu_t *e, uint8_t addr) {
+    if (addr < e->p.irq_base) {
+        return cap_byte(e, addr);
+    }
+    return irq_read(e, (uint8_t)(addr - e->p.irq_base));
+}
+
+// Same bytes as render_map() in ubitz_cpld_cfg.c for this build.
+static void render_map(const ubitz_emu_t *e, uint8_t *img,
+                       const ubitz_decode_binding_t *wins, int win_count,
+                       const ubitz_irq_binding_t *irqs, int irq_count,
+                       const ubitz_mem_binding_t *mems, int mem_count) {
+    memset(img, 0x00, 256);
+    memset(img + e->op_off, 0xFF, e->p.num_win);
+    if (win_count > e->p.num_win) {
+        win_count = e->p.num_win;
+    }
+    for (int w = 0; w < win_count; ++w) {
+        const ubitz_decode_binding_t *b = &wins[w];
+        bool range = (b->type == UBITZ_WIN_RANGE);
+        uint32_t mask = range ? b->limit : b->win.mask;
+        if (range && w >= e->p.num_range_win) {
+            continue;
+        }
+        for (int byte = 0; byte < e->cfg_bytes; ++byte) {
+            img[w * e->cfg_bytes + byte]               = (uint8_t)(b->win.iowin >> (8 * byte));
+            img[e->mask_off + w * e->cfg_bytes + byte] = (uint8_t)(mask >> (8 * byte));
+        }
+        img[e->slot_off + w] = ubitz_map_slot_byte(b);
+        img[e->op_off + w]   = ubitz_map_op_byte(b->win.opsel);
+    }
+    uint8_t *irq = img + e->p.irq_base;
+    for (int i = 0; i < irq_count; ++i) {
+        const ubitz_irq_binding_t *b = &irqs[i];
+        if (b->slot >= e->p.num_slots) {
+            continue;
+        }
+        for (int ch = 0; ch < e->p.num_int_ch; ++ch) {
+            if (b->route.channel & (1 << ch)) {
+                int idx = b->slot * e->p.num_int_ch + ch;
+                irq[idx]               = ubitz_map_route_byte(b->route.dest_pin);
+                irq[e->coal_off + idx] = b->route.coalesce;
+            }
+        }
+        if (b->route.channel & 0x10) {
+            uint8_t dest = b->route.dest_pin;
+            irq[e->nmi_off + b->slot] = ubitz_map_route_byte(dest >= 0x10 ? dest - 0x10 : dest);
+        }
+    }
+    if (mem_count > e->p.num_mem_region) {
+        mem_count = e->p.num_mem_region;
+    }
+    uint8_t *attr = img + e->dec_end + e->p.num_mem_region * e->cfg_bytes;
+    for (int r = 0; r < mem_count; ++r) {
+        for (int byte = 0; byte < e->cfg_bytes; ++byte) {
+            img[e->dec_end + r * e->cfg_bytes + byte] = (uint8_t)(mems[r].base >> (8 * byte));
+        }
+        attr[r] = ubitz_map_mem_attr(&mems[r]);
+    }
+}
+
+void ubitz_emu_load_bindings(ubitz_emu_t *e,
+                             const ubitz_decode_binding_t *wins, int win_count,
+                             const ubitz_irq_binding_t *irqs, int irq_count,
+                             const ubitz_mem_binding_t *mems, int mem_count) {
+    uint8_t img[256];
+    render_map(e, img, wins, win_count, irqs, irq_count, mems, mem_count);
+    for (int a = 0; a < e->mem_end; ++a) {
+        dec_write(e, (uint8_t)a, img[a]);
+    }
+    for (int i = 0; i < e->coal_snap; ++i) {
+        irq_write(e, (uint8_t)i, img[e->p.irq_base + i]);
+    }
+}
+
+// ------------------------------------------------------------------
+// Lifecycle
+// ------------------------------------------------------------------
+
+void ubitz_emu_default_params(ubitz_emu_params_t *p) {
+    memset(p, 0, sizeof(*p));
+    p->addr_w        = 32;
+    p->num_win       = 16;
+    p->num_range_win = 16;
+    p->num_slots     = 5;
+    p->num_int_ch    = 2;
+    p->num_cpu_int   = 4;
+    p->num_cpu_nmi   = 2;
+    p->irq_base      = 0xC0;
+    p->coal_tick_w   = 8;
+    p->post_min_cs   = 2;
+    p->bridge_hold   = 3;
+    p->num_mem_region = 4;
+    p->cfg_init      = NULL;
+}
+
+bool ubitz_emu_init(ubitz_emu_t *e, const ubitz_emu_params_t *p) {
+    memset(e, 0, sizeof(*e));
+    e->p = *p;
+    if (p->addr_w < 1 || p->addr_w > 32 || p->num_win < 1 || p->num_win > UBITZ_EMU_MAX_WIN ||
+        p->num_range_win > p->num_win || p->num_slots < 1 || p->num_slots > UBITZ_EMU_MAX_SLOTS ||
+        p->num_int_ch < 1 || p->num_int_ch > 4 ||
+        p->num_slots * p->num_int_ch > UBITZ_EMU_MAX_INT_SRC ||
+        p->num_cpu_int > 8 || p->num_cpu_nmi > 8 ||
+        p->coal_tick_w < 1 || p->coal_tick_w > 16 || p->post_min_cs > 7 ||
+        p->bridge_hold > 7 || p->num_mem_region > UBITZ_EMU_MAX_MEM_REGION) {
+        return false;
+    }
+    e->addr_mask   = (p->addr_w == 32) ? 0xFFFFFFFFu : ((1u << p->addr_w) - 1);
+    e->cfg_bytes   = (uint8_t)((p->addr_w + 7) / 8);
+    int mask_off   = p->num_win * e->cfg_bytes;
+    int dec_end    = 2 * mask_off + 2 * p->num_win;
+    int mem_end    = dec_end + p->num_mem_region * (e->cfg_bytes + 1);
+    int num_src    = p->num_slots * p->num_int_ch;
+    if (mem_end > p->irq_base || p->irq_base + 2 * num_src + p->num_slots + 3 > 256) {
+        return false; // top.v config layout checks
+    }
+    e->mask_off    = (uint8_t)mask_off;
+    e->slot_off    = (uint8_t)(2 * mask_off);
+    e->op_off      = (uint8_t)(2 * mask_off + p->num_win);
+    e->dec_end     = (uint8_t)dec_end;
+    e->mem_end     = (uint8_t)mem_end;
+    e->num_int_src = (uint8_t)num_src;
+    e->nmi_off     = (uint8_t)num_src;
+    e->coal_off    = (uint8_t)(num_src + p->num_slots);
+    e->coal_snap   = (uint8_t)(e->coal_off + num_src);
+
+    if (p->cfg_init) {
+        uint16_t s1 = 0, s2 = 0;
+        for (int i = 0; i < e->mem_end + e->coal_snap; ++i) {
+            int a = (i < e->mem_end) ? i : p->irq_base + i - e->mem_end;
+            s1 = (s1 + p->cfg_init[a]) % 255;
+            s2 = (s2 + s1) % 255;
+        }
+        e->init_sum = (uint16_t)((s2 << 8) | s1);
+        for (int a = 0; a < e->mem_end; ++a) {
+            dec_write(e, (uint8_t)a, p->cfg_init[a]);
+        }
+    } else {
+        memset(e->op, 0xFF, sizeof(e->op));
+    }
+    ubitz_emu_reset(e);
+    return true;
+}
+
+void ubitz_emu_reset(ubitz_emu_t *e) {
+    // irq_router: routes/coalescing back to their power-on bytes
+    for (int i = 0; i < e->coal_snap; ++i) {
+        irq_write(e, (uint8_t)i, e->p.cfg_init ? e->p.cfg_init[e->p.irq_base + i] : 0x00);
+    }
+    e->snap_sel = e->snap_deliv = e->snap_coal = 0;
+    e->host_mask = e->pending_int = e->req_q = e->coal_run = 0;
+    e->pending_nmi = 0;
+    e->active_valid = e->active_is_nmi = false;
+    e->active_slot = e->active_ch = e->active_cpu_idx = 0;
+    memset(e->coal_cnt, 0, sizeof(e->coal_cnt));
+    memset(e->cnt_deliv, 0, sizeof(e->cnt_deliv));
+    memset(e->cnt_coal, 0, sizeof(e->cnt_coal));
+    e->prescale  = 0;
+    e->irq_quiet = false;
+
+    // addr_decoder_fsm and the top-level Dock window write capture
+    e->state = S_IDLE;
+    e->active_slot_fsm = e->cs_host = e->cs_post = e->hold_cnt = 0;
+    e->post_slot = e->post_cnt = 0;
+    e->post_drain = e->post_capture = false;
+    e->post_addr  = 0;
+    e->ready_n = true;
+    e->ready_meta = e->ready_sync = 0xFF;
+    e->dock_wr_pend = false;
+    e->dock_wr_addr = e->dock_wr_data = 0;
+
+    e->now = 0;
+    e->drain_end = 0;
+    e->io_post = false;
+    e->io_down = NULL;
+}
+
+// ------------------------------------------------------------------
+// Transaction mode
+// ------------------------------------------------------------------
+
+void ubitz_emu_attach(ubitz_emu_t *e, uint8_t slot, const ubitz_emu_tile_t *tile) {
+    if (slot >= UBITZ_EMU_MAX_SLOTS) {
+        return;
+    }
+    if (tile) {
+        e->tile[slot] = *tile;
+    } else {
+        memset(&e->tile[slot], 0, sizeof(e->tile[slot]));
+    }
+}
+
+void ubitz_emu_attach_dock(ubitz_emu_t *e, uint8_t slot, ubitz_emu_t *down) {
+    if (slot >= UBITZ_EMU_MAX_SLOTS || down == e) {
+        return;
+    }
+    e->down[slot] = down;
+    e->down_mask  = down ? (uint8_t)(e->down_mask | (1u << slot))
+                         : (uint8_t)(e->down_mask & ~(1u << slot));
+    e->irq_quiet  = false;
+}
+
+void ubitz_emu_set_int(ubitz_emu_t *e, uint8_t slot, uint8_t ch, bool level) {
+    if (slot >= e->p.num_slots || ch >= e->p.num_int_ch) {
+        return;
+    }
+    uint32_t bit = 1u << (slot * e->p.num_int_ch + ch);
+    e->int_req = level ? (e->int_req | bit) : (e->int_req & ~bit);
+    e->irq_quiet = false;
+}
+
+void ubitz_emu_set_nmi(ubitz_emu_t *e, uint8_t slot, bool level) {
+    if (slot >= e->p.num_slots) {
+        return;
+    }
+    uint8_t bit = (uint8_t)(1u << slot);
+    e->nmi_req = level ? (e->nmi_req | bit) : (e->nmi_req & ~bit);
+    e->irq_quiet = false;
+}
+
+// Request levels of the slots holding downstream Docks: their cpu_int[c]
+// on INT_CHc, cpu_nmi[0] on NMI.
+static void down_levels(const ubitz_emu_t *e, uint32_t *int_req, uint8_t *nmi_req) {
+    for (uint8_t m = e->down_mask; m; m &= (uint8_t)(m - 1)) {
+        int s = lowest_bit(m);
+        if (s >= e->p.num_slots) {
+            continue;
+        }
+        uint8_t ci = ubitz_emu_cpu_int(e->down[s]);
+        for (int c = 0; c < e->p.num_int_ch; ++c) {
+            uint32_t bit = 1u << (s * e->p.num_int_ch + c);
+            *int_req = ((ci >> c) & 1) ? (*int_req | bit) : (*int_req & ~bit);
+        }
+        uint8_t nbit = (uint8_t)(1u << s);
+        *nmi_req = (ubitz_emu_cpu_nmi(e->down[s]) & 1) ? (uint8_t)(*nmi_req | nbit)
+                                                       : (uint8_t)(*nmi_req & ~nbit);
+    }
+}
+
+// Nothing in the chain changes on further edges: every router settled, no
+// coalescing timer running and every bridge slot already sees its Dock.
+static bool chain_idle(const ubitz_emu_t *e) {
+    if (!e->irq_quiet || e->coal_run) {
+        return false;
+    }
+    uint32_t int_req = e->int_req;
+    uint8_t  nmi_req = e->nmi_req;
+    down_levels(e, &int_req, &nmi_req);
+    if (int_req != e->int_req || nmi_req != e->nmi_req) {
+        return false;
+    }
+    for (uint8_t m = e->down_mask; m; m &= (uint8_t)(m - 1)) {
+        if (!chain_idle(e->down[lowest_bit(m)])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void chain_skip(ubitz_emu_t *e, uint64_t clks) {
+    const uint32_t tick_max = (1u << e->p.coal_tick_w) - 1;
+    e->prescale = (uint32_t)((e->prescale + clks) & tick_max);
+    e->now += clks;
+    for (uint8_t m = e->down_mask; m; m &= (uint8_t)(m - 1)) {
+        chain_skip(e->down[lowest_bit(m)], clks);
+    }
+}
+
+// One clk edge of the whole chain: every router samples the levels its
+// downstream Docks drove before the edge.
+static void chain_step(ubitz_emu_t *e) {
+    uint32_t int_req = e->int_req;
+    uint8_t  nmi_req = e->nmi_req;
+    down_levels(e, &int_req, &nmi_req);
+    for (uint8_t m = e->down_mask; m; m &= (uint8_t)(m - 1)) {
+        chain_step(e->down[lowest_bit(m)]);
+    }
+    e->int_req   = int_req;
+    e->nmi_req   = nmi_req;
+    e->irq_quiet = !irq_step(e);
+    e->now++;
+}
+
+void ubitz_emu_advance(ubitz_emu_t *e, uint64_t clks) {
+    const uint32_t tick_max = (1u << e->p.coal_tick_w) - 1;
+    if (e->down_mask) {
+        while (clks) {
+            if (chain_idle(e)) {
+                chain_skip(e, clks);
+                break;
+            }
+            chain_step(e);
+            clks--;
+        }
+        return;
+    }
+    while (clks) {
+        if (e->irq_quiet) {
+            // Nothing changes until a running coalescing timer ticks.
+            uint64_t skip = e->coal_run ? ((tick_max - e->prescale) & tick_max) : clks;
+            if (skip > clks) {
+                skip = clks;
+            }
+            e->prescale = (uint32_t)((e->prescale + skip) & tick_max);
+            e->now += skip;
+            clks   -= skip;
+            if (!clks) {
+                break;
+            }
+        }
+        e->irq_quiet = !irq_step(e);
+        e->now++;
+        clks--;
+    }
+}
+
+int ubitz_emu_irq_ack(ubitz_emu_t *e) {
+    uint8_t ack = slot_ack_bits(e, true);
+    if (!ack) {
+        return -1;
+    }
+    if (e->down[e->active_slot]) {
+        ubitz_emu_irq_ack(e->down[e->active_slot]); // slot_ack is its irq_ack
+        return e->active_slot;
+    }
+    const ubitz_emu_tile_t *t = &e->tile[e->active_slot];
+    if (t->ack) {
+        t->ack(t->ctx);
+    }
+    return e->active_slot;
+}
+
+// Host cycle whose /IORQ is first seen on clk edge `edge`. Waits follow the
+// RTL: a Tile that is ready holds /READY low for the one clk the FSM takes to
+// see its synchronized ready; a busy Tile adds its busy clocks plus the two
+// synchronizer flops. A BRIDGE window holds /READY low for at least
+// BRIDGE_HOLD + 1 clocks; the downstream Dock sees /CS one edge later and its
+// /READY needs three more edges to come back, so a hop adds 4 clocks. Any
+// decoded cycle that starts before a posted drain is over waits for it; the
+// drain itself is scheduled by post_finish once the Host's release is known.
+static void io_at(ubitz_emu_t *e, uint64_t edge, uint32_t addr, bool read, uint8_t wdata,
+                  bool vector, ubitz_emu_access_t *out) {
+    decode_t d;
+    addr &= e->addr_mask;
+    decode(e, addr, read, vector, &d);
+    e->io_post = false;
+    e->io_down = NULL;
+
+    out->data  = read ? 0xFF : wdata;
+    out->slot  = UBITZ_EMU_NO_SLOT;
+    out->win   = d.vector ? -1 : d.win;
+    out->flags = 0;
+    out->hops  = 0;
+    out->wait  = 0;
+
+    if (!d.valid) {
+        out->flags = UBITZ_EMU_F_UNMAPPED;
+        return;
+    }
+    if (e->drain_end >= edge) {
+        out->wait = (uint32_t)(e->drain_end + 1 - edge);
+        edge = e->drain_end + 1;
+    }
+    if (d.dock) {
+        out->flags = UBITZ_EMU_F_DOCK;
+        if (read) {
+            out->data = host_read(e, (uint8_t)addr);
+        } else {
+            host_write(e, (uint8_t)addr, wdata);
+        }
+        return;
+    }
+    if (d.vector) {
+        out->flags = UBITZ_EMU_F_VECTOR;
+    }
+
+    const uint32_t hold = d.bridge ? e->p.bridge_hold : 0;
+    ubitz_emu_t *down = (d.sel_slot < e->p.num_slots) ? e->down[d.sel_slot] : NULL;
+    if (down) {
+        // slot_ack (irq_ack during the vector read) is its vector cycle
+        ubitz_emu_access_t sub;
+        io_at(down, edge + 1, addr, read, wdata, d.vector, &sub);
+        e->io_down = down;
+        out->slot  = d.sel_slot;
+        out->data  = sub.data;
+        out->flags = (uint8_t)(UBITZ_EMU_F_BRIDGE | sub.flags);
+        out->hops  = (uint8_t)(sub.hops + 1);
+        // Before edge + 4 the synchronizer still shows the idle Dock's ready
+        uint32_t w = hold + 1;
+        if (hold >= 3 && sub.wait + 4 > w) {
+            w = sub.wait + 4;
+        }
+        out->wait += w;
+        return;
+    }
+
+    const ubitz_emu_tile_t *t = (d.sel_slot < e->p.num_slots) ? &e->tile[d.sel_slot] : NULL;
+    uint32_t busy = 0;
+    if (t) {
+        out->slot = d.sel_slot;
+        if (read && t->read) {
+            busy = t->read(t->ctx, addr, d.vector, &out->data);
+        } else if (!read && t->write) {
+            busy = t->write(t->ctx, addr, wdata);
+        }
+    }
+    if (d.post_req) {
+        e->io_post      = true;
+        e->io_post_busy = busy;
+        out->flags     |= UBITZ_EMU_F_POSTED;
+        return;
+    }
+    uint32_t w = busy ? busy + 3 : 1;
+    out->wait += (hold + 1 > w) ? hold + 1 : w;
+}
+
+// The cycle's /IORQ is first seen high on edge `rel` (one edge later for
+// each hop down, as each /CS is registered); a posted write drains from
+// there for POST_MIN_CS + 1 clocks or until its Tile is ready.
+static void post_finish(ubitz_emu_t *e, uint64_t rel) {
+    for (; e; e = e->io_down, ++rel) {
+        if (!e->io_post) {
+            continue;
+        }
+        uint64_t end = rel + e->p.post_min_cs + 1;
+        if (e->io_post_busy && rel + e->io_post_busy + 3 > end) {
+            end = rel + e->io_post_busy + 3;
+        }
+        e->drain_end = end;
+        e->io_post   = false;
+    }
+}
+
+void ubitz_emu_io(ubitz_emu_t *e, uint32_t addr, bool read, uint8_t wdata,
+                  bool vector, ubitz_emu_access_t *out) {
+    const uint64_t edge = e->now + 1;
+    io_at(e, edge, addr, read, wdata, vector, out);
+    // The Host raises /IORQ right after /READY
+    post_finish(e, edge + out->wait + 1);
+}
+
+// ------------------------------------------------------------------
+// Cycle mode
+// ------------------------------------------------------------------
+
+static uint8_t slot_to_cs(const ubitz_emu_t *e, uint8_t slot) {
+    return (slot < e->p.num_slots) ? (uint8_t)(1u << slot) : 0;
+}
+
+static bool slot_ready_n(const ubitz_emu_t *e, uint8_t slot) {
+    return (slot < e->p.num_slots) ? ((e->ready_sync >> slot) & 1) : true;
+}
+
+// mem_decoder: lowest enabled region whose BASE equals addr on every bit at
+// or above SIZE.
+int ubitz_emu_mem(const ubitz_emu_t *e, uint32_t addr, uint8_t *space) {
+    addr &= e->addr_mask;
+    for (int r = 0; r < e->p.num_mem_region; ++r) {
+        uint8_t attr = e->mem_attr[r];
+        uint8_t size = attr & 0x1F;
+        uint32_t cmp = (size >= 32) ? 0 : (e->addr_mask & ~((1u << size) - 1u));
+        if ((attr & 0x80) && ((addr ^ e->mem_base[r]) & cmp) == 0) {
+            if (space) {
+                *space = (attr >> 5) & 0x3;
+            }
+            return r;
+        }
+    }
+    return -1;
+}
+
+// top.v irq_host_we: the pending IRQ status window write is applied once the
+// Host is no longer writing the same register in a DOCK cycle.
+static bool dock_wr_apply(const ubitz_emu_t *e, const ubitz_emu_pins_in_t *in,
+                          const decode_t *d) {
+    bool own = d->dock && !in->r_w_ && (in->addr & 0x0F) == e->dock_wr_addr;
+    return e->dock_wr_pend && !own;
+}
+
+void ubitz_emu_eval(const ubitz_emu_t *e, const ubitz_emu_pins_in_t *in,
+                    ubitz_emu_pins_out_t *out) {
+    const bool iorq = !in->iorq_n;
+    decode_t d = { 0 };
+    if (iorq) {
+        decode(e, in->addr & e->addr_mask, in->r_w_, in->irq_vec_cycle, &d);
+    } else if (in->irq_vec_cycle && irq_int_active(e)) {
+        // Override is not qualified by /IORQ in addr_decoder.
+        d.valid    = true;
+        d.sel_slot = e->active_slot;
+        d.vector   = true;
+        d.win      = -1;
+    }
+    const uint8_t slots = (uint8_t)((1u << e->p.num_slots) - 1);
+    bool host_we = dock_wr_apply(e, in, &d);
+
+    out->ready_n   = e->ready_n && !(d.dock && host_we); // dock_wr_stall
+    out->io_r_w_   = e->post_drain ? false : in->iorq_n ? true : in->r_w_;
+    out->data_oe_n = !(iorq && d.valid && !d.post_req && !e->post_drain);
+    out->data_dir  = in->r_w_;
+    out->ff_oe_n   = !(iorq && !d.valid && in->r_w_);
+    out->post_le   = e->post_capture;
+    out->post_oe_n = !e->post_drain;
+    out->post_addr = e->post_addr;
+    out->addr_oe_n = e->post_drain;
+    out->cs_n      = (uint8_t)(~(e->cs_host | e->cs_post) & slots);
+    out->cpu_int   = ubitz_emu_cpu_int(e);
+    out->cpu_nmi   = ubitz_emu_cpu_nmi(e);
+    out->slot_ack  = slot_ack_bits(e, in->irq_ack);
+    out->dock_sel  = d.dock;
+    out->dock_doe  = d.dock && in->r_w_;
+    out->dock_dout = d.dock ? host_read(e, host_we ? e->dock_wr_addr : (uint8_t)in->addr) : 0x00;
+    out->win_valid = d.valid;
+    out->win_index = (d.win >= 0) ? (uint8_t)d.win : 0;
+    out->sel_slot  = d.sel_slot;
+
+    // Bank cycles: combinational, no FSM involvement
+    uint8_t space = 0;
+    bool bank = !in->mreq_n && in->iorq_n && ubitz_emu_mem(e, in->addr, &space) >= 0;
+    out->bank_cs_n = !bank;
+    out->mem0_cs_n = bank ? (space & 1) : true;
+    out->mem1_cs_n = bank ? !(((space >> 1) ^ space) & 1) : true;
+}
+
+void ubitz_emu_clock(ubitz_emu_t *e, const ubitz_emu_pins_in_t *in,
+                     ubitz_emu_pins_out_t *out) {
+    const bool iorq = !in->iorq_n;
+    decode_t d = { 0 };
+    if (iorq) {
+        decode(e, in->addr & e->addr_mask, in->r_w_, in->irq_vec_cycle, &d);
+    }
+    const bool data_oe = iorq && d.valid && !d.post_req && !e->post_drain;
+
+    // addr_decoder_fsm
+    uint8_t state = e->state, act = e->active_slot_fsm, cs_host = e->cs_host;
+    uint8_t hold = e->hold_cnt;
+    bool    ready_n = e->ready_n, capture = false;
+    switch (e->state) {
+    case S_IDLE:
+        cs_host = 0;
+        ready_n = true;
+        if (iorq && d.valid && e->post_drain) {
+            ready_n = false; // Tile bus busy with a posted write
+        } else if (iorq && d.valid && d.dock) {
+            // Dock register window: no /CS, no wait
+        } else if (iorq && d.valid && d.post_req) {
+            act     = d.sel_slot;
+            state   = S_POSTED;
+            capture = true;
+        } else if (iorq && d.valid) {
+            act     = d.sel_slot;
+            state   = S_ACTIVE;
+            cs_host = slot_to_cs(e, d.sel_slot);
+            ready_n = false;
+            hold    = d.bridge ? e->p.bridge_hold : 0;
+        }
+        break;
+    case S_ACTIVE:
+        cs_host = slot_to_cs(e, e->active_slot_fsm);
+        if (hold) {
+            hold--;
+            ready_n = false; // downstream Dock's /READY not through the sync yet
+        } else {
+            ready_n = slot_ready_n(e, e->active_slot_fsm);
+        }
+        if (!iorq) {
+            cs_host = 0;
+            hold    = 0;
+            state   = S_IDLE;
+        }
+        break;
+    case S_POSTED:
+        ready_n = true;
+        if (!iorq) {
+            state = S_IDLE;
+        }
+        break;
+    default:
+        state   = S_IDLE;
+        cs_host = 0;
+        ready_n = true;
+        break;
+    }
+
+    // Drain engine
+    bool    drain = e->post_drain;
+    uint8_t post_slot = e->post_slot, post_cnt = e->post_cnt, cs_post = e->cs_post;
+    if (e->state == S_POSTED && !iorq) {
+        drain     = true;
+        post_slot = e->active_slot_fsm;
+        post_cnt  = 0;
+        cs_post   = slot_to_cs(e, e->active_slot_fsm);
+    } else if (e->post_drain) {
+        if (post_cnt < e->p.post_min_cs) {
+            post_cnt++;
+        } else if (slot_ready_n(e, post_slot)) {
+            drain   = false;
+            cs_post = 0;
+        }
+    }
+
+    // IRQ status window write: captured during the cycle, applied after it
+    const bool    host_we = dock_wr_apply(e, in, &d);
+    const uint8_t wr_addr = e->dock_wr_addr, wr_data = e->dock_wr_data;
+    if (host_we) {
+        e->dock_wr_pend = false;
+    } else if (d.dock && !in->r_w_ && data_oe) {
+        e->dock_wr_pend = true;
+        e->dock_wr_addr = (uint8_t)(in->addr & 0x0F);
+        e->dock_wr_data = in->dock_din;
+    } else {
+        e->dock_wr_pend = false;
+    }
+
+    e->irq_quiet = !irq_step(e);
+    if (host_we) {
+        host_write(e, wr_addr, wr_data);
+    }
+
+    e->ready_sync      = e->ready_meta;
+    e->ready_meta      = in->dev_ready_n;
+    e->state           = state;
+    e->active_slot_fsm = act;
+    e->cs_host         = cs_host;
+    e->hold_cnt        = hold;
+    e->ready_n         = ready_n;
+    e->post_capture    = capture;
+    if (iorq && d.valid && d.post_req && !e->post_drain) {
+        e->post_addr = in->addr & e->addr_mask; // addr_decoder_datapath
+    }
+    e->post_drain      = drain;
+    e->post_slot       = post_slot;
+    e->post_cnt        = post_cnt;
+    e->cs_post         = cs_post;
+    e->now++;
+
+    if (out) {
+        ubitz_emu_eval(e, in, out);
+    }
+}
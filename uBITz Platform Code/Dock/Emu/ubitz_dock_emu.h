@@ -0,0 +1,219 @@
+#pragma once
+// Software model of the Dock CPLD (HDL/src/top.v) for host-side system
+// emulators. Two ways to drive it, sharing one state:
+//   - Transaction mode: ubitz_emu_io() performs a whole Host I/O cycle,
+//     calling the selected Tile's callbacks and reporting the /READY wait the
+//     Dock would insert; ubitz_emu_advance() moves the clk domain on so the
+//     interrupt router (coalescing timers, selection) keeps real time.
+//   - Cycle mode: ubitz_emu_clock() evaluates one clk edge from the pins and
+//     returns the pins after it, matching the RTL clock for clock.
+// Bank memory cycles never wait: ubitz_emu_mem() and the mem pins of
+// ubitz_emu_eval() give the Bank /CS and space select for an address.
+// Tables come from the config bus (ubitz_emu_cfg_write/read, byte-exact with
+// the CPLD including the capability block) or straight from the MCU's
+// binding structures (ubitz_emu_load_bindings), so the emulator decodes the
+// same map the Dock firmware would program. Docks chained behind BRIDGE
+// windows (ubitz_emu_attach_dock) are run by the head Dock: its I/O cycles
+// continue downstream and its clk steps the whole chain.
+//
+// Not modelled: the bus trace (trace bytes read 0x00) and the Dock services
+// slot (attach a Tile to that slot instead); the capability block reports a
+// build with TRACE_EN = SVC_EN = 0. Config accesses take effect at once
+// rather than crossing the cfg_clk domain.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ubitz_map.h"
+
+#define UBITZ_EMU_MAX_WIN     32
+#define UBITZ_EMU_MAX_SLOTS   8
+#define UBITZ_EMU_MAX_INT_SRC 32  // NUM_SLOTS * NUM_TILE_INT_CH
+#define UBITZ_EMU_MAX_MEM_REGION 8
+#define UBITZ_EMU_NO_SLOT     0xFF
+
+// Build parameters, same names and defaults as top.v.
+typedef struct {
+    uint8_t  addr_w;          // 1-32
+    uint8_t  num_win;         // <= UBITZ_EMU_MAX_WIN
+    uint8_t  num_range_win;
+    uint8_t  num_slots;       // <= UBITZ_EMU_MAX_SLOTS
+    uint8_t  num_int_ch;      // 1-4, num_slots * num_int_ch <= 32
+    uint8_t  num_cpu_int;
+    uint8_t  num_cpu_nmi;
+    uint8_t  irq_base;        // IRQ_CFG_BASE
+    uint8_t  coal_tick_w;     // coalescing tick = 2^coal_tick_w clk cycles
+    uint8_t  post_min_cs;     // POST_MIN_CS of addr_decoder_fsm
+    uint8_t  bridge_hold;     // BRIDGE_HOLD, <= 7
+    uint8_t  num_mem_region;  // NUM_MEM_REGION, <= UBITZ_EMU_MAX_MEM_REGION
+    const uint8_t *cfg_init;  // 256-byte baked map (CFG_INIT), NULL = none
+} ubitz_emu_params_t;
+
+// Tile model for transaction mode. read/write return how many clk cycles the
+// Tile keeps its /READY low from /CS (0 = ready at once); the callbacks run
+// when the Dock asserts /CS. vector marks a Mode-2 vector fetch. ack is the
+// slot_ack pulse. Any callback may be NULL (reads then return 0xFF).
+typedef struct {
+    uint32_t (*read)(void *ctx, uint32_t addr, bool vector, uint8_t *data);
+    uint32_t (*write)(void *ctx, uint32_t addr, uint8_t data);
+    void     (*ack)(void *ctx);
+    void     *ctx;
+} ubitz_emu_tile_t;
+
+// Result of a transaction-mode I/O cycle.
+#define UBITZ_EMU_F_UNMAPPED 0x01  // no window: reads return the 0xFF filler
+#define UBITZ_EMU_F_POSTED   0x02  // posted write, drained to the Tile afterwards
+#define UBITZ_EMU_F_DOCK     0x04  // answered by the IRQ status window
+#define UBITZ_EMU_F_VECTOR   0x08  // Mode-2 vector fetch steered to the INT slot
+#define UBITZ_EMU_F_BRIDGE   0x10  // went on to a downstream Dock; other flags are its
+
+typedef struct {
+    uint8_t  data;   // read data (writes: the byte written)
+    uint8_t  slot;   // slot that got /CS on this Dock, UBITZ_EMU_NO_SLOT for none
+    int8_t   win;    // matched window, -1 for none or a vector override
+    uint8_t  flags;  // UBITZ_EMU_F_*
+    uint8_t  hops;   // BRIDGE windows crossed
+    uint32_t wait;   // clk cycles /READY is held low (as the bus trace counts)
+} ubitz_emu_access_t;
+
+// Cycle-mode pins (active-low names as on top.v).
+typedef struct {
+    uint32_t addr;
+    bool     iorq_n;
+    bool     mreq_n;
+    bool     r_w_;           // 1 = read
+    bool     irq_vec_cycle;
+    bool     irq_ack;
+    uint8_t  dev_ready_n;    // bit = slot
+    uint8_t  dock_din;
+} ubitz_emu_pins_in_t;
+
+typedef struct {
+    bool     ready_n;
+    bool     io_r_w_;
+    bool     data_oe_n;
+    bool     data_dir;
+    bool     ff_oe_n;
+    bool     post_le;
+    bool     post_oe_n;
+    uint32_t post_addr;      // Tile address while post_oe_n is low
+    bool     addr_oe_n;
+    uint8_t  cs_n;           // bit = slot
+    uint8_t  cpu_int;
+    uint8_t  cpu_nmi;
+    uint8_t  slot_ack;
+    uint8_t  dock_dout;
+    bool     dock_doe;
+    bool     win_valid;
+    uint8_t  win_index;
+    uint8_t  sel_slot;
+    bool     dock_sel;
+    bool     bank_cs_n;
+    bool     mem0_cs_n;
+    bool     mem1_cs_n;
+} ubitz_emu_pins_out_t;
+
+// Emulator state. Fields are internal; use the functions below.
+typedef struct ubitz_emu {
+    ubitz_emu_params_t p;
+    uint32_t addr_mask;
+    uint8_t  cfg_bytes, mask_off, slot_off, op_off, dec_end;
+    uint8_t  mem_end;      // Bank region table ends the decoder bytes (dec_end = MEM_OFF)
+    uint8_t  num_int_src, nmi_off, coal_off, coal_snap;
+    uint16_t init_sum;
+
+    // addr_decoder_cfg tables
+    uint32_t base[UBITZ_EMU_MAX_WIN];
+    uint32_t mask[UBITZ_EMU_MAX_WIN];
+    uint8_t  slot[UBITZ_EMU_MAX_WIN];   // raw SLOT byte
+    uint8_t  op[UBITZ_EMU_MAX_WIN];
+
+    // mem_decoder tables
+    uint32_t mem_base[UBITZ_EMU_MAX_MEM_REGION];
+    uint8_t  mem_attr[UBITZ_EMU_MAX_MEM_REGION];  // {EN, SPACE[1:0], SIZE[4:0]}
+
+    // irq_router config and state
+    uint8_t  int_route[UBITZ_EMU_MAX_INT_SRC];  // {enable, dest[3:0]}
+    uint8_t  nmi_route[UBITZ_EMU_MAX_SLOTS];
+    uint8_t  int_coal[UBITZ_EMU_MAX_INT_SRC];
+    uint32_t int_en, coal_on, coal_hold;        // per-route bitmaps of the above
+    uint8_t  nmi_en;
+    uint32_t int_req, host_mask, pending_int, req_q, coal_run;
+    uint8_t  nmi_req, pending_nmi;
+    bool     active_valid, active_is_nmi;
+    uint8_t  active_slot, active_ch, active_cpu_idx;
+    uint8_t  coal_cnt[UBITZ_EMU_MAX_INT_SRC];
+    uint8_t  cnt_deliv[UBITZ_EMU_MAX_INT_SRC];
+    uint8_t  cnt_coal[UBITZ_EMU_MAX_INT_SRC];
+    uint32_t prescale;
+    uint8_t  snap_sel, snap_deliv, snap_coal;
+    bool     irq_quiet;  // last router step changed nothing
+
+    // addr_decoder_fsm and top (cycle mode)
+    uint8_t  state, active_slot_fsm, cs_host, cs_post, hold_cnt;
+    uint8_t  post_slot, post_cnt;
+    bool     post_drain, post_capture, ready_n;
+    uint32_t post_addr;
+    uint8_t  ready_meta, ready_sync;
+    bool     dock_wr_pend;
+    uint8_t  dock_wr_addr, dock_wr_data;
+
+    // transaction mode
+    uint64_t now;          // clk cycles since reset
+    uint64_t drain_end;    // clk edge that ends the current posted drain
+    ubitz_emu_tile_t tile[UBITZ_EMU_MAX_SLOTS];
+
+    // Docks behind BRIDGE slots, and the last cycle's posted write to finish
+    struct ubitz_emu *down[UBITZ_EMU_MAX_SLOTS];
+    uint8_t  down_mask;
+    bool     io_post;
+    uint32_t io_post_busy;
+    struct ubitz_emu *io_down;
+} ubitz_emu_t;
+
+// top.v defaults: 32-bit, 16 windows, 5 slots x 2 channels, 4 INT / 2 NMI.
+void    ubitz_emu_default_params(ubitz_emu_params_t *p);
+// Power-on: tables from cfg_init (or the defaults), then reset. Returns false
+// for parameters the Dock cannot be built with.
+bool    ubitz_emu_init(ubitz_emu_t *e, const ubitz_emu_params_t *p);
+// rst_n pulse: clears the clk-domain state and reloads the IRQ routes; the
+// decoder tables keep their contents, as in the CPLD.
+void    ubitz_emu_reset(ubitz_emu_t *e);
+
+// Shared config bus (decoder below irq_base, irq_router above it).
+void    ubitz_emu_cfg_write(ubitz_emu_t *e, uint8_t addr, uint8_t data);
+uint8_t ubitz_emu_cfg_read(ubitz_emu_t *e, uint8_t addr);
+// Program a map exactly as ubitz_cpld_program_map() does on the Dock.
+void    ubitz_emu_load_bindings(ubitz_emu_t *e,
+                                const ubitz_decode_binding_t *wins, int win_count,
+                                const ubitz_irq_binding_t *irqs, int irq_count,
+                                const ubitz_mem_binding_t *mems, int mem_count);
+
+// Transaction mode.
+void    ubitz_emu_attach(ubitz_emu_t *e, uint8_t slot, const ubitz_emu_tile_t *tile);
+// Put a downstream Dock in slot (NULL removes it). Its Host side follows this
+// Dock's /CS, its cpu_int[c]/cpu_nmi[0] drive the slot's INT_CHc/NMI and
+// slot_ack is its irq_ack. Advance and ack only the head of a chain.
+void    ubitz_emu_attach_dock(ubitz_emu_t *e, uint8_t slot, ubitz_emu_t *down);
+void    ubitz_emu_io(ubitz_emu_t *e, uint32_t addr, bool read, uint8_t wdata,
+                     bool vector, ubitz_emu_access_t *out);
+// Bank memory cycle (/MREQ low, /IORQ high) at addr: the matched region, or
+// -1 when the Bank /CS stays high. *space gets its ubitz_memspace_t. No clk
+// time passes: Bank cycles are decoded combinationally and never wait.
+int     ubitz_emu_mem(const ubitz_emu_t *e, uint32_t addr, uint8_t *space);
+// irq_ack pulse: calls the owning Tile's ack and returns its slot, or -1.
+int     ubitz_emu_irq_ack(ubitz_emu_t *e);
+void    ubitz_emu_set_int(ubitz_emu_t *e, uint8_t slot, uint8_t ch, bool level);
+void    ubitz_emu_set_nmi(ubitz_emu_t *e, uint8_t slot, bool level);
+// Run the clk domain for clks cycles; idle stretches cost O(1).
+void    ubitz_emu_advance(ubitz_emu_t *e, uint64_t clks);
+uint8_t ubitz_emu_cpu_int(const ubitz_emu_t *e);
+uint8_t ubitz_emu_cpu_nmi(const ubitz_emu_t *e);
+
+// Cycle mode: one clk edge with `in` held across it; `out` may be NULL.
+// Interrupt lines come from ubitz_emu_set_int/set_nmi. Attached Docks are
+// not clocked here; wire chains pin by pin with ubitz_emu_eval.
+void    ubitz_emu_clock(ubitz_emu_t *e, const ubitz_emu_pins_in_t *in,
+                        ubitz_emu_pins_out_t *out);
+// The pins for `in` without a clk edge.
+void    ubitz_emu_eval(const ubitz_emu_t *e, const ubitz_emu_pins_in_t *in,
+                       ubitz_emu_pins_out_t *out);
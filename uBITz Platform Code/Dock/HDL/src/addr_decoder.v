@@ -2,16 +2,25 @@
 // µBITz Dock - Address Decoder / Bus Arbiter
 //--------------------------------------------------------------------
 // Responsibilities:
-//   • Decode up to NUM_WIN I/O windows based on BASE/MASK registers.
+//   • Decode up to NUM_WIN I/O windows based on BASE/MASK registers, or on
+//     inclusive BASE/LIMIT ranges for windows whose TYPE bit is set.
 //   • Select a target slot (0..NUM_SLOTS-1) and assert its /CS_n line.
 //   • Implement the /READY handshake with per-slot DEV_READY_N inputs.
 //   • Control Host<->Tile data transceivers (enable + direction).
 //   • Drive a constant 0xFF value onto the Host data bus for unmapped
 //     I/O read cycles (via FF_OE_N).
+//   • Post writes to windows flagged POSTED: release /READY at once, capture
+//     the data in an external register (POST_LE) and complete the /CS
+//     handshake with the Tile afterwards (POST_OE_N).
+//   • Flag hits on windows marked DOCK (dock_sel): Dock-internal registers
+//     answered by top with no /CS and no wait states.
+//   • Flag hits on windows marked BRIDGE: the slot holds a downstream Dock,
+//     so the FSM keeps /READY low until that Dock's own /READY has had time
+//     to come back through the synchronizer (BRIDGE_HOLD).
 //
 // Walkthrough:
-//   1) addr_decoder_cfg flattens BASE/MASK/SLOT/OP config regs into
-//      wide buses (base_flat/mask_flat/slot_flat/op_flat).
+//   1) addr_decoder_cfg flattens BASE/MASK/SLOT/OP/TYPE config regs into
+//      wide buses (base_flat/mask_flat/slot_flat/op_flat/type_flat).
 //   2) addr_decoder_match compares addr/r_w_/iorq_n against those tables,
 //      producing decoded hit info: is_read_sig/is_write_sig, win_valid_sig,
 //      win_index_sig, and sel_slot_sig.
@@ -19,10 +28,15 @@
 //      vector fetch (irq_vec_cycle + irq_int_active), steering /CS to the
 //      active interrupt slot even if the address is otherwise unmapped.
 //   4) addr_decoder_fsm consumes win_valid_mux/sel_slot_mux with dev_ready_n
-//      to generate per-slot cs signals and the ready_n handshake.
+//      to generate per-slot cs signals and the ready_n handshake. Writes to a
+//      POSTED window (post_req_mux) take the posted path and are drained to
+//      the Tile after the Host cycle ends. BRIDGE hits (bridge_hit_mux) hold
+//      /READY low for BRIDGE_HOLD extra clocks.
 //   5) addr_decoder_datapath uses win_valid_mux/is_read_sig/is_write_sig to
 //      drive transceiver enables (data_oe_n/data_dir) and the 0xFF filler
-//      driver (ff_oe_n), plus a qualified io_r_w_.
+//      driver (ff_oe_n), plus a qualified io_r_w_ and the posted-write
+//      register controls (post_le/post_oe_n), and latches the posted write's
+//      address (post_addr/addr_oe_n) so the drain reaches the right register.
 //
 // Notes:
 //   - DATA bus itself does NOT pass through this module; only the
@@ -34,9 +48,17 @@
 //--------------------------------------------------------------------
 module addr_decoder #(
     parameter ADDR_W    = 32, // address bus width (up to 32)
-    parameter NUM_WIN   = 16, // number of decode windows (up to 16)
+    parameter NUM_WIN   = 16, // number of decode windows
     parameter NUM_SLOTS = 5,   // number of chip-select outputs (slots)
-	parameter integer SLOT_IDX_WIDTH  = (NUM_SLOTS <= 1) ? 1 : $clog2(NUM_SLOTS)
+    parameter NUM_RANGE_WIN = NUM_WIN, // windows with BASE/LIMIT range support
+	parameter integer SLOT_IDX_WIDTH  = (NUM_SLOTS <= 1) ? 1 : $clog2(NUM_SLOTS),
+    // win_index width: 4 bits up to 16 windows (legacy port width), wider beyond
+    parameter integer WIN_INDEX_W     = (NUM_WIN <= 16) ? 4 : $clog2(NUM_WIN),
+    // Baked power-on window tables (see addr_decoder_cfg), byte a at [8a +: 8]
+    parameter integer CFG_INIT_EN     = 0,
+    parameter [2047:0] CFG_INIT       = 2048'd0,
+    // Forced /READY-low clocks after /CS on a BRIDGE window (see addr_decoder_fsm)
+    parameter integer BRIDGE_HOLD     = 3
 )(
     input  [ADDR_W-1:0] addr,
     input               iorq_n,
@@ -66,14 +88,19 @@ module addr_decoder #(
     output                  data_oe_n,   // active-low enable for Host<->Tiles data transceivers
     output                  data_dir,    // 1 = Tiles->Host (read), 0 = Host->Tiles (write)
     output                  ff_oe_n,     // active-low enable for constant-0xFF driver onto Host bus
+    output                  post_le,     // active-high capture strobe for the posted-write register
+    output                  post_oe_n,   // active-low enable: posted-write register -> Tile bus
+    output     [ADDR_W-1:0] post_addr,   // posted write's address, driven to Tiles while post_oe_n is low
+    output                  addr_oe_n,   // active-low enable for the Host->Tile address buffer
 
     output reg                    win_valid,
-    output reg [3:0]              win_index,
+    output reg [WIN_INDEX_W-1:0]  win_index,
     output reg [2:0]              sel_slot,
+    output reg                    dock_sel,   // current cycle hits a Dock register window
+    output reg  [NUM_SLOTS-1:0]   bridge_slots, // slots some BRIDGE window points at
     output      [NUM_SLOTS-1:0]   cs_n
 );
 
-    localparam integer WIN_INDEX_W = 4; // supports NUM_WIN <= 16
     // Width needed to index NUM_SLOTS slots (matches irq_router)
     //localparam integer SLOT_IDX_WIDTH = (NUM_SLOTS <= 1) ? 1 : $clog2(NUM_SLOTS);
 
@@ -82,6 +109,10 @@ module addr_decoder #(
     logic [NUM_WIN*ADDR_W-1:0] mask_flat; // concatenated MASK registers
     logic [NUM_WIN*3-1:0]      slot_flat; // concatenated SLOT selects
     logic [NUM_WIN*8-1:0]      op_flat;   // concatenated OP gating fields
+    logic [NUM_WIN-1:0]        type_flat; // per-window TYPE (1 = range)
+    logic [NUM_WIN-1:0]        posted_flat; // per-window POSTED write flag
+    logic [NUM_WIN-1:0]        dock_flat;   // per-window DOCK register flag
+    logic [NUM_WIN-1:0]        bridge_flat; // per-window BRIDGE flag
 
     // Handshake / CS (active-high internal view)
     logic [NUM_SLOTS-1:0] cs;
@@ -91,21 +122,36 @@ module addr_decoder #(
     logic                  is_write_sig;     // 1 when current cycle is a write
     logic [WIN_INDEX_W-1:0] win_index_sig;   // index of matched window
     logic [2:0]            sel_slot_sig;     // slot chosen by window match
+    logic                  win_posted_sig;   // matched window has POSTED set
+    logic                  win_dock_sig;     // matched window has DOCK set
+    logic                  win_bridge_sig;   // matched window has BRIDGE set
     logic                  win_valid_sig;    // decode hit (qualified by /IORQ)
     // Slot actually used for /CS generation (may be overridden for vector reads)
     logic [2:0]            sel_slot_mux;     // final slot after vector override
     // Muxed view for FSM/datapath (may be overridden during vector cycles)
     logic                  win_valid_mux;    // final win_valid after override
+    // Posted-write request (never for vector cycles, which are reads anyway)
+    logic                  post_req_mux;
+    // Dock register hit (never for vector cycles, which go to the INT slot)
+    logic                  dock_hit_mux;
+    // Downstream Dock hit (vector cycles follow the INT slot's bridge flag)
+    logic                  bridge_hit_mux;
 
     // Ready signal from FSM
     logic ready_n_sig; // internal ready_n before output mapping
 
+    // Posted-write status from FSM
+    logic post_capture_sig; // capture strobe for the posted register
+    logic post_drain_sig;   // posted write being driven to its Tile
+
     // -----------------------------------------------------------------
     // Submodules
     // -----------------------------------------------------------------
     addr_decoder_cfg #(
-        .ADDR_W (ADDR_W),
-        .NUM_WIN(NUM_WIN)
+        .ADDR_W     (ADDR_W),
+        .NUM_WIN    (NUM_WIN),
+        .CFG_INIT_EN(CFG_INIT_EN),
+        .CFG_INIT   (CFG_INIT)
     ) u_cfg (
         .cfg_clk   (cfg_clk),
         .cfg_we    (cfg_we),
@@ -114,13 +160,18 @@ module addr_decoder #(
         .base_flat (base_flat),
         .mask_flat (mask_flat),
         .slot_flat (slot_flat),
-        .op_flat   (op_flat)
+        .op_flat   (op_flat),
+        .type_flat (type_flat),
+        .posted_flat(posted_flat),
+        .dock_flat (dock_flat),
+        .bridge_flat(bridge_flat)
     );
 
     addr_decoder_match #(
         .ADDR_W     (ADDR_W),
         .NUM_WIN    (NUM_WIN),
-        .WIN_INDEX_W(WIN_INDEX_W)
+        .WIN_INDEX_W(WIN_INDEX_W),
+        .NUM_RANGE_WIN(NUM_RANGE_WIN)
     ) u_match (
         .addr      (addr),
         .iorq_n    (iorq_n),
@@ -129,13 +180,32 @@ module addr_decoder #(
         .mask_flat (mask_flat),
         .slot_flat (slot_flat),
         .op_flat   (op_flat),
+        .type_flat (type_flat),
+        .posted_flat(posted_flat),
+        .dock_flat (dock_flat),
+        .bridge_flat(bridge_flat),
         .is_read   (is_read_sig),
         .is_write  (is_write_sig),
         .win_valid (win_valid_sig),
         .win_index (win_index_sig),
-        .sel_slot  (sel_slot_sig)
+        .sel_slot  (sel_slot_sig),
+        .win_posted(win_posted_sig),
+        .win_dock  (win_dock_sig),
+        .win_bridge(win_bridge_sig)
     );
 
+    // -----------------------------------------------------------------
+    // Slots behind a BRIDGE window (DOCK windows never name a slot).
+    // irq_router tags their interrupts, vector fetches to them are bridged.
+    // -----------------------------------------------------------------
+    always_comb begin
+        bridge_slots = {NUM_SLOTS{1'b0}};
+        for (int w = 0; w < NUM_WIN; w++) begin
+            if (bridge_flat[w] && !dock_flat[w] && (slot_flat[w*3 +: 3] < NUM_SLOTS))
+                bridge_slots[slot_flat[w*3 +: 3]] = 1'b1;
+        end
+    end
+
     // -----------------------------------------------------------------
     // Slot selection + win_valid override for Mode-2 vector read cycles
     // -----------------------------------------------------------------
@@ -143,6 +213,10 @@ module addr_decoder #(
         // Defaults: use decoded values from the match logic
         sel_slot_mux  = sel_slot_sig;
         win_valid_mux = win_valid_sig;
+        dock_hit_mux  = win_valid_sig && win_dock_sig;
+        // A bridged write cannot be posted: the downstream Dock answers it
+        bridge_hit_mux = win_valid_sig && win_bridge_sig && !win_dock_sig;
+        post_req_mux  = win_posted_sig && is_write_sig && !win_dock_sig && !win_bridge_sig;
 
         // If this cycle has been tagged as the Mode-2 vector read
         // *and* there is an active maskable INT, override the slot
@@ -156,32 +230,53 @@ module addr_decoder #(
             if (irq_int_slot < NUM_SLOTS) begin
                 sel_slot_mux  = {{(3-SLOT_IDX_WIDTH){1'b0}}, irq_int_slot};
                 win_valid_mux = 1'b1;
+                post_req_mux  = 1'b0;
+                dock_hit_mux  = 1'b0;
+                bridge_hit_mux = bridge_slots[irq_int_slot];
             end
         end
     end
 
     addr_decoder_fsm #(
-        .NUM_SLOTS(NUM_SLOTS)
+        .NUM_SLOTS  (NUM_SLOTS),
+        .BRIDGE_HOLD(BRIDGE_HOLD)
     ) u_fsm (
         .clk         (clk),
         .rst_n       (rst_n),
         .iorq_n      (iorq_n),
         .win_valid   (win_valid_mux),
         .sel_slot    (sel_slot_mux),
+        .post_req    (post_req_mux),
+        .dock_hit    (dock_hit_mux),
+        .bridge_hit  (bridge_hit_mux),
         .dev_ready_n (dev_ready_n),
         .cs          (cs),
-        .ready_n     (ready_n_sig)
+        .ready_n     (ready_n_sig),
+        .post_capture(post_capture_sig),
+        .post_drain  (post_drain_sig)
     );
 
-    addr_decoder_datapath u_dp (
+    addr_decoder_datapath #(
+        .ADDR_W    (ADDR_W)
+    ) u_dp (
+        .clk       (clk),
+        .rst_n     (rst_n),
+        .addr      (addr),
         .iorq_n    (iorq_n),
         .is_read   (is_read_sig),
         .is_write  (is_write_sig),
         .win_valid (win_valid_mux),
+        .post_req  (post_req_mux),
+        .post_capture(post_capture_sig),
+        .post_drain(post_drain_sig),
         .data_oe_n (data_oe_n),
         .data_dir  (data_dir),
         .ff_oe_n   (ff_oe_n),
-        .io_r_w_   (io_r_w_)
+        .io_r_w_   (io_r_w_),
+        .post_le   (post_le),
+        .post_oe_n (post_oe_n),
+        .post_addr (post_addr),
+        .addr_oe_n (addr_oe_n)
     );
 
     // -----------------------------------------------------------------
@@ -194,6 +289,7 @@ module addr_decoder #(
         win_valid = win_valid_mux;
         win_index = win_index_sig;
         sel_slot  = sel_slot_mux;
+        dock_sel  = dock_hit_mux;
     end
 
 endmodule
@@ -1,28 +1,41 @@
 // Submodule: addr_decoder_cfg
 // Purpose: configuration storage for BASE/MASK/SLOT/OP tables.
 // Walkthrough:
-//   - Flattened config arrays (base_flat/mask_flat/slot_flat/op_flat) hold all
-//     window entries back-to-back.
+//   - Flattened config arrays (base_flat/mask_flat/slot_flat/op_flat/type_flat/
+//     posted_flat/dock_flat/bridge_flat) hold all window entries back-to-back.
 //   - CFG layout (byte addressed):
 //       * BASE bytes  : BASE_OFF + w*CFG_BYTES + byte
-//       * MASK bytes  : MASK_OFF + w*CFG_BYTES + byte
-//       * SLOT (3b)   : SLOT_OFF + w
+//       * MASK bytes  : MASK_OFF + w*CFG_BYTES + byte (LIMIT for range windows)
+//       * SLOT (3b)   : SLOT_OFF + w, bits [2:0]
+//       * TYPE (1b)   : SLOT_OFF + w, bit 7 (0 = BASE/MASK, 1 = BASE/LIMIT range)
+//       * POSTED (1b) : SLOT_OFF + w, bit 6 (1 = writes are posted)
+//       * DOCK (1b)   : SLOT_OFF + w, bit 5 (1 = Dock registers, no Tile)
+//       * BRIDGE (1b) : SLOT_OFF + w, bit 4 (1 = slot holds a downstream Dock)
 //       * OP (8b)     : OP_OFF   + w
 //   - cfg_we strobes in a single byte on cfg_clk. No readback path here; users
 //     should track writes externally or probe the flattened outputs.
+//   - Power-on values: BASE/MASK/SLOT = 0, OP = 0xFF, or with CFG_INIT_EN the
+//     bytes of CFG_INIT (byte a at CFG_INIT[8a +: 8], same layout as above),
+//     so a default map can be baked into the bitstream (gen_cfg_init.sh).
 module addr_decoder_cfg #(
     parameter integer ADDR_W  = 32,
-    parameter integer NUM_WIN = 16
+    parameter integer NUM_WIN = 16,
+    parameter integer CFG_INIT_EN = 0,
+    parameter [2047:0] CFG_INIT   = 2048'd0
 )(
     input  logic        cfg_clk,
     input  logic        cfg_we,
     input  logic [7:0]  cfg_addr,
     input  logic [7:0]  cfg_wdata,
 
-    output logic [NUM_WIN*ADDR_W-1:0] base_flat = '0,
-    output logic [NUM_WIN*ADDR_W-1:0] mask_flat = '0,
-    output logic [NUM_WIN*3-1:0]      slot_flat = '0,
-    output logic [NUM_WIN*8-1:0]      op_flat   = {NUM_WIN*8{1'b1}} // all ones = 0xFF per byte
+    output logic [NUM_WIN*ADDR_W-1:0] base_flat,
+    output logic [NUM_WIN*ADDR_W-1:0] mask_flat,
+    output logic [NUM_WIN*3-1:0]      slot_flat,
+    output logic [NUM_WIN-1:0]        type_flat,   // 1 = range window
+    output logic [NUM_WIN-1:0]        posted_flat, // 1 = posted-write window
+    output logic [NUM_WIN-1:0]        dock_flat,   // 1 = Dock register window
+    output logic [NUM_WIN-1:0]        bridge_flat, // 1 = window forwards to a downstream Dock
+    output logic [NUM_WIN*8-1:0]      op_flat
 );
 
     // Number of bytes needed to represent the ADDR_W-bit BASE/MASK fields.
@@ -34,6 +47,41 @@ module addr_decoder_cfg #(
     localparam integer SLOT_OFF = MASK_OFF + (NUM_WIN * CFG_BYTES);
     localparam integer OP_OFF   = SLOT_OFF + NUM_WIN;
 
+    // Power-on byte at config address a
+    function automatic [7:0] init_byte(input integer a, input [7:0] dflt);
+        init_byte = CFG_INIT_EN ? CFG_INIT[8*a +: 8] : dflt;
+    endfunction
+
+    function automatic [NUM_WIN*ADDR_W-1:0] init_addr_tbl(input integer off);
+        init_addr_tbl = '0;
+        for (int w = 0; w < NUM_WIN; w++)
+            for (int b = 0; b < CFG_BYTES; b++)
+                init_addr_tbl[w*ADDR_W + 8*b +: 8] = init_byte(off + w*CFG_BYTES + b, 8'h00);
+    endfunction
+
+    function automatic [NUM_WIN*8-1:0] init_byte_tbl(input integer off, input [7:0] dflt);
+        for (int w = 0; w < NUM_WIN; w++)
+            init_byte_tbl[w*8 +: 8] = init_byte(off + w, dflt);
+    endfunction
+
+    localparam [NUM_WIN*ADDR_W-1:0] INIT_BASE = init_addr_tbl(BASE_OFF);
+    localparam [NUM_WIN*ADDR_W-1:0] INIT_MASK = init_addr_tbl(MASK_OFF);
+    localparam [NUM_WIN*8-1:0]      INIT_SLOT = init_byte_tbl(SLOT_OFF, 8'h00);
+    localparam [NUM_WIN*8-1:0]      INIT_OP   = init_byte_tbl(OP_OFF,   8'hFF);
+
+    initial begin
+        base_flat = INIT_BASE;
+        mask_flat = INIT_MASK;
+        op_flat   = INIT_OP;
+        for (int w = 0; w < NUM_WIN; w++) begin
+            slot_flat[w*3 +: 3] = INIT_SLOT[w*8 +: 3];
+            type_flat[w]        = INIT_SLOT[w*8 + 7];
+            posted_flat[w]      = INIT_SLOT[w*8 + 6];
+            dock_flat[w]        = INIT_SLOT[w*8 + 5];
+            bridge_flat[w]      = INIT_SLOT[w*8 + 4];
+        end
+    end
+
     // Byte-wise config writes, with explicit region decode
 	always_ff @(posedge cfg_clk) begin
         if (cfg_we) begin
@@ -51,10 +99,16 @@ module addr_decoder_cfg #(
                         mask_flat[w*ADDR_W + 8*b +: 8] <= cfg_wdata;
                 end
             end
-            // SLOT regs
+            // SLOT regs (bit 7 carries the window TYPE, bit 6 POSTED, bit 5 DOCK,
+            // bit 4 BRIDGE)
             for (int w = 0; w < NUM_WIN; w++) begin
-                if (cfg_addr == (SLOT_OFF + w))
+                if (cfg_addr == (SLOT_OFF + w)) begin
                     slot_flat[w*3 +: 3] <= cfg_wdata[2:0];
+                    type_flat[w]        <= cfg_wdata[7];
+                    posted_flat[w]      <= cfg_wdata[6];
+                    dock_flat[w]        <= cfg_wdata[5];
+                    bridge_flat[w]      <= cfg_wdata[4];
+                end
             end
             // OP regs
             for (int w = 0; w < NUM_WIN; w++) begin
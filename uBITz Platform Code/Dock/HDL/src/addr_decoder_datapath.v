@@ -1,20 +1,40 @@
 // Submodule: addr_decoder_datapath
-// Purpose: control data transceivers and 0xFF filler driver.
+// Purpose: control data transceivers, 0xFF filler driver and posted-write register.
 // Walkthrough:
 //   - Qualify current cycle with /IORQ to get io_cycle.
 //   - win_valid marks mapped I/O; unmapped cycles drive the 0xFF filler on reads.
 //   - data_oe_n gates transceivers, data_dir selects direction, io_r_w_ hands
 //     the CPU read/write intent to tiles during active cycles.
-module addr_decoder_datapath (
+//   - Posted writes bypass the transceivers: post_le captures Host data into an
+//     external register, and post_oe_n drives that register onto the Tile bus
+//     while the FSM drains the write. io_r_w_ reads "write" during the drain.
+//   - post_addr holds the posted write's address. It loads on the clock edge
+//     that raises post_capture (the Host is still in the cycle there) and,
+//     with post_oe_n low, drives the Tile address bus for the drain while
+//     addr_oe_n turns the Host->Tile address buffer off; the Host may already
+//     be on its next cycle.
+module addr_decoder_datapath #(
+    parameter integer ADDR_W = 32
+)(
+    input  logic clk,
+    input  logic rst_n,
+    input  logic [ADDR_W-1:0] addr,
     input  logic iorq_n,
     input  logic is_read,
     input  logic is_write,
     input  logic win_valid,
+    input  logic post_req,     // current hit is a posted write
+    input  logic post_capture, // FSM capture strobe for the posted register
+    input  logic post_drain,   // FSM is driving a posted write to its Tile
 
     output logic data_oe_n,
     output logic data_dir,
     output logic ff_oe_n,
-    output logic io_r_w_
+    output logic io_r_w_,
+    output logic post_le,      // active-high latch enable for the posted-write register
+    output logic post_oe_n,    // active-low output enable for the posted-write register
+    output logic [ADDR_W-1:0] post_addr, // posted write's address, Tile bus while post_oe_n is low
+    output logic addr_oe_n     // active-low enable for the Host->Tile address buffer
 );
 
     // Cycle qualifiers
@@ -24,6 +44,7 @@ module addr_decoder_datapath (
     logic mapped_read;   // mapped and read direction
     logic mapped_write;  // mapped and write direction
     logic unmapped_read; // unmapped read (used to gate filler driver)
+    logic xcvr_ok;       // Tile bus free for a Host<->Tile transfer
 
     assign io_cycle     = ~iorq_n;
     assign mapped_io    = io_cycle & win_valid;
@@ -31,13 +52,28 @@ module addr_decoder_datapath (
     assign mapped_read  = mapped_io   & is_read;
     assign mapped_write = mapped_io   & is_write;
     assign unmapped_read= unmapped_io & is_read;
+    assign xcvr_ok      = ~post_req & ~post_drain;
 
-    assign data_oe_n = ~(mapped_read | mapped_write);
+    assign data_oe_n = ~((mapped_read | mapped_write) & xcvr_ok);
     assign data_dir  = is_read;
     assign ff_oe_n   = ~unmapped_read;
 
     // Qualified R/W_ for tiles: during I/O cycles pass through CPU's R/W_,
-    // otherwise default to 'read'.
-    assign io_r_w_ = iorq_n ? 1'b1 : is_read;
+    // otherwise default to 'read'. A draining posted write is always a write.
+    assign io_r_w_ = post_drain ? 1'b0 :
+                     iorq_n     ? 1'b1 : is_read;
+
+    assign post_le   = post_capture;
+    assign post_oe_n = ~post_drain;
+    assign addr_oe_n = post_drain;
+
+    // Same condition the FSM accepts a posted write on (post_req already
+    // excludes DOCK/BRIDGE hits); a hit during a drain is stalled, not taken.
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n)
+            post_addr <= {ADDR_W{1'b0}};
+        else if (mapped_write && post_req && !post_drain)
+            post_addr <= addr;
+    end
 
 endmodule
@@ -6,8 +6,27 @@
 //     sel_slot into active_slot, asserts corresponding cs, drives ready_n low.
 //   - ACTIVE: holds cs for active_slot while /IORQ is low; ready_n reflects
 //     dev_ready_sync[active_slot]; deasserts cs and returns to IDLE when /IORQ rises.
+//   - POSTED: entered instead of ACTIVE for a write to a posted window
+//     (post_req=1). ready_n stays high so the host completes with no wait
+//     states; post_capture strobes the external posted-write register for one
+//     clock. When /IORQ rises the drain engine takes over: it asserts cs for
+//     the posted slot (post_drain=1) for at least POST_MIN_CS clocks and until
+//     that slot's synchronized ready, then releases it.
+//   - A hit on a Dock register window (dock_hit=1) is answered inside the
+//     CPLD: no cs, ready_n stays high (zero wait states), FSM stays in IDLE.
+//   - A hit on a BRIDGE window (bridge_hit=1) targets a downstream Dock whose
+//     /READY only reaches dev_ready_sync three clocks after this FSM asserts
+//     cs (its FSM edge, then the two sync flops). ACTIVE therefore forces
+//     ready_n low for BRIDGE_HOLD clocks before following the sync, so a stale
+//     "ready" from the idle downstream Dock never ends the cycle early. Add one
+//     for a downstream Dock on an unrelated clock.
+//   - While a drain is in progress, mapped host cycles are held in IDLE with
+//     ready_n low (the Tile-side data bus is owned by the posted register);
+//     unmapped cycles proceed as usual.
 module addr_decoder_fsm #(
-    parameter integer NUM_SLOTS = 5
+    parameter integer NUM_SLOTS   = 5,
+    parameter integer POST_MIN_CS = 2, // min drain /CS clocks (covers ready sync latency), <= 7
+    parameter integer BRIDGE_HOLD = 3  // forced /READY-low clocks for BRIDGE hits, <= 7
 )(
     input  logic              clk,
     input  logic              rst_n,
@@ -15,11 +34,16 @@ module addr_decoder_fsm #(
     input  logic              iorq_n,
     input  logic              win_valid,
     input  logic [2:0]        sel_slot,
+    input  logic              post_req,     // this hit is a write to a posted window
+    input  logic              dock_hit,     // this hit targets Dock registers, not a slot
+    input  logic              bridge_hit,   // this hit targets a downstream Dock
 
     input  logic [NUM_SLOTS-1:0] dev_ready_n,
 
     output logic [NUM_SLOTS-1:0] cs,
-    output logic                  ready_n
+    output logic                  ready_n,
+    output logic                  post_capture, // 1-clock strobe: capture host write data
+    output logic                  post_drain    // posted write being driven to its Tile
 );
 
     // Synchronizer for dev_ready_n into clk domain
@@ -36,14 +60,25 @@ module addr_decoder_fsm #(
         end
     end
 
-    localparam logic S_IDLE   = 1'b0; // waiting for /IORQ hit
-    localparam logic S_ACTIVE = 1'b1; // servicing an active /IORQ
+    localparam logic [1:0] S_IDLE   = 2'd0; // waiting for /IORQ hit
+    localparam logic [1:0] S_ACTIVE = 2'd1; // servicing an active /IORQ
+    localparam logic [1:0] S_POSTED = 2'd2; // posted write accepted, waiting for /IORQ high
 
-    logic       state;       // FSM state
-    logic [2:0] active_slot; // latched slot during ACTIVE
+    logic [1:0] state;       // FSM state
+    logic [2:0] active_slot; // latched slot during ACTIVE/POSTED
+    logic [2:0] hold_cnt;    // BRIDGE_HOLD clocks left in ACTIVE
+
+    // Host-cycle and drain-engine chip selects (never both active)
+    logic [NUM_SLOTS-1:0] cs_host;
+    logic [NUM_SLOTS-1:0] cs_post;
+    logic [2:0]           post_slot; // slot being drained
+    logic [2:0]           post_cnt;  // drain /CS clocks elapsed
+
+    assign cs = cs_host | cs_post;
 
     // Guarded ready selection (default ready when out of range)
-    wire sel_dev_ready_n = (active_slot < NUM_SLOTS) ? dev_ready_sync[active_slot] : 1'b1;
+    wire sel_dev_ready_n  = (active_slot < NUM_SLOTS) ? dev_ready_sync[active_slot] : 1'b1;
+    wire post_dev_ready_n = (post_slot   < NUM_SLOTS) ? dev_ready_sync[post_slot]   : 1'b1;
 
     function [NUM_SLOTS-1:0] slot_to_cs(input logic [2:0] slot_sel);
         logic [NUM_SLOTS-1:0] tmp;
@@ -57,43 +92,95 @@ module addr_decoder_fsm #(
 
     always_ff @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
-            state       <= S_IDLE;
-            active_slot <= 3'd0;
-            cs          <= {NUM_SLOTS{1'b0}};
-            ready_n     <= 1'b1;
+            state        <= S_IDLE;
+            active_slot  <= 3'd0;
+            hold_cnt     <= 3'd0;
+            cs_host      <= {NUM_SLOTS{1'b0}};
+            ready_n      <= 1'b1;
+            post_capture <= 1'b0;
         end else begin
+            post_capture <= 1'b0;
+
             case (state)
                 S_IDLE: begin
-                    cs      <= {NUM_SLOTS{1'b0}};
+                    cs_host <= {NUM_SLOTS{1'b0}};
                     ready_n <= 1'b1;
 
-                    if (!iorq_n && win_valid) begin
+                    if (!iorq_n && win_valid && post_drain) begin
+                        // Tile bus busy with a posted write: stall until it drains
+                        ready_n <= 1'b0;
+                    end else if (!iorq_n && win_valid && dock_hit) begin
+                        cs_host <= {NUM_SLOTS{1'b0}};
+                        ready_n <= 1'b1;
+                    end else if (!iorq_n && win_valid && post_req) begin
+                        active_slot  <= sel_slot;
+                        state        <= S_POSTED;
+                        post_capture <= 1'b1;
+                        ready_n      <= 1'b1;
+                    end else if (!iorq_n && win_valid) begin
                         active_slot <= sel_slot;
                         state       <= S_ACTIVE;
-                        cs          <= slot_to_cs(sel_slot);
+                        cs_host     <= slot_to_cs(sel_slot);
                         ready_n     <= 1'b0;
+                        hold_cnt    <= bridge_hit ? BRIDGE_HOLD[2:0] : 3'd0;
                     end else if (!iorq_n && !win_valid) begin
-                        cs      <= {NUM_SLOTS{1'b0}};
+                        cs_host <= {NUM_SLOTS{1'b0}};
                         ready_n <= 1'b1;
                     end
                 end
                 S_ACTIVE: begin
-                    cs <= slot_to_cs(active_slot);
+                    cs_host <= slot_to_cs(active_slot);
 
-                    if (sel_dev_ready_n) begin
+                    if (hold_cnt != 3'd0) begin
+                        hold_cnt <= hold_cnt - 3'd1;
+                        ready_n  <= 1'b0;
+                    end else if (sel_dev_ready_n) begin
                         ready_n <= 1'b1;
                     end else begin
                         ready_n <= 1'b0;
                     end
 
                     if (iorq_n) begin
-                        cs      <= {NUM_SLOTS{1'b0}};
-                        state   <= S_IDLE;
+                        cs_host  <= {NUM_SLOTS{1'b0}};
+                        hold_cnt <= 3'd0;
+                        state    <= S_IDLE;
                         // ready_n will be driven high in S_IDLE
                     end
                 end
+                S_POSTED: begin
+                    ready_n <= 1'b1;
+                    if (iorq_n)
+                        state <= S_IDLE; // drain engine picks up active_slot
+                end
+                default: begin
+                    state   <= S_IDLE;
+                    cs_host <= {NUM_SLOTS{1'b0}};
+                    ready_n <= 1'b1;
+                end
             endcase
         end
     end
 
+    // Drain engine: completes the /CS handshake for a posted write on its own.
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            post_drain <= 1'b0;
+            post_slot  <= 3'd0;
+            post_cnt   <= 3'd0;
+            cs_post    <= {NUM_SLOTS{1'b0}};
+        end else if (state == S_POSTED && iorq_n) begin
+            post_drain <= 1'b1;
+            post_slot  <= active_slot;
+            post_cnt   <= 3'd0;
+            cs_post    <= slot_to_cs(active_slot);
+        end else if (post_drain) begin
+            if (post_cnt < POST_MIN_CS) begin
+                post_cnt <= post_cnt + 3'd1;
+            end else if (post_dev_ready_n) begin
+                post_drain <= 1'b0;
+                cs_post    <= {NUM_SLOTS{1'b0}};
+            end
+        end
+    end
+
 endmodule
@@ -1,15 +1,21 @@
 // Submodule: addr_decoder_match
 // Purpose: window match, priority select, and slot selection.
 // Walkthrough:
-//   - Unpacks flattened BASE/MASK/SLOT/OP tables into arrays.
-//   - For each window: compute masked address equality, apply OP gating
-//     (any/read-only/write-only), and qualify with /IORQ low to form win_active.
+//   - Unpacks flattened BASE/MASK/SLOT/OP/TYPE tables into arrays.
+//   - For each window: compute masked address equality, or for range windows
+//     (TYPE=1) the inclusive magnitude check BASE <= addr <= LIMIT where LIMIT
+//     lives in the MASK register. Apply OP gating (any/read-only/write-only),
+//     and qualify with /IORQ low to form win_active.
+//   - Only windows below NUM_RANGE_WIN get magnitude comparators; TYPE is
+//     ignored above that so smaller builds can trade range support for LCs.
 //   - Priority encoder picks the lowest-index active window; sel_slot maps that
-//     window to its configured slot value.
+//     window to its configured slot value, win_posted to its POSTED flag,
+//     win_dock to its DOCK flag and win_bridge to its BRIDGE flag.
 module addr_decoder_match #(
     parameter integer ADDR_W      = 32,
     parameter integer NUM_WIN     = 16,
-    parameter integer WIN_INDEX_W = 4
+    parameter integer WIN_INDEX_W = 4,
+    parameter integer NUM_RANGE_WIN = NUM_WIN // windows [0, NUM_RANGE_WIN) support TYPE=1
 )(
     input  logic [ADDR_W-1:0] addr,
     input  logic              iorq_n,
@@ -19,13 +25,20 @@ module addr_decoder_match #(
     input  logic [NUM_WIN*ADDR_W-1:0] mask_flat,
     input  logic [NUM_WIN*3-1:0]      slot_flat,
     input  logic [NUM_WIN*8-1:0]      op_flat,
+    input  logic [NUM_WIN-1:0]        type_flat,
+    input  logic [NUM_WIN-1:0]        posted_flat,
+    input  logic [NUM_WIN-1:0]        dock_flat,
+    input  logic [NUM_WIN-1:0]        bridge_flat,
 
     output logic              is_read,
     output logic              is_write,
 
     output logic                   win_valid,
     output logic [WIN_INDEX_W-1:0] win_index,
-    output logic [2:0]             sel_slot
+    output logic [2:0]             sel_slot,
+    output logic                   win_posted,
+    output logic                   win_dock,
+    output logic                   win_bridge
 );
 
     // Unpacked config entries per window
@@ -37,6 +50,8 @@ module addr_decoder_match #(
     // Per-window match helpers
     logic [ADDR_W-1:0] masked_equal [0:NUM_WIN-1]; // ~(addr ^ base)
     logic [ADDR_W-1:0] bit_match    [0:NUM_WIN-1]; // (~mask) | masked_equal
+    logic [NUM_WIN-1:0] mask_hit;                  // BASE/MASK equality hit
+    logic [NUM_WIN-1:0] range_hit;                 // BASE <= addr <= LIMIT
     logic [NUM_WIN-1:0] op_ok;                     // OP gating satisfied
     logic [NUM_WIN-1:0] raw_hit;                   // address match (unqualified)
     logic [NUM_WIN-1:0] hit;                       // address + op gating
@@ -66,7 +81,16 @@ module addr_decoder_match #(
                 (op[gw] == 8'h01 && is_read) ||
                 (op[gw] == 8'h00 && is_write);
 
-            assign raw_hit[gw]    = &bit_match[gw];
+            assign mask_hit[gw] = &bit_match[gw];
+
+            if (gw < NUM_RANGE_WIN) begin : gen_range
+                assign range_hit[gw] = (addr >= base[gw]) && (addr <= mask[gw]);
+                assign raw_hit[gw]   = type_flat[gw] ? range_hit[gw] : mask_hit[gw];
+            end else begin : gen_mask_only
+                assign range_hit[gw] = 1'b0;
+                assign raw_hit[gw]   = mask_hit[gw];
+            end
+
             assign hit[gw]        = raw_hit[gw] & op_ok[gw];
             assign win_active[gw] = hit[gw] & ~iorq_n;
         end
@@ -84,11 +108,18 @@ module addr_decoder_match #(
         end
     end
 
-    // Map window index to slot
+    // Map window index to slot, posted-write, Dock register and bridge flags
     always_comb begin
-        sel_slot = 3'b000;
-        if (win_valid)
-            sel_slot = slot[win_index];
+        sel_slot   = 3'b000;
+        win_posted = 1'b0;
+        win_dock   = 1'b0;
+        win_bridge = 1'b0;
+        if (win_valid) begin
+            sel_slot   = slot[win_index];
+            win_posted = posted_flat[win_index];
+            win_dock   = dock_flat[win_index];
+            win_bridge = bridge_flat[win_index];
+        end
     end
 
 endmodule
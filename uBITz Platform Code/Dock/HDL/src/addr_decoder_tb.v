@@ -1,4 +1,5 @@
-// Simple testbench for addr_decoder: exercises masking, priority, and gating.
+// Simple testbench for addr_decoder: exercises masking, ranges, priority, gating,
+// and posted writes.
 
 `timescale 1ns/1ps
 
@@ -25,10 +26,15 @@ module addr_decoder_tb;
     wire       data_oe_n;
     wire       data_dir;
     wire       ff_oe_n;
+    wire       post_le;
+    wire       post_oe_n;
+    wire [7:0] post_addr;
+    wire       addr_oe_n;
     reg  [4:0] dev_ready_n;
     reg        irq_int_active;
     reg  [2:0] irq_int_slot;
     reg        irq_vec_cycle;
+    integer    i;               // loop index for inline wait loops
 
     // Simple cfg write helper.
     task cfg_write;
@@ -174,6 +180,8 @@ module addr_decoder_tb;
         .cs_n(cs_n),
         .ready_n(ready_n), .io_r_w_(io_r_w_),
         .data_oe_n(data_oe_n), .data_dir(data_dir), .ff_oe_n(ff_oe_n),
+        .post_le(post_le), .post_oe_n(post_oe_n),
+        .post_addr(post_addr), .addr_oe_n(addr_oe_n),
         .dev_ready_n(dev_ready_n),
         .win_valid(win_valid), .win_index(win_index), .sel_slot(sel_slot)
     );
@@ -245,6 +253,144 @@ module addr_decoder_tb;
         join
         dev_ready_n[1] = 1'b1;
 
+        // Range window: reprogram window 2 as TYPE=1 with BASE=0x48, LIMIT=0x5B
+        // (unaligned, not expressible as a single BASE/MASK pair).
+        cfg_write(6'h02, 8'h48); cfg_write(6'h06, 8'h5B); cfg_write(6'h0A, {1'b1, 4'b0000, 3'd3});
+        run_io_cycle(8'h48, 1'b1, 5'b01000, 4); // lower bound inclusive => cs[3]
+        run_io_cycle(8'h51, 1'b0, 5'b01000, 4); // interior write => cs[3]
+        run_io_cycle(8'h5B, 1'b1, 5'b01000, 4); // upper bound inclusive => cs[3]
+        run_io_cycle(8'h47, 1'b1, 5'b10000, 4); // below range -> catch-all
+        run_io_cycle(8'h5C, 1'b1, 5'b10000, 4); // above range -> catch-all
+        run_io_cycle(8'h30, 1'b1, 5'b10000, 4); // old mask range no longer decoded
+
+        // Restore window 2 to BASE/MASK mode (TYPE=0).
+        cfg_write(6'h02, 8'h30); cfg_write(6'h06, 8'hF0); cfg_write(6'h0A, {5'b00000, 3'd3});
+        run_io_cycle(8'h3F, 1'b1, 5'b01000, 4); // slot_2 => cs[3]
+
+        // Posted write: window 1 (slot_1 => cs[2]) gets POSTED (SLOT bit 6) and
+        // its Tile is busy. The Host must see no wait state; the Dock drains the
+        // write to the Tile after /IORQ rises.
+        cfg_write(6'h09, {1'b0, 1'b1, 3'b000, 3'd2});
+        dev_ready_n[2] = 1'b0;
+        addr   = 8'h23;
+        r_w_   = 1'b0;
+        iorq_n = 1'b1;
+        @(posedge clk);
+        @(negedge clk);
+        iorq_n = 1'b0;
+        #1;
+        if (data_oe_n !== 1'b1) begin
+            $display("FAIL posted: transceivers enabled for posted write data_oe_n=%b", data_oe_n);
+            $fatal(1);
+        end
+        @(posedge clk);
+        #1;
+        if (ready_n !== 1'b1 || cs !== 5'b00000 || post_le !== 1'b1 || post_oe_n !== 1'b1) begin
+            $display("FAIL posted entry: ready_n=%b cs=%05b post_le=%b post_oe_n=%b",
+                     ready_n, cs, post_le, post_oe_n);
+            $fatal(1);
+        end
+        @(negedge clk);
+        iorq_n = 1'b1; // Host completes without waiting for the Tile
+        @(posedge clk);
+        #1;
+        if (cs !== 5'b00100 || post_oe_n !== 1'b0 || post_le !== 1'b0 || io_r_w_ !== 1'b0 ||
+            post_addr !== 8'h23 || addr_oe_n !== 1'b1) begin
+            $display("FAIL posted drain: cs=%05b post_oe_n=%b post_le=%b io_r_w_=%b post_addr=%02h addr_oe_n=%b",
+                     cs, post_oe_n, post_le, io_r_w_, post_addr, addr_oe_n);
+            $fatal(1);
+        end
+
+        // A following read to the same slot blocks until the drain completes.
+        r_w_ = 1'b1;
+        @(negedge clk);
+        iorq_n = 1'b0;
+        repeat (4) begin
+            @(posedge clk);
+            #1;
+            if (ready_n !== 1'b0 || cs !== 5'b00100 || post_oe_n !== 1'b0 || data_oe_n !== 1'b1) begin
+                $display("FAIL posted block: ready_n=%b cs=%05b post_oe_n=%b data_oe_n=%b",
+                         ready_n, cs, post_oe_n, data_oe_n);
+                $fatal(1);
+            end
+        end
+        dev_ready_n[2] = 1'b1; // Tile accepts the posted write
+        begin : post_wait
+            for (i = 0; i < 10; i = i + 1) begin
+                @(posedge clk);
+                #1;
+                if (ready_n === 1'b1)
+                    disable post_wait;
+            end
+            $display("FAIL posted: blocked read never completed");
+            $fatal(1);
+        end
+        if (cs !== 5'b00100 || post_oe_n !== 1'b1 || data_oe_n !== 1'b0 || io_r_w_ !== 1'b1) begin
+            $display("FAIL posted follow-up read: cs=%05b post_oe_n=%b data_oe_n=%b io_r_w_=%b",
+                     cs, post_oe_n, data_oe_n, io_r_w_);
+            $fatal(1);
+        end
+        @(negedge clk);
+        iorq_n = 1'b1;
+        @(posedge clk);
+        #1;
+        if (cs !== 5'b00000 || ready_n !== 1'b1) begin
+            $display("FAIL posted tail: cs=%05b ready_n=%b", cs, ready_n);
+            $fatal(1);
+        end
+
+        // The Host moves on to another window while a posted write drains: the
+        // Tile address bus keeps the posted address until the Tile takes it.
+        dev_ready_n[2] = 1'b0;
+        addr   = 8'h27;
+        r_w_   = 1'b0;
+        @(negedge clk);
+        iorq_n = 1'b0;
+        @(posedge clk);
+        #1;
+        if (post_le !== 1'b1 || post_addr !== 8'h27) begin
+            $display("FAIL posted addr capture: post_le=%b post_addr=%02h", post_le, post_addr);
+            $fatal(1);
+        end
+        @(negedge clk);
+        iorq_n = 1'b1;
+        addr   = 8'h3F; // window 2, slot_2 => cs[3]
+        r_w_   = 1'b1;
+        @(posedge clk);
+        @(negedge clk);
+        iorq_n = 1'b0;
+        repeat (3) begin
+            @(posedge clk);
+            #1;
+            if (cs !== 5'b00100 || ready_n !== 1'b0 || post_oe_n !== 1'b0 ||
+                addr_oe_n !== 1'b1 || post_addr !== 8'h27 || io_r_w_ !== 1'b0) begin
+                $display("FAIL posted addr drain: cs=%05b ready_n=%b post_oe_n=%b addr_oe_n=%b post_addr=%02h io_r_w_=%b",
+                         cs, ready_n, post_oe_n, addr_oe_n, post_addr, io_r_w_);
+                $fatal(1);
+            end
+        end
+        dev_ready_n[2] = 1'b1;
+        begin : post_addr_wait
+            for (i = 0; i < 10; i = i + 1) begin
+                @(posedge clk);
+                #1;
+                if (ready_n === 1'b1)
+                    disable post_addr_wait;
+            end
+            $display("FAIL posted addr: stalled read never completed");
+            $fatal(1);
+        end
+        if (cs !== 5'b01000 || post_oe_n !== 1'b1 || addr_oe_n !== 1'b0 || data_oe_n !== 1'b0) begin
+            $display("FAIL posted addr follow-up: cs=%05b post_oe_n=%b addr_oe_n=%b data_oe_n=%b",
+                     cs, post_oe_n, addr_oe_n, data_oe_n);
+            $fatal(1);
+        end
+        @(negedge clk);
+        iorq_n = 1'b1;
+        @(posedge clk);
+        #1;
+        cfg_write(6'h09, {5'b00000, 3'd2}); // back to non-posted
+
         $display("All addr_decoder tests passed.");
         $finish;
     end
@@ -0,0 +1,307 @@
+// bus_trace: passive I/O-cycle trace ring buffer for the Dock decoder.
+// - Watches the Host bus and the addr_decoder outcome; never drives the bus,
+//   so capture costs no bus cycles.
+// - One entry per /IORQ cycle, written into a 2^DEPTH_LOG2-entry block RAM
+//   when the cycle ends. Entry bytes (little-endian, ENTRY_BYTES = 6 + ADDR_BYTES):
+//     0-2  timestamp: free-running clk count sampled at cycle start
+//     3    wait: clk cycles the Host was held with ready_n low (saturates at 255)
+//     4    flags: [0] read, [1] unmapped (0xFF fill on reads), [2] Mode-2 vector,
+//                 [3] posted write, [4] trigger entry, [7:5] sel_slot
+//     5    win_index
+//     6..  address (ADDR_BYTES bytes)
+// - Trigger/freeze: with ARM set, the first cycle matching every enabled TRIG
+//   qualifier is marked as the trigger; POST_CNT further cycles are recorded
+//   and the buffer then freezes until CLEAR. With no qualifier enabled, the
+//   first cycle triggers. Without ARM the buffer free-runs while EN is set.
+// - Config bus (cfg_addr relative to the trace base):
+//     0x0 CTRL     W: [0] EN, [1] ARM, [2] CLEAR (self-clearing)
+//                  R: [0] EN, [1] ARM, [4] TRIGGERED, [5] FROZEN, [6] WRAPPED
+//     0x1 TRIG     [0] address match, [1] unmapped, [2] Mode-2 vector,
+//                  [3] wait >= WAIT_THR, [4] writes only, [5] reads only, [6] posted
+//     0x2 WAIT_THR
+//     0x3 POST_CNT entries recorded after the trigger entry
+//     0x4-0x7 TRIG_ADDR, 0x8-0xB TRIG_MASK (little-endian; match when
+//             (addr & MASK) == (TRIG_ADDR & MASK))
+//     0xC WR_PTR   (R) next entry to be written
+//     0xD RD_IDX   entry to drain; writing it also rewinds to byte 0
+//     0xE DATA     (R) next byte of entry RD_IDX; after the last byte
+//                  RD_IDX advances to the following entry
+//     0xF TRIG_IDX (R) entry index of the trigger
+// Walkthrough:
+//   1) Capture (clk): the first clk edge with /IORQ low latches timestamp,
+//      address, direction and the decoder's win_valid/win_index/sel_slot
+//      (which already include the Mode-2 override). Wait clocks and post_le
+//      are accumulated until /IORQ rises, then the entry is committed.
+//   2) Commit: while EN=1 and not frozen, the entry is written at WR_PTR and
+//      evaluated against the trigger qualifiers.
+//   3) Drain (MCU): clear EN (or wait for FROZEN), then read WR_PTR/WRAPPED
+//      and walk RD_IDX/DATA. The RAM read port runs on clk and follows RD_IDX
+//      through a two-flop sync, so allow a few clk cycles between a RD_IDX
+//      change and the next DATA read (bit-banged accesses always do).
+//   Trigger/threshold registers are quasi-static: program them with EN=0.
+module bus_trace #(
+    parameter integer ADDR_W      = 32,
+    parameter integer WIN_INDEX_W = 4,
+    parameter integer DEPTH_LOG2  = 8   // entries = 2^DEPTH_LOG2, <= 8
+)(
+    input  wire              clk,
+    input  wire              rst_n,   // synchronous active-low reset (clk domain)
+
+    // Observed Host bus and decoder outcome
+    input  wire [ADDR_W-1:0] addr,
+    input  wire              iorq_n,
+    input  wire              r_w_,
+    input  wire              ready_n,
+    input  wire              win_valid,
+    input  wire [WIN_INDEX_W-1:0] win_index,
+    input  wire [2:0]        sel_slot,
+    input  wire              vec_cycle, // Mode-2 vector fetch steered by irq_router
+    input  wire              post_le,   // posted-write capture strobe
+
+    // Config bus
+    input  wire              cfg_clk,
+    input  wire              cfg_wr_en,
+    input  wire              cfg_rd_en,
+    input  wire [3:0]        cfg_addr,
+    input  wire [7:0]        cfg_wdata,
+    output reg  [7:0]        cfg_rdata
+);
+
+    localparam integer ADDR_BYTES  = (ADDR_W + 7) / 8;
+    localparam integer ENTRY_BYTES = 6 + ADDR_BYTES;
+    localparam integer ENTRY_W     = ENTRY_BYTES * 8;
+    localparam integer DEPTH       = 1 << DEPTH_LOG2;
+
+    localparam [3:0] R_CTRL = 4'h0, R_TRIG = 4'h1, R_WAIT_THR = 4'h2, R_POST_CNT = 4'h3,
+                     R_WR_PTR = 4'hC, R_RD_IDX = 4'hD, R_DATA = 4'hE, R_TRIG_IDX = 4'hF;
+
+    // ------------------------------------------------------------------
+    // Config domain registers (cfg_clk)
+    // ------------------------------------------------------------------
+    reg        cfg_en;
+    reg        cfg_arm;
+    reg        clr_tgl;      // CLEAR request (toggle handshake)
+    reg  [6:0] trig_sel;     // TRIG qualifier enables
+    reg  [7:0] wait_thr;
+    reg  [7:0] post_cnt;
+    reg [31:0] trig_addr;
+    reg [31:0] trig_mask;
+    reg [DEPTH_LOG2-1:0] rd_idx;
+    reg  [3:0] rd_byte;      // byte of entry rd_idx returned by the next DATA read
+
+    // ------------------------------------------------------------------
+    // Trace RAM and core-domain state (clk)
+    // ------------------------------------------------------------------
+    reg [ENTRY_W-1:0]    trace_mem [0:DEPTH-1];
+    reg [ENTRY_W-1:0]    rd_word;
+    reg [DEPTH_LOG2-1:0] rd_idx_meta;
+    reg [DEPTH_LOG2-1:0] rd_idx_sync;
+
+    reg  [1:0] en_sync;
+    reg  [1:0] arm_sync;
+    reg  [2:0] clr_sync;
+    wire       clr_now = clr_sync[2] ^ clr_sync[1];
+
+    reg [23:0] ts;           // free-running timestamp
+
+    // Cycle being captured
+    reg              in_cyc;
+    reg              commit;     // 1-clock: captured cycle has ended
+    reg [23:0]       e_ts;
+    reg [ADDR_W-1:0] e_addr;
+    reg              e_read;
+    reg              e_unmapped;
+    reg              e_vec;
+    reg              e_posted;
+    reg [2:0]        e_slot;
+    reg [WIN_INDEX_W-1:0] e_win;
+    reg [7:0]        e_wait;
+
+    reg [DEPTH_LOG2-1:0] wr_ptr;
+    reg [DEPTH_LOG2-1:0] trig_idx;
+    reg                  wrapped;
+    reg                  triggered;
+    reg                  frozen;
+    reg [7:0]            post_left;
+    wire                 rec = en_sync[1] && !frozen; // recording enabled
+
+    // Trigger qualifiers for the committed cycle (AND of enabled terms)
+    wire [31:0] e_addr32 = e_addr;
+    wire t_addr   = ((e_addr32 & trig_mask) == (trig_addr & trig_mask));
+    wire trig_hit = (!trig_sel[0] || t_addr) &&
+                    (!trig_sel[1] || e_unmapped) &&
+                    (!trig_sel[2] || e_vec) &&
+                    (!trig_sel[3] || (e_wait >= wait_thr)) &&
+                    (!trig_sel[4] || !e_read) &&
+                    (!trig_sel[5] ||  e_read) &&
+                    (!trig_sel[6] || e_posted);
+    wire trig_now = arm_sync[1] && !triggered && trig_hit;
+
+    wire [7:0] e_flags = {e_slot, trig_now, e_posted, e_vec, e_unmapped, e_read};
+    wire [7:0] e_win8  = e_win;
+    wire [ADDR_BYTES*8-1:0] e_addr_pad = e_addr;
+    wire [ENTRY_W-1:0] e_word = {e_addr_pad, e_win8, e_flags, e_wait, e_ts};
+
+    always @(posedge clk) begin
+        if (!rst_n) begin
+            en_sync    <= 2'b00;
+            arm_sync   <= 2'b00;
+            clr_sync   <= 3'b000;
+            ts         <= 24'd0;
+            in_cyc     <= 1'b0;
+            commit     <= 1'b0;
+            e_ts       <= 24'd0;
+            e_addr     <= {ADDR_W{1'b0}};
+            e_read     <= 1'b0;
+            e_unmapped <= 1'b0;
+            e_vec      <= 1'b0;
+            e_posted   <= 1'b0;
+            e_slot     <= 3'd0;
+            e_win      <= {WIN_INDEX_W{1'b0}};
+            e_wait     <= 8'h00;
+        end else begin
+            en_sync  <= {en_sync[0], cfg_en};
+            arm_sync <= {arm_sync[0], cfg_arm};
+            clr_sync <= {clr_sync[1:0], clr_tgl};
+            ts       <= ts + 24'd1;
+            commit   <= 1'b0;
+
+            if (!in_cyc) begin
+                if (!iorq_n) begin
+                    in_cyc     <= 1'b1;
+                    e_ts       <= ts;
+                    e_addr     <= addr;
+                    e_read     <= r_w_;
+                    e_unmapped <= !win_valid;
+                    e_vec      <= vec_cycle;
+                    e_posted   <= post_le;
+                    e_slot     <= sel_slot;
+                    e_win      <= win_index;
+                    e_wait     <= 8'h00;
+                end
+            end else begin
+                if (post_le)
+                    e_posted <= 1'b1;
+                if (!ready_n && e_wait != 8'hFF)
+                    e_wait <= e_wait + 8'd1;
+                if (iorq_n) begin
+                    in_cyc <= 1'b0;
+                    commit <= 1'b1;
+                end
+            end
+        end
+    end
+
+    always @(posedge clk) begin
+        if (!rst_n || clr_now) begin
+            wr_ptr    <= {DEPTH_LOG2{1'b0}};
+            trig_idx  <= {DEPTH_LOG2{1'b0}};
+            wrapped   <= 1'b0;
+            triggered <= 1'b0;
+            frozen    <= 1'b0;
+            post_left <= 8'h00;
+        end else if (commit && rec) begin
+            wr_ptr <= wr_ptr + 1'b1;
+            if (&wr_ptr)
+                wrapped <= 1'b1;
+
+            if (trig_now) begin
+                triggered <= 1'b1;
+                trig_idx  <= wr_ptr;
+                post_left <= post_cnt;
+                if (post_cnt == 8'h00)
+                    frozen <= 1'b1;
+            end else if (triggered) begin
+                post_left <= post_left - 8'd1;
+                if (post_left <= 8'd1)
+                    frozen <= 1'b1;
+            end
+        end
+    end
+
+    // Block RAM: write port on commit, read port follows RD_IDX
+    always @(posedge clk) begin
+        if (commit && rec)
+            trace_mem[wr_ptr] <= e_word;
+        rd_idx_meta <= rd_idx;
+        rd_idx_sync <= rd_idx_meta;
+        rd_word     <= trace_mem[rd_idx_sync];
+    end
+
+    // ------------------------------------------------------------------
+    // Config domain: control registers and drain port
+    // ------------------------------------------------------------------
+    always @(posedge cfg_clk or negedge rst_n) begin
+        if (!rst_n) begin
+            cfg_rdata <= 8'h00;
+            cfg_en    <= 1'b0;
+            cfg_arm   <= 1'b0;
+            clr_tgl   <= 1'b0;
+            trig_sel  <= 7'd0;
+            wait_thr  <= 8'h00;
+            post_cnt  <= 8'h00;
+            trig_addr <= 32'd0;
+            trig_mask <= 32'd0;
+            rd_idx    <= {DEPTH_LOG2{1'b0}};
+            rd_byte   <= 4'd0;
+        end else begin
+            if (cfg_rd_en) begin
+                case (cfg_addr)
+                    R_CTRL:     cfg_rdata <= {1'b0, wrapped, frozen, triggered, 2'b00, cfg_arm, cfg_en};
+                    R_TRIG:     cfg_rdata <= {1'b0, trig_sel};
+                    R_WAIT_THR: cfg_rdata <= wait_thr;
+                    R_POST_CNT: cfg_rdata <= post_cnt;
+                    4'h4:       cfg_rdata <= trig_addr[7:0];
+                    4'h5:       cfg_rdata <= trig_addr[15:8];
+                    4'h6:       cfg_rdata <= trig_addr[23:16];
+                    4'h7:       cfg_rdata <= trig_addr[31:24];
+                    4'h8:       cfg_rdata <= trig_mask[7:0];
+                    4'h9:       cfg_rdata <= trig_mask[15:8];
+                    4'hA:       cfg_rdata <= trig_mask[23:16];
+                    4'hB:       cfg_rdata <= trig_mask[31:24];
+                    R_WR_PTR:   cfg_rdata <= wr_ptr;
+                    R_RD_IDX:   cfg_rdata <= rd_idx;
+                    R_DATA: begin
+                        cfg_rdata <= rd_word[rd_byte*8 +: 8];
+                        if (rd_byte == ENTRY_BYTES - 1) begin
+                            rd_byte <= 4'd0;
+                            rd_idx  <= rd_idx + 1'b1;
+                        end else begin
+                            rd_byte <= rd_byte + 4'd1;
+                        end
+                    end
+                    R_TRIG_IDX: cfg_rdata <= trig_idx;
+                    default:    cfg_rdata <= 8'h00;
+                endcase
+            end
+
+            if (cfg_wr_en) begin
+                case (cfg_addr)
+                    R_CTRL: begin
+                        cfg_en  <= cfg_wdata[0];
+                        cfg_arm <= cfg_wdata[1];
+                        if (cfg_wdata[2])
+                            clr_tgl <= ~clr_tgl;
+                    end
+                    R_TRIG:     trig_sel <= cfg_wdata[6:0];
+                    R_WAIT_THR: wait_thr <= cfg_wdata;
+                    R_POST_CNT: post_cnt <= cfg_wdata;
+                    4'h4:       trig_addr[7:0]   <= cfg_wdata;
+                    4'h5:       trig_addr[15:8]  <= cfg_wdata;
+                    4'h6:       trig_addr[23:16] <= cfg_wdata;
+                    4'h7:       trig_addr[31:24] <= cfg_wdata;
+                    4'h8:       trig_mask[7:0]   <= cfg_wdata;
+                    4'h9:       trig_mask[15:8]  <= cfg_wdata;
+                    4'hA:       trig_mask[23:16] <= cfg_wdata;
+                    4'hB:       trig_mask[31:24] <= cfg_wdata;
+                    R_RD_IDX: begin
+                        rd_idx  <= cfg_wdata[DEPTH_LOG2-1:0];
+                        rd_byte <= 4'd0;
+                    end
+                    default: ;
+                endcase
+            end
+        end
+    end
+
+endmodule
@@ -0,0 +1,61 @@
+// dock_fifo: 8-bit synchronous FIFO in block RAM for the Dock services slot.
+// - 2^LOG2 entries; count/full/empty are exact, pushes to a full FIFO and pops
+//   from an empty one are ignored.
+// - rdata is the registered head (RAM read port follows rd_ptr). It is valid
+//   one clk after the push into an empty FIFO and one clk after a pop; empty
+//   is derived from a one-clk-delayed write pointer so it never deasserts
+//   before the head is readable.
+// - flush discards the contents (rd_ptr catches up with wr_ptr).
+module dock_fifo #(
+    parameter integer LOG2 = 9   // 512 x 8 = one iCE40 SB_RAM40_4K
+)(
+    input  wire          clk,
+    input  wire          rst_n,   // synchronous active-low reset
+    input  wire          flush,
+
+    input  wire          push,
+    input  wire [7:0]    wdata,
+    input  wire          pop,
+    output reg  [7:0]    rdata,
+
+    output wire          empty,
+    output wire          full,
+    output wire [LOG2:0] count
+);
+
+    reg [7:0]    mem [0:(1<<LOG2)-1];
+    reg [LOG2:0] wr_ptr;
+    reg [LOG2:0] wr_ptr_q; // reader-side view of wr_ptr
+    reg [LOG2:0] rd_ptr;
+
+    wire [LOG2:0] wr_count = wr_ptr - rd_ptr;
+
+    assign count = wr_ptr_q - rd_ptr;
+    assign empty = (count == {(LOG2+1){1'b0}});
+    assign full  = wr_count[LOG2];
+
+    always @(posedge clk) begin
+        if (push && !full)
+            mem[wr_ptr[LOG2-1:0]] <= wdata;
+        rdata <= mem[rd_ptr[LOG2-1:0]];
+    end
+
+    always @(posedge clk) begin
+        if (!rst_n) begin
+            wr_ptr   <= {(LOG2+1){1'b0}};
+            wr_ptr_q <= {(LOG2+1){1'b0}};
+            rd_ptr   <= {(LOG2+1){1'b0}};
+        end else begin
+            wr_ptr_q <= wr_ptr;
+            if (flush) begin
+                rd_ptr <= wr_ptr;
+            end else begin
+                if (push && !full)
+                    wr_ptr <= wr_ptr + 1'b1;
+                if (pop && !empty)
+                    rd_ptr <= rd_ptr + 1'b1;
+            end
+        end
+    end
+
+endmodule
@@ -0,0 +1,324 @@
+// dock_services: Dock-internal services pseudo-slot with an MCU mailbox.
+// - Behaves like a Tile on one decoder slot (SVC_SLOT in top): addr_decoder
+//   drives its cs, it answers with the same per-slot ready handshake, and its
+//   interrupt feeds INT_CH0 of that slot in irq_router.
+// - Two 8-bit FIFOs in block RAM carry bytes between the Host and the Dock
+//   MCU: H2M (Host writes, MCU drains over SPI) and M2H (MCU fills over SPI,
+//   Host reads).
+// - Host registers (A[3:0] on the services slot):
+//     0x0 DATA     R: pop M2H (0x00 and RX_UNF when empty)  W: push H2M (TX_OVF when full)
+//     0x1 STATUS   R: [0] RX_AVAIL (M2H not empty), [1] TX_FULL (H2M full),
+//                     [2] TX_EMPTY (H2M drained), [3] TX_OVF, [4] RX_UNF, [7] MCU_READY
+//     0x2 IRQ_EN   R/W: [0] interrupt while RX_AVAIL, [1] interrupt while TX_EMPTY
+//     0x3 RX_COUNT R: bytes in M2H (saturates at 255)
+//     0x4 TX_FREE  R: free bytes in H2M (saturates at 255)
+//     0x5 CTRL     W: [0] clear TX_OVF/RX_UNF, [1] flush H2M, [2] flush M2H
+//     0x6 VECTOR   R/W: byte returned for a Mode-2 vector fetch on this slot
+//     others read 0x00.
+// - MCU side: SPI slave, mode 0, MSB first, oversampled on clk (SCK <= clk/4).
+//   Each transaction is /CS low, a command byte, then data:
+//     0x01 STATUS  returns {MCU_READY,3'b0,TX_OVF,M2H_FULL,M2H_EMPTY,H2M_EMPTY},
+//                  H2M count lo/hi, M2H free lo/hi (counts latched at the command)
+//     0x02 READ    next byte is a length n, then n bytes popped from H2M
+//     0x03 WRITE   every following byte is pushed to M2H (dropped when full)
+//     0x04 CTRL    next byte: [0] MCU_READY, [1] flush H2M, [2] flush M2H
+//   mcu_irq is high while H2M holds data.
+// Walkthrough:
+//   1) Host access: on the first clk with cs high, a read latches its byte
+//      (DATA pops M2H) and a write is performed (DATA pushes H2M from din);
+//      ready then goes high until cs drops. dout is driven while cs and r_w_.
+//   2) SPI: SCK/CS/MOSI are synchronized into clk; rising edges shift MOSI in,
+//      falling edges shift MISO out, and each completed byte is decoded. The
+//      response byte is loaded on the falling edge that ends the byte before it.
+module dock_services #(
+    parameter integer FIFO_LOG2 = 9   // bytes per FIFO = 2^FIFO_LOG2
+)(
+    input  wire       clk,
+    input  wire       rst_n,      // synchronous active-low reset
+
+    // Tile-side view of the services slot
+    input  wire       cs,         // active-high chip select from addr_decoder
+    input  wire       r_w_,       // qualified R/W_ (1 = read)
+    input  wire [3:0] addr,       // local register address
+    input  wire       vec_cycle,  // Mode-2 vector fetch steered to this slot
+    input  wire [7:0] din,        // Tile-side data bus in
+    output wire [7:0] dout,       // Tile-side data bus out
+    output wire       doe,        // active-high output enable for dout
+    output wire       ready,      // dev_ready_n sense: 1 = access complete
+    output wire       host_irq,   // level interrupt request (INT_CH0)
+
+    // MCU SPI slave
+    input  wire       spi_sck,
+    input  wire       spi_cs_n,
+    input  wire       spi_mosi,
+    output wire       spi_miso,
+    output wire       mcu_irq     // H2M not empty
+);
+
+    localparam [3:0] R_DATA = 4'h0, R_STATUS = 4'h1, R_IRQ_EN = 4'h2, R_RX_COUNT = 4'h3,
+                     R_TX_FREE = 4'h4, R_CTRL = 4'h5, R_VECTOR = 4'h6;
+    localparam [7:0] C_STATUS = 8'h01, C_READ = 8'h02, C_WRITE = 8'h03, C_CTRL = 8'h04;
+    localparam integer FIFO_BYTES = 1 << FIFO_LOG2;
+
+    // ------------------------------------------------------------------
+    // FIFOs
+    // ------------------------------------------------------------------
+    wire               h2m_push, h2m_pop, h2m_empty, h2m_full;
+    wire [7:0]         h2m_head;
+    wire [FIFO_LOG2:0] h2m_count;
+    wire               m2h_push, m2h_pop, m2h_empty, m2h_full;
+    wire [7:0]         m2h_head;
+    wire [FIFO_LOG2:0] m2h_count;
+    reg                h2m_flush, m2h_flush;
+    reg  [7:0]         m2h_wdata;
+
+    dock_fifo #(.LOG2(FIFO_LOG2)) u_h2m (
+        .clk  (clk),
+        .rst_n(rst_n),
+        .flush(h2m_flush),
+        .push (h2m_push),
+        .wdata(din),
+        .pop  (h2m_pop),
+        .rdata(h2m_head),
+        .empty(h2m_empty),
+        .full (h2m_full),
+        .count(h2m_count)
+    );
+
+    dock_fifo #(.LOG2(FIFO_LOG2)) u_m2h (
+        .clk  (clk),
+        .rst_n(rst_n),
+        .flush(m2h_flush),
+        .push (m2h_push),
+        .wdata(m2h_wdata),
+        .pop  (m2h_pop),
+        .rdata(m2h_head),
+        .empty(m2h_empty),
+        .full (m2h_full),
+        .count(m2h_count)
+    );
+
+    wire [FIFO_LOG2:0] h2m_free = FIFO_BYTES - h2m_count;
+    wire [FIFO_LOG2:0] m2h_free = FIFO_BYTES - m2h_count;
+
+    // ------------------------------------------------------------------
+    // Host side
+    // ------------------------------------------------------------------
+    reg        acc_done;  // access performed for the current cs
+    reg  [7:0] rdata;
+    reg  [1:0] irq_en;
+    reg  [7:0] vector;
+    reg        tx_ovf;
+    reg        rx_unf;
+    reg        mcu_ready;
+
+    wire acc      = cs && !acc_done;
+    wire acc_data = acc && !vec_cycle && (addr == R_DATA);
+
+    assign h2m_push = acc_data && !r_w_;
+    assign m2h_pop  = acc_data &&  r_w_;
+    assign ready    = acc_done;
+    assign dout     = rdata;
+    assign doe      = cs && r_w_;
+    assign host_irq = (irq_en[0] && !m2h_empty) || (irq_en[1] && h2m_empty);
+
+    wire [7:0] host_status = {mcu_ready, 2'b00, rx_unf, tx_ovf, h2m_empty, h2m_full, !m2h_empty};
+    wire [7:0] rx_count8   = (m2h_count > 255) ? 8'hFF : m2h_count[7:0];
+    wire [7:0] tx_free8    = (h2m_free  > 255) ? 8'hFF : h2m_free[7:0];
+
+    // Host CTRL flushes (the SPI side may request them as well)
+    reg h2m_flush_host, m2h_flush_host;
+    reg h2m_flush_spi,  m2h_flush_spi;
+
+    always @* begin
+        h2m_flush = h2m_flush_host || h2m_flush_spi;
+        m2h_flush = m2h_flush_host || m2h_flush_spi;
+    end
+
+    always @(posedge clk) begin
+        if (!rst_n) begin
+            acc_done       <= 1'b0;
+            rdata          <= 8'h00;
+            irq_en         <= 2'b00;
+            vector         <= 8'h00;
+            tx_ovf         <= 1'b0;
+            rx_unf         <= 1'b0;
+            h2m_flush_host <= 1'b0;
+            m2h_flush_host <= 1'b0;
+        end else begin
+            h2m_flush_host <= 1'b0;
+            m2h_flush_host <= 1'b0;
+
+            if (!cs) begin
+                acc_done <= 1'b0;
+            end else if (!acc_done) begin
+                acc_done <= 1'b1;
+                if (r_w_) begin
+                    if (vec_cycle) begin
+                        rdata <= vector;
+                    end else begin
+                        case (addr)
+                            R_DATA: begin
+                                rdata <= m2h_empty ? 8'h00 : m2h_head;
+                                if (m2h_empty)
+                                    rx_unf <= 1'b1;
+                            end
+                            R_STATUS:   rdata <= host_status;
+                            R_IRQ_EN:   rdata <= {6'd0, irq_en};
+                            R_RX_COUNT: rdata <= rx_count8;
+                            R_TX_FREE:  rdata <= tx_free8;
+                            R_VECTOR:   rdata <= vector;
+                            default:    rdata <= 8'h00;
+                        endcase
+                    end
+                end else begin
+                    case (addr)
+                        R_DATA:   if (h2m_full) tx_ovf <= 1'b1;
+                        R_IRQ_EN: irq_en <= din[1:0];
+                        R_CTRL: begin
+                            if (din[0]) begin
+                                tx_ovf <= 1'b0;
+                                rx_unf <= 1'b0;
+                            end
+                            h2m_flush_host <= din[1];
+                            m2h_flush_host <= din[2];
+                        end
+                        R_VECTOR: vector <= din;
+                        default: ;
+                    endcase
+                end
+            end
+        end
+    end
+
+    // ------------------------------------------------------------------
+    // MCU SPI slave (clk-oversampled, mode 0)
+    // ------------------------------------------------------------------
+    reg  [2:0] sck_sync;
+    reg  [1:0] cs_sync;
+    reg  [1:0] mosi_sync;
+    wire       sck_rise = sck_sync[1] && !sck_sync[2];
+    wire       sck_fall = !sck_sync[1] && sck_sync[2];
+    wire       spi_sel  = !cs_sync[1];
+
+    reg  [2:0] bit_cnt;
+    reg  [6:0] sh_in;
+    reg  [7:0] sh_out;
+    reg        load_pend;   // response byte waiting for the next falling edge
+    reg  [7:0] load_byte;
+    reg        first;       // next byte is the command
+    reg        len_phase;   // READ: next byte is the length
+    reg  [7:0] cmd;
+    reg  [7:0] rd_left;     // READ: bytes still to pop
+    reg  [2:0] stat_idx;
+    reg  [7:0] stat_snap [0:4];
+
+    wire       byte_done = spi_sel && sck_rise && (bit_cnt == 3'd7);
+    wire [7:0] rx_byte   = {sh_in, mosi_sync[1]};
+
+    assign spi_miso = sh_out[7];
+    assign mcu_irq  = !h2m_empty;
+
+    // Pop H2M when a READ byte is loaded for shifting out
+    wire spi_rd_load = byte_done && !first &&
+                       ((cmd == C_READ && len_phase && rx_byte != 8'h00) ||
+                        (cmd == C_READ && !len_phase && rd_left != 8'h00));
+    assign h2m_pop  = spi_rd_load && !h2m_empty;
+    assign m2h_push = byte_done && !first && (cmd == C_WRITE);
+
+    always @* begin
+        m2h_wdata = rx_byte;
+    end
+
+    always @(posedge clk) begin
+        if (!rst_n) begin
+            sck_sync      <= 3'b000;
+            cs_sync       <= 2'b11;
+            mosi_sync     <= 2'b00;
+            bit_cnt       <= 3'd0;
+            sh_in         <= 7'd0;
+            sh_out        <= 8'h00;
+            load_pend     <= 1'b0;
+            load_byte     <= 8'h00;
+            first         <= 1'b1;
+            len_phase     <= 1'b0;
+            cmd           <= 8'h00;
+            rd_left       <= 8'h00;
+            stat_idx      <= 3'd0;
+            mcu_ready     <= 1'b0;
+            h2m_flush_spi <= 1'b0;
+            m2h_flush_spi <= 1'b0;
+        end else begin
+            sck_sync      <= {sck_sync[1:0], spi_sck};
+            cs_sync       <= {cs_sync[0], spi_cs_n};
+            mosi_sync     <= {mosi_sync[0], spi_mosi};
+            h2m_flush_spi <= 1'b0;
+            m2h_flush_spi <= 1'b0;
+
+            if (!spi_sel) begin
+                bit_cnt   <= 3'd0;
+                first     <= 1'b1;
+                len_phase <= 1'b0;
+                load_pend <= 1'b0;
+                sh_out    <= 8'h00;
+            end else begin
+                if (sck_rise) begin
+                    sh_in   <= rx_byte[6:0];
+                    bit_cnt <= bit_cnt + 3'd1;
+                end
+                if (sck_fall) begin
+                    if (load_pend) begin
+                        sh_out    <= load_byte;
+                        load_pend <= 1'b0;
+                    end else begin
+                        sh_out <= {sh_out[6:0], 1'b0};
+                    end
+                end
+
+                if (byte_done) begin
+                    load_pend <= 1'b1;
+                    load_byte <= 8'h00;
+                    if (first) begin
+                        first    <= 1'b0;
+                        cmd      <= rx_byte;
+                        stat_idx <= 3'd1;
+                        if (rx_byte == C_STATUS) begin
+                            stat_snap[0] <= {mcu_ready, 3'b000, tx_ovf, m2h_full, m2h_empty, h2m_empty};
+                            stat_snap[1] <= h2m_count[7:0];
+                            stat_snap[2] <= h2m_count >> 8;
+                            stat_snap[3] <= m2h_free[7:0];
+                            stat_snap[4] <= m2h_free >> 8;
+                            load_byte    <= {mcu_ready, 3'b000, tx_ovf, m2h_full, m2h_empty, h2m_empty};
+                        end
+                        len_phase <= (rx_byte == C_READ);
+                    end else begin
+                        case (cmd)
+                            C_STATUS: begin
+                                if (stat_idx <= 3'd4)
+                                    load_byte <= stat_snap[stat_idx];
+                                stat_idx <= stat_idx + 3'd1;
+                            end
+                            C_READ: begin
+                                if (len_phase) begin
+                                    len_phase <= 1'b0;
+                                    rd_left   <= (rx_byte == 8'h00) ? 8'h00 : rx_byte - 8'd1;
+                                end else if (rd_left != 8'h00) begin
+                                    rd_left <= rd_left - 8'd1;
+                                end
+                                if (spi_rd_load && !h2m_empty)
+                                    load_byte <= h2m_head;
+                            end
+                            C_CTRL: begin
+                                mcu_ready     <= rx_byte[0];
+                                h2m_flush_spi <= rx_byte[1];
+                                m2h_flush_spi <= rx_byte[2];
+                            end
+                            default: ;
+                        endcase
+                    end
+                end
+            end
+        end
+    end
+
+endmodule
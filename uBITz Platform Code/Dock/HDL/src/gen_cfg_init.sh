@@ -0,0 +1,192 @@
+#!/usr/bin/env bash
+#
+# Bake a default decode/route map into the bitstream.
+#
+# Reads a map file and renders the 256-byte config-bus image that top /
+# addr_decoder power up with when CFG_INIT_EN=1 (see DECODER_CONFIGURATION.md,
+# section 8). The image starts from the power-on defaults (BASE/MASK/SLOT 0,
+# OP 0xFF, Bank regions and routes disabled) and each map line overwrites the
+# bytes the MCU would write for the same binding. Output is a yosys script
+# fragment that sets CFG_INIT_EN/CFG_INIT on the chosen top; the Fletcher-16
+# of the image (reported by the capability block at 0x1A/0x1B) is printed on
+# stderr. Bank regions (mem) exist on top only: pass its NUM_MEM_REGION as
+# --mem-regions.
+#
+# Map file (one binding per line, '#' starts a comment, numbers in C syntax):
+#   win <w> <base> <mask|limit> <slot|dock> [any|rd|wr] [range] [posted] [bridge]
+#   int <slot> <ch> <cpu_int> [coal=<byte>]
+#   nmi <slot> <cpu_nmi>
+#   mem <r> <base> <size_log2> ram|rom0|rom1|rom2      (top with --mem-regions)
+#
+# Usage:
+#   ./gen_cfg_init.sh --map default.map --out cfg_init.ys
+#                     [--top addr_decoder] [--addr-w 8] [--num-win 16]
+#                     [--num-slots 5] [--int-ch 2] [--irq-base 0xC0]
+#                     [--mem-regions 0]
+#
+# The layout options must match the parameters the bitstream is built with.
+# Normally driven by CMake when CFG_INIT_MAP is set.
+
+set -euo pipefail
+
+map=""
+out=""
+top="addr_decoder"
+addr_w=8
+num_win=16
+num_slots=5
+int_ch=2
+irq_base=0xC0
+mem_regions=0
+
+while [[ $# -gt 0 ]]; do
+  case "$1" in
+    --map)       map="$2"; shift 2 ;;
+    --out)       out="$2"; shift 2 ;;
+    --top)       top="$2"; shift 2 ;;
+    --addr-w)    addr_w="$2"; shift 2 ;;
+    --num-win)   num_win="$2"; shift 2 ;;
+    --num-slots) num_slots="$2"; shift 2 ;;
+    --int-ch)    int_ch="$2"; shift 2 ;;
+    --irq-base)  irq_base="$2"; shift 2 ;;
+    --mem-regions) mem_regions="$2"; shift 2 ;;
+    *) echo "Unknown argument: $1" >&2; exit 2 ;;
+  esac
+done
+
+if [[ -z "$map" || -z "$out" ]]; then
+  echo "Usage: $0 --map file.map --out cfg_init.ys [options]" >&2
+  exit 2
+fi
+
+awk -v top="$top" -v addr_w="$addr_w" -v num_win="$num_win" \
+    -v num_slots="$num_slots" -v int_ch="$int_ch" -v irq_base_s="$irq_base" \
+    -v num_mem="$mem_regions" \
+    -v out="$out" '
+function num(s,    v, i, c, d) {
+  s = tolower(s)
+  if (s !~ /^(0x[0-9a-f]+|[0-9]+)$/) die("bad number \"" s "\"")
+  if (substr(s, 1, 2) != "0x") return s + 0
+  v = 0
+  for (i = 3; i <= length(s); i++) {
+    c = substr(s, i, 1)
+    d = index("0123456789abcdef", c) - 1
+    v = v * 16 + d
+  }
+  return v
+}
+function die(msg) {
+  printf "%s:%d: %s\n", FILENAME, FNR, msg > "/dev/stderr"
+  failed = 1
+  exit 1
+}
+function put(a, v) {
+  if (a < 0 || a > 255) die("config address " a " out of range")
+  img[a] = v % 256
+}
+function put_addr(off, v,    b) {
+  for (b = 0; b < cfg_bytes; b++) {
+    put(off + b, v % 256)
+    v = int(v / 256)
+  }
+}
+BEGIN {
+  cfg_bytes = int((addr_w + 7) / 8)
+  mask_off  = num_win * cfg_bytes
+  slot_off  = mask_off + num_win * cfg_bytes
+  op_off    = slot_off + num_win
+  dec_end   = op_off + num_win
+  mem_off   = dec_end
+  mem_end   = mem_off + num_mem * (cfg_bytes + 1)
+  irq_base  = num(irq_base_s)
+  n_int     = num_slots * int_ch
+  nmi_off   = n_int
+  coal_off  = n_int + num_slots
+  coal_snap = coal_off + n_int
+  if (mem_end > irq_base) {
+    printf "decoder layout (%d bytes) overlaps IRQ base 0x%02X\n", mem_end, irq_base > "/dev/stderr"
+    failed = 1
+    exit 1
+  }
+  for (a = 0; a < 256; a++) img[a] = 0
+  for (w = 0; w < num_win; w++) img[op_off + w] = 255
+}
+{ sub(/#.*/, "") }
+NF == 0 { next }
+$1 == "win" {
+  if (NF < 5) die("win needs <w> <base> <mask|limit> <slot|dock>")
+  w = num($2)
+  if (w >= num_win) die("window " w " >= NUM_WIN " num_win)
+  if ($5 == "dock") slot = 32
+  else {
+    slot = num($5)
+    if (slot >= num_slots) die("slot " slot " >= NUM_SLOTS " num_slots)
+  }
+  op = 255
+  for (i = 6; i <= NF; i++) {
+    if      ($i == "any")    op = 255
+    else if ($i == "rd")     op = 1
+    else if ($i == "wr")     op = 0
+    else if ($i == "range")  slot += 128
+    else if ($i == "posted") slot += 64
+    else if ($i == "bridge") slot += 16
+    else die("unknown window flag \"" $i "\"")
+  }
+  put_addr(w * cfg_bytes, num($3))
+  put_addr(mask_off + w * cfg_bytes, num($4))
+  put(slot_off + w, slot)
+  put(op_off + w, op)
+  next
+}
+$1 == "int" {
+  if (NF < 4) die("int needs <slot> <ch> <cpu_int>")
+  s = num($2); c = num($3); d = num($4)
+  if (s >= num_slots || c >= int_ch) die("int source " s "/" c " out of range")
+  if (d > 15) die("cpu_int " d " > 15")
+  idx = s * int_ch + c
+  put(irq_base + idx, 128 + d)
+  for (i = 5; i <= NF; i++) {
+    if ($i ~ /^coal=/) put(irq_base + coal_off + idx, num(substr($i, 6)))
+    else die("unknown int flag \"" $i "\"")
+  }
+  next
+}
+$1 == "nmi" {
+  if (NF != 3) die("nmi needs <slot> <cpu_nmi>")
+  s = num($2); d = num($3)
+  if (s >= num_slots) die("nmi slot " s " out of range")
+  if (d > 15) die("cpu_nmi " d " > 15")
+  put(irq_base + nmi_off + s, 128 + d)
+  next
+}
+$1 == "mem" {
+  if (NF != 5) die("mem needs <r> <base> <size_log2> ram|rom0|rom1|rom2")
+  r = num($2); sz = num($4)
+  if (r >= num_mem) die("region " r " >= --mem-regions " num_mem)
+  if (sz > 31) die("size_log2 " sz " > 31")
+  if      ($5 == "ram")  sp = 0
+  else if ($5 == "rom0") sp = 1
+  else if ($5 == "rom1") sp = 2
+  else if ($5 == "rom2") sp = 3
+  else die("unknown memory space \"" $5 "\"")
+  put_addr(mem_off + r * cfg_bytes, num($3))
+  put(mem_off + num_mem * cfg_bytes + r, 128 + sp * 32 + sz)
+  next
+}
+{ die("unknown directive \"" $1 "\"") }
+END {
+  if (failed) exit 1
+  # Fletcher-16 exactly as top.v CAP_INIT_SUM
+  s1 = 0; s2 = 0
+  for (i = 0; i < mem_end + coal_snap; i++) {
+    a  = (i < mem_end) ? i : irq_base + i - mem_end
+    s1 = (s1 + img[a]) % 255
+    s2 = (s2 + s1) % 255
+  }
+  hex = ""
+  for (a = 255; a >= 0; a--) hex = hex sprintf("%02x", img[a])
+  printf "# generated by gen_cfg_init.sh, Fletcher-16 0x%02x%02x\n", s2, s1 > out
+  printf "chparam -set CFG_INIT_EN 1 -set CFG_INIT 2048'"'"'h%s %s\n", hex, top > out
+  printf "cfg_init: Fletcher-16 0x%02X%02X\n", s2, s1 > "/dev/stderr"
+}
+' "$map"
@@ -1,5 +1,6 @@
 // irq_router: Dock-side interrupt router with configurable slot→CPU mapping.
-// - Supports NUM_SLOTS tiles, each with 2 maskable INT channels and 1 NMI.
+// - Supports NUM_SLOTS tiles, each with NUM_TILE_INT_CH maskable INT channels
+//   (2 by default, up to 4 with 8 slots) and 1 NMI.
 // - Routes to up to 4 CPU INT pins and 2 CPU NMI pins (active-high internally).
 // - Tracks exactly one active interrupt at a time; additional requests are
 //   held in pending masks until the active request deasserts.
@@ -10,14 +11,42 @@
 //     * NMI routing entry at cfg_addr = NUM_SLOTS*NUM_TILE_INT_CH + slot
 //     * Write cfg_wdata[7:0] with {enable, idx[3:0]} (others reserved = 0)
 //     * Disabled entries (bit7=0) ignore the corresponding request.
+//     * Per-maskable-route coalescing byte at cfg_addr = COAL_OFF + slot*NUM_TILE_INT_CH + ch
+//       (COAL_OFF = NUM_SLOTS*NUM_TILE_INT_CH + NUM_SLOTS): {mode, ticks[6:0]},
+//       ticks = 0 disables coalescing for that route.
+//     * COAL_SNAP (= COAL_OFF + NUM_SLOTS*NUM_TILE_INT_CH): write a route index to
+//       snapshot-and-clear its counters; read back at COAL_SNAP+1 (delivered) and
+//       COAL_SNAP+2 (coalesced).
+//     * cfg_rd_en reads any of the above into cfg_rdata on the next cfg_clk edge.
+//     * Power-on/reset values are 0x00 (disabled), or with CFG_INIT_EN the bytes
+//       of CFG_INIT at the same indices (byte i at CFG_INIT[8i +: 8]), so a
+//       default route map can be baked into the bitstream.
+// - Host status window (clk domain, decoded elsewhere as a Dock register window),
+//   read combinationally on host_rdata so the Host read needs no wait states:
+//     * 0x0 CAUSE       R   {active, is_nmi, bridged, slot[2:0], ch[1:0]} of the active
+//                           source; bridged = the slot holds a downstream Dock
+//                           (bridge_slots), whose own CAUSE names the Tile
+//     * 0x1 NMI_PENDING R   pending_nmi, bit = slot
+//     * 0x4-0x7 INT_PENDING R  pending_int, bit = slot*NUM_TILE_INT_CH + ch (little-endian)
+//     * 0x8-0xB INT_MASK    R/W  Host mask, same bit order; 1 = route held off
+//     * others read 0x00. host_we writes host_wdata on one clk.
 // Walkthrough:
 //   1) Config domain (cfg_clk): stores per-slot/per-channel routing entries
 //      int_route_slot_ch[][] and nmi_route_slot[]; each byte = {enable, idx[3:0]}.
 //   2) Pending masks reflect currently asserted, routed lines (tile_int_req/tile_nmi_req).
-//      Unrouted sources are ignored. Pending updates are combinational.
+//      Unrouted and Host-masked sources are ignored. Pending updates are combinational.
 //   3) Active selection: when idle, NMIs are preferred over INTs; picks lowest
-//      slot/channel that is pending. Active is cleared when its line drops.
-//   4) Outputs:
+//      slot/channel that is pending. Active is cleared when its line drops or the
+//      Host masks its route.
+//   4) Coalescing (maskable routes only; NMIs are never delayed): a per-route
+//      down-counter in units of 2^COAL_TICK_W clk cycles gates the pending bit.
+//      mode=0 (min gap): loaded when the route becomes active, so the next
+//      activation is at least `ticks` later. mode=1 (hold-off): loaded on the
+//      first rising edge of the routed line, so the CPU only sees it after
+//      `ticks` have passed and further edges in that window are absorbed.
+//      Per-route 8-bit saturating counters record delivered activations and
+//      request edges absorbed while the timer ran.
+//   5) Outputs:
 //      - cpu_int/cpu_nmi: assert the routed CPU pin for the active source (if enabled and in range).
 //      - slot_ack: pulse to the owning slot when irq_ack is seen for a maskable INT.
 //      - irq_int_active/irq_int_slot: export active maskable INT (with routing enabled)
@@ -28,7 +57,10 @@ module irq_router #(
     parameter integer NUM_CPU_NMI      = 2,
     parameter integer NUM_TILE_INT_CH  = 2,
     parameter integer CFG_ADDR_WIDTH   = 8,
-	parameter integer SLOT_IDX_WIDTH  = (NUM_SLOTS <= 1) ? 1 : $clog2(NUM_SLOTS)
+	parameter integer SLOT_IDX_WIDTH  = (NUM_SLOTS <= 1) ? 1 : $clog2(NUM_SLOTS),
+    parameter integer COAL_TICK_W      = 8, // coalescing tick = 2^COAL_TICK_W clk cycles
+    parameter integer CFG_INIT_EN      = 0,
+    parameter [2047:0] CFG_INIT        = 2048'd0
 )(
     input  wire                         clk,
     input  wire                         rst_n,   // synchronous active-low reset
@@ -52,18 +84,35 @@ module irq_router #(
     output wire                        irq_int_active,
     output wire [SLOT_IDX_WIDTH-1:0]   irq_int_slot,
 
+    // Slots behind a BRIDGE decoder window (reported in CAUSE only)
+    input  wire [NUM_SLOTS-1:0]         bridge_slots,
+
     // Simple config bus for routing/enable control
     input  wire                         cfg_wr_en,
     input  wire                         cfg_rd_en,
     input  wire [CFG_ADDR_WIDTH-1:0]    cfg_addr,
-    input  wire [7:0]                   cfg_wdata
-//    output reg  [31:0]                  cfg_rdata
+    input  wire [7:0]                   cfg_wdata,
+    output reg  [7:0]                   cfg_rdata,
+
+    // Host status window (clk domain)
+    input  wire                         host_we,   // 1-clock write strobe
+    input  wire [3:0]                   host_addr,
+    input  wire [7:0]                   host_wdata,
+    output reg  [7:0]                   host_rdata
 );
 
     // Width needed to index NUM_SLOTS slots
     //localparam integer SLOT_IDX_WIDTH = (NUM_SLOTS <= 1) ? 1 : $clog2(NUM_SLOTS);
     localparam integer CH_IDX_WIDTH = (NUM_TILE_INT_CH <= 1) ? 1 : $clog2(NUM_TILE_INT_CH);
 
+    // Maskable sources and config layout past the route entries
+    localparam integer NUM_INT_SRC   = NUM_SLOTS*NUM_TILE_INT_CH;
+    localparam integer INT_IDX_WIDTH = (NUM_INT_SRC <= 1) ? 1 : $clog2(NUM_INT_SRC);
+    localparam integer COAL_OFF      = NUM_INT_SRC + NUM_SLOTS;   // coalescing bytes
+    localparam integer COAL_SNAP     = COAL_OFF + NUM_INT_SRC;    // counter snapshot select
+    localparam integer COAL_DELIV    = COAL_SNAP + 1;             // snapshot: delivered count
+    localparam integer COAL_HITS     = COAL_SNAP + 2;             // snapshot: coalesced count
+
     // ------------------------------------------------------------------
     // Routing tables
     // ------------------------------------------------------------------
@@ -71,6 +120,8 @@ module irq_router #(
     reg [4:0] int_route_slot_ch [0:NUM_SLOTS-1][0:NUM_TILE_INT_CH-1];
     // NMI routing: enable + CPU NMI index (bit4 = enable, [3:0] = idx)
     reg [4:0] nmi_route_slot [0:NUM_SLOTS-1];
+    // Maskable coalescing: bit7 = mode (0 = min gap, 1 = hold-off), [6:0] = ticks
+    reg [7:0] int_coal [0:NUM_INT_SRC-1];
 
     // ------------------------------------------------------------------
     // Active interrupt tracking
@@ -98,9 +149,34 @@ module irq_router #(
     reg [NUM_SLOTS*NUM_TILE_INT_CH-1:0] pending_int; // maskable pending (routed, level)
     reg [NUM_SLOTS-1:0]                 pending_nmi; // NMI pending (routed, level)
 
+    // Host mask for maskable routes (Host status window INT_MASK)
+    reg [NUM_INT_SRC-1:0]               host_mask;
+
+    // Coalescing state (per maskable route, clk domain)
+    wire [NUM_INT_SRC-1:0]   coal_gate;     // route held off by its timer this cycle
+    reg                      int_sel_new;   // a maskable source is newly selected this cycle
+    wire [NUM_INT_SRC*8-1:0] cnt_deliv_flat;
+    wire [NUM_INT_SRC*8-1:0] cnt_coal_flat;
+
     // ------------------------------------------------------------------
     // Helpers
     // ------------------------------------------------------------------
+    // Reset/power-on config byte at index i
+    function automatic [7:0] init_byte(input integer i);
+        begin
+            init_byte = CFG_INIT_EN ? CFG_INIT[8*i +: 8] : 8'h00;
+        end
+    endfunction
+
+    // Same byte packed as a route entry {enable, dest[3:0]}
+    function automatic [4:0] init_route(input integer i);
+        reg [7:0] b;
+        begin
+            b          = init_byte(i);
+            init_route = {b[7], b[3:0]};
+        end
+    endfunction
+
     // Flattened index helper for maskable pending bits
     function automatic integer int_idx(input integer slot, input integer ch);
         begin
@@ -131,6 +207,7 @@ module irq_router #(
         active_slot_next    = active_slot;
         active_ch_next      = active_ch;
         active_cpu_idx_next = active_cpu_idx;
+        int_sel_new         = 1'b0;
 
         // Pending = masked view of raw lines (no queuing)
         // - Only routed sources are considered
@@ -140,8 +217,10 @@ module irq_router #(
                 route_entry = int_route_slot_ch[s][c];
 
                 if (route_entry[4]) begin
-                    // Routed: follow current line level
-                    pending_int_next[int_idx(s,c)] = tile_int_req[int_idx(s,c)];
+                    // Routed: follow current line level unless coalescing holds it off
+                    pending_int_next[int_idx(s,c)] = tile_int_req[int_idx(s,c)] &
+                                                     ~coal_gate[int_idx(s,c)] &
+                                                     ~host_mask[int_idx(s,c)];
                 end else begin
                     // Unrouted: completely ignored
                     pending_int_next[int_idx(s,c)] = 1'b0;
@@ -155,14 +234,15 @@ module irq_router #(
             end
         end
 
-        // Clear active when the underlying request deasserts
+        // Clear active when the underlying request deasserts (or the Host masks it)
         if (active_valid) begin
             if (active_is_nmi) begin
                 if (!tile_nmi_req[active_slot]) begin
                     active_valid_next = 1'b0;
                 end
             end else begin
-                if (!tile_int_req[int_idx(active_slot, active_ch)]) begin
+                if (!tile_int_req[int_idx(active_slot, active_ch)] ||
+                    host_mask[int_idx(active_slot, active_ch)]) begin
                     active_valid_next = 1'b0;
                 end
             end
@@ -200,6 +280,7 @@ module irq_router #(
                             active_slot_next    = s[SLOT_IDX_WIDTH-1:0];
                             active_ch_next      = c[CH_IDX_WIDTH-1:0];
                             active_cpu_idx_next = route_entry;
+                            int_sel_new         = 1'b1;
                         end
                     end
                 end
@@ -207,6 +288,99 @@ module irq_router #(
         end
     end
 
+    // ------------------------------------------------------------------
+    // Interrupt coalescing
+    // ------------------------------------------------------------------
+    reg [COAL_TICK_W-1:0] coal_prescale;
+    wire                  coal_tick = &coal_prescale;
+
+    always @(posedge clk) begin
+        if (!rst_n)
+            coal_prescale <= {COAL_TICK_W{1'b0}};
+        else
+            coal_prescale <= coal_prescale + 1'b1;
+    end
+
+    // Counter snapshot request from the config domain (toggle handshake)
+    reg [INT_IDX_WIDTH-1:0] coal_snap_sel; // cfg_clk domain, stable before the toggle
+    reg                     coal_snap_tgl; // cfg_clk domain
+    reg [2:0]               coal_snap_sync;
+    reg [7:0]               snap_deliv;
+    reg [7:0]               snap_coal;
+    wire                    coal_snap_now = coal_snap_sync[2] ^ coal_snap_sync[1];
+
+    always @(posedge clk) begin
+        if (!rst_n) begin
+            coal_snap_sync <= 3'b000;
+            snap_deliv     <= 8'h00;
+            snap_coal      <= 8'h00;
+        end else begin
+            coal_snap_sync <= {coal_snap_sync[1:0], coal_snap_tgl};
+            if (coal_snap_now && coal_snap_sel < NUM_INT_SRC) begin
+                snap_deliv <= cnt_deliv_flat[coal_snap_sel*8 +: 8];
+                snap_coal  <= cnt_coal_flat[coal_snap_sel*8 +: 8];
+            end
+        end
+    end
+
+    genvar gi;
+    generate
+        for (gi = 0; gi < NUM_INT_SRC; gi = gi + 1) begin : g_coal
+            wire [4:0] route     = int_route_slot_ch[gi / NUM_TILE_INT_CH][gi % NUM_TILE_INT_CH];
+            wire       holdoff   = int_coal[gi][7];
+            wire [6:0] ticks     = int_coal[gi][6:0];
+            wire       req       = route[4] && tile_int_req[gi];
+
+            reg        req_q;
+            reg  [6:0] coal_cnt;
+            reg  [7:0] cnt_deliv;
+            reg  [7:0] cnt_coal;
+
+            wire rise      = req && !req_q;
+            wire running   = (coal_cnt != 7'd0);
+            wire act_new   = int_sel_new && !active_is_nmi_next &&
+                             (int_idx(active_slot_next, active_ch_next) == gi);
+            wire hold_load = (ticks != 7'd0) &&  holdoff && rise && !running;
+            wire gap_load  = (ticks != 7'd0) && !holdoff && act_new;
+            wire coal_load = hold_load || gap_load;
+            wire coal_hit  = rise && running;
+            wire snap_here = coal_snap_now && (coal_snap_sel == gi);
+
+            // Hold-off gates the line from the edge that starts the timer
+            assign coal_gate[gi] = running || hold_load;
+
+            always @(posedge clk) begin
+                if (!rst_n) begin
+                    req_q     <= 1'b0;
+                    coal_cnt  <= 7'd0;
+                    cnt_deliv <= 8'h00;
+                    cnt_coal  <= 8'h00;
+                end else begin
+                    req_q <= req;
+
+                    if (coal_load)
+                        coal_cnt <= ticks;
+                    else if (coal_tick && running)
+                        coal_cnt <= coal_cnt - 7'd1;
+
+                    // Snapshot clears the route's counters (keeping this cycle's event)
+                    if (snap_here) begin
+                        cnt_deliv <= {7'd0, act_new};
+                        cnt_coal  <= {7'd0, coal_hit};
+                    end else begin
+                        if (act_new && cnt_deliv != 8'hFF)
+                            cnt_deliv <= cnt_deliv + 8'd1;
+                        if (coal_hit && cnt_coal != 8'hFF)
+                            cnt_coal <= cnt_coal + 8'd1;
+                    end
+                end
+            end
+
+            assign cnt_deliv_flat[gi*8 +: 8] = cnt_deliv;
+            assign cnt_coal_flat[gi*8 +: 8]  = cnt_coal;
+        end
+    endgenerate
+
     // ------------------------------------------------------------------
     // Sequential state updates
     // ------------------------------------------------------------------
@@ -219,7 +393,6 @@ module irq_router #(
             active_slot    <= {SLOT_IDX_WIDTH{1'b0}};
             active_ch      <= {CH_IDX_WIDTH{1'b0}};
             active_cpu_idx <= 5'd0;
-            //cfg_rdata      <= 32'h0000_0000;
 
         end else begin
             pending_int    <= pending_int_next;
@@ -235,14 +408,41 @@ module irq_router #(
     // Config domain: route table access synchronized to cfg_clk
     always @(posedge cfg_clk or negedge rst_n) begin
         if (!rst_n) begin
-            //cfg_rdata <= 32'h0000_0000;
+            cfg_rdata     <= 8'h00;
+            coal_snap_sel <= {INT_IDX_WIDTH{1'b0}};
+            coal_snap_tgl <= 1'b0;
             for (s = 0; s < NUM_SLOTS; s = s + 1) begin
-                nmi_route_slot[s] <= 5'd0;
-                for (c = 0; c < NUM_TILE_INT_CH; c = c + 1)
-                    int_route_slot_ch[s][c] <= 5'd0;
+                nmi_route_slot[s] <= init_route(NUM_INT_SRC + s);
+                for (c = 0; c < NUM_TILE_INT_CH; c = c + 1) begin
+                    int_route_slot_ch[s][c]  <= init_route(int_idx(s,c));
+                    int_coal[int_idx(s,c)]   <= init_byte(COAL_OFF + int_idx(s,c));
+                end
             end
         end else begin
-            //cfg_rdata <= 32'h0000_0000;
+            // Config reads
+            if (cfg_rd_en) begin
+                integer ridx;
+                ridx = cfg_addr;
+                if (ridx < NUM_INT_SRC) begin
+                    cfg_rdata <= {int_route_slot_ch[ridx / NUM_TILE_INT_CH][ridx % NUM_TILE_INT_CH][4],
+                                  3'b000,
+                                  int_route_slot_ch[ridx / NUM_TILE_INT_CH][ridx % NUM_TILE_INT_CH][3:0]};
+                end else if (ridx < COAL_OFF) begin
+                    cfg_rdata <= {nmi_route_slot[ridx - NUM_INT_SRC][4], 3'b000,
+                                  nmi_route_slot[ridx - NUM_INT_SRC][3:0]};
+                end else if (ridx < COAL_SNAP) begin
+                    cfg_rdata <= int_coal[ridx - COAL_OFF];
+                end else if (ridx == COAL_SNAP) begin
+                    cfg_rdata <= coal_snap_sel;
+                end else if (ridx == COAL_DELIV) begin
+                    cfg_rdata <= snap_deliv;
+                end else if (ridx == COAL_HITS) begin
+                    cfg_rdata <= snap_coal;
+                end else begin
+                    cfg_rdata <= 8'h00;
+                end
+            end
+
             // Config writes
             if (cfg_wr_en) begin
                 integer idx;
@@ -256,11 +456,68 @@ module irq_router #(
                 end else if (idx < (NUM_SLOTS*NUM_TILE_INT_CH + NUM_SLOTS)) begin
                     slot_sel = idx - (NUM_SLOTS*NUM_TILE_INT_CH);
                     nmi_route_slot[slot_sel] <= {cfg_wdata[7], cfg_wdata[3:0]};
+                end else if (idx < COAL_SNAP) begin
+                    int_coal[idx - COAL_OFF] <= cfg_wdata;
+                end else if (idx == COAL_SNAP) begin
+                    coal_snap_sel <= cfg_wdata[INT_IDX_WIDTH-1:0];
+                    coal_snap_tgl <= ~coal_snap_tgl;
                 end
             end
         end
     end
 
+    // ------------------------------------------------------------------
+    // Host status window
+    // ------------------------------------------------------------------
+    // Zero-extended views (NUM_SLOTS*NUM_TILE_INT_CH <= 32, NUM_SLOTS <= 8)
+    reg [31:0] host_pend32;
+    reg [31:0] host_mask32;
+    reg [7:0]  host_nmi8;
+    reg [7:0]  host_cause;
+    integer    m;
+
+    always @* begin
+        host_pend32 = 32'd0;
+        host_mask32 = 32'd0;
+        host_nmi8   = 8'd0;
+        host_cause  = 8'd0;
+        host_pend32[NUM_INT_SRC-1:0] = pending_int;
+        host_mask32[NUM_INT_SRC-1:0] = host_mask;
+        host_nmi8[NUM_SLOTS-1:0]     = pending_nmi;
+        if (active_valid) begin
+            host_cause[7]   = 1'b1;
+            host_cause[6]   = active_is_nmi;
+            host_cause[5]   = bridge_slots[active_slot];
+            host_cause[2 +: SLOT_IDX_WIDTH] = active_slot;
+            host_cause[0 +: CH_IDX_WIDTH]   = active_ch;
+        end
+
+        case (host_addr)
+            4'h0:    host_rdata = host_cause;
+            4'h1:    host_rdata = host_nmi8;
+            4'h4:    host_rdata = host_pend32[7:0];
+            4'h5:    host_rdata = host_pend32[15:8];
+            4'h6:    host_rdata = host_pend32[23:16];
+            4'h7:    host_rdata = host_pend32[31:24];
+            4'h8:    host_rdata = host_mask32[7:0];
+            4'h9:    host_rdata = host_mask32[15:8];
+            4'hA:    host_rdata = host_mask32[23:16];
+            4'hB:    host_rdata = host_mask32[31:24];
+            default: host_rdata = 8'h00;
+        endcase
+    end
+
+    always @(posedge clk) begin
+        if (!rst_n) begin
+            host_mask <= {NUM_INT_SRC{1'b0}};
+        end else if (host_we && host_addr[3:2] == 2'b10) begin
+            for (m = 0; m < NUM_INT_SRC; m = m + 1) begin
+                if (m / 8 == host_addr[1:0])
+                    host_mask[m] <= host_wdata[m % 8];
+            end
+        end
+    end
+
     // ------------------------------------------------------------------
     // Combinational outputs
     // ------------------------------------------------------------------
@@ -1,12 +1,15 @@
 `timescale 1ns/1ps
 
-// Directed tests for irq_router pending semantics and routing.
+// Directed tests for irq_router pending semantics, routing and coalescing.
 module irq_router_tb;
     localparam int NUM_SLOTS       = 3;
     localparam int NUM_CPU_INT     = 2;
     localparam int NUM_CPU_NMI     = 1;
     localparam int NUM_TILE_INT_CH = 2;
     localparam int SLOT_IDX_WIDTH  = (NUM_SLOTS <= 1) ? 1 : $clog2(NUM_SLOTS);
+    localparam int COAL_TICK_W     = 2; // 4-clock coalescing tick keeps the tests short
+    localparam int COAL_OFF        = NUM_SLOTS*NUM_TILE_INT_CH + NUM_SLOTS;
+    localparam int COAL_SNAP       = COAL_OFF + NUM_SLOTS*NUM_TILE_INT_CH;
 
     logic clk, rst_n;
     logic [NUM_SLOTS*NUM_TILE_INT_CH-1:0] tile_int_req;
@@ -18,6 +21,8 @@ module irq_router_tb;
     logic                                 irq_int_active;
     logic [SLOT_IDX_WIDTH-1:0]            irq_int_slot;
     logic                                 cfg_wr_en;
+    logic                                 cfg_rd_en;
+    logic [7:0]                           cfg_rdata;
     logic [7:0]                           cfg_addr;
     logic [7:0]                           cfg_wdata;
 
@@ -27,7 +32,8 @@ module irq_router_tb;
         .NUM_CPU_INT     (NUM_CPU_INT),
         .NUM_CPU_NMI     (NUM_CPU_NMI),
         .NUM_TILE_INT_CH (NUM_TILE_INT_CH),
-        .CFG_ADDR_WIDTH  (8)
+        .CFG_ADDR_WIDTH  (8),
+        .COAL_TICK_W     (COAL_TICK_W)
     ) dut (
         .clk        (clk),
         .rst_n      (rst_n),
@@ -40,10 +46,16 @@ module irq_router_tb;
         .slot_ack   (slot_ack),
         .irq_int_active(irq_int_active),
         .irq_int_slot(irq_int_slot),
+        .bridge_slots('0),
         .cfg_wr_en  (cfg_wr_en),
-        .cfg_rd_en  (1'b0),
+        .cfg_rd_en  (cfg_rd_en),
         .cfg_addr   (cfg_addr),
-        .cfg_wdata  (cfg_wdata)
+        .cfg_wdata  (cfg_wdata),
+        .cfg_rdata  (cfg_rdata),
+        .host_we    (1'b0),
+        .host_addr  (4'h0),
+        .host_wdata (8'h00),
+        .host_rdata ()
     );
 
     // Clock generation
@@ -56,6 +68,7 @@ module irq_router_tb;
     initial begin
         rst_n       = 0;
         cfg_wr_en   = 0;
+        cfg_rd_en   = 0;
         irq_ack     = 0;
         cfg_addr    = 0;
         cfg_wdata   = 0;
@@ -98,6 +111,28 @@ module irq_router_tb;
     end
     endtask
 
+    task automatic cfg_read(input byte addr, output byte data);
+    begin
+        @(posedge clk);
+        cfg_addr  <= addr;
+        cfg_rd_en <= 1;
+        @(posedge clk);
+        cfg_rd_en <= 0;
+        #1;
+        data = cfg_rdata;
+    end
+    endtask
+
+    // Snapshot-and-clear the coalescing counters of one maskable route
+    task automatic coal_snapshot(input int slot, input int ch, output byte deliv, output byte hits);
+    begin
+        cfg_write(COAL_SNAP, slot*NUM_TILE_INT_CH + ch);
+        repeat (5) @(posedge clk);
+        cfg_read(COAL_SNAP + 1, deliv);
+        cfg_read(COAL_SNAP + 2, hits);
+    end
+    endtask
+
     task automatic pulse_irq_ack;
     begin
         @(posedge clk);
@@ -249,6 +284,67 @@ module irq_router_tb;
         if (cpu_int !== 2'b00)
             $fatal(1, "Test9 fail: cpu_int not zero after clearing out-of-range route cpu_int=%b", cpu_int);
 
+        // Test 10: minimum-gap coalescing (mode 0, 3 ticks) on slot0 ch0
+        begin : t10
+            byte rd, deliv, hits;
+            route_int(0, 0, 1, 0);
+            cfg_write(COAL_OFF + int_idx(0,0), 8'h03);
+            cfg_read(COAL_OFF + int_idx(0,0), rd);
+            if (rd !== 8'h03)
+                $fatal(1, "Test10 fail: coalescing byte read back %h", rd);
+            cfg_read(int_idx(0,0), rd);
+            if (rd !== 8'h80)
+                $fatal(1, "Test10 fail: route entry read back %h", rd);
+            coal_snapshot(0, 0, deliv, hits); // clear counts from earlier tests
+
+            tile_int_req[int_idx(0,0)] <= 1'b1;
+            repeat (2) @(posedge clk);
+            if (cpu_int !== 2'b01)
+                $fatal(1, "Test10 fail: first INT not delivered cpu_int=%b", cpu_int);
+            tile_int_req[int_idx(0,0)] <= 1'b0;
+            repeat (2) @(posedge clk);
+            tile_int_req[int_idx(0,0)] <= 1'b1; // re-request inside the gap
+            repeat (2) @(posedge clk);
+            if (cpu_int !== 2'b00)
+                $fatal(1, "Test10 fail: INT delivered inside min gap cpu_int=%b", cpu_int);
+            repeat (16) @(posedge clk);
+            if (cpu_int !== 2'b01)
+                $fatal(1, "Test10 fail: INT not delivered after gap cpu_int=%b", cpu_int);
+            tile_int_req[int_idx(0,0)] <= 1'b0;
+            repeat (2) @(posedge clk);
+
+            coal_snapshot(0, 0, deliv, hits);
+            if (deliv !== 8'd2 || hits !== 8'd1)
+                $fatal(1, "Test10 fail: counters delivered=%0d coalesced=%0d", deliv, hits);
+            cfg_write(COAL_OFF + int_idx(0,0), 8'h00);
+        end
+
+        // Test 11: hold-off coalescing (mode 1, 2 ticks) on slot1 ch0
+        begin : t11
+            byte deliv, hits;
+            route_int(1, 0, 1, 1);
+            cfg_write(COAL_OFF + int_idx(1,0), 8'h82);
+            coal_snapshot(1, 0, deliv, hits);
+
+            tile_int_req[int_idx(1,0)] <= 1'b1;
+            repeat (2) @(posedge clk);
+            if (cpu_int !== 2'b00)
+                $fatal(1, "Test11 fail: INT not held off cpu_int=%b", cpu_int);
+            tile_int_req[int_idx(1,0)] <= 1'b0; // second event inside the hold-off
+            @(posedge clk);
+            tile_int_req[int_idx(1,0)] <= 1'b1;
+            repeat (12) @(posedge clk);
+            if (cpu_int !== 2'b10)
+                $fatal(1, "Test11 fail: INT not delivered after hold-off cpu_int=%b", cpu_int);
+            tile_int_req[int_idx(1,0)] <= 1'b0;
+            repeat (2) @(posedge clk);
+
+            coal_snapshot(1, 0, deliv, hits);
+            if (deliv !== 8'd1 || hits !== 8'd1)
+                $fatal(1, "Test11 fail: counters delivered=%0d coalesced=%0d", deliv, hits);
+            cfg_write(COAL_OFF + int_idx(1,0), 8'h00);
+        end
+
         $display("All irq_router tests passed.");
         $finish;
     end
@@ -0,0 +1,140 @@
+// Submodule: mem_decoder
+// Purpose: Bank memory-space decode. Drives the Bank /CS and the /MEM0_CS,
+// /MEM1_CS space select for /MREQ cycles (Dock spec 0.10).
+// Walkthrough:
+//   - NUM_REGION entries, each a BASE and an ATTR byte:
+//       * BASE bytes : CFG_OFF + r*CFG_BYTES + byte
+//       * ATTR       : CFG_OFF + NUM_REGION*CFG_BYTES + r
+//                      bit 7 EN, bits 6:5 SPACE (0 RAM, 1 ROM0, 2 ROM1, 3 ROM2),
+//                      bits 4:0 SIZE (region of 2^SIZE bytes, BASE aligned to
+//                      it). SIZE tops out at 31: SIZE = ADDR_W covers the
+//                      whole space for ADDR_W <= 31, at ADDR_W = 32 that
+//                      takes two 2^31 regions.
+//   - A region hits when it is enabled and addr equals BASE on every bit at or
+//     above SIZE. The lowest-index hit wins, so ROM regions listed first
+//     overlay a larger RAM region behind them.
+//   - The address path is combinational from addr/mreq_n/iorq_n to the pins,
+//     with no clk, FSM or /READY involvement: Bank cycles never wait on the
+//     Dock. Per-region compare masks and pin levels come from the config
+//     registers only and stay off the address path.
+//   - bank_cs_n falls only for /MREQ=0, /IORQ=1 cycles that hit a region.
+//     mem0_cs_n/mem1_cs_n carry the space while it is low and idle high
+//     otherwise: RAM 0/1, ROM0 1/0, ROM1 0/0, ROM2 1/1 (MEM0/MEM1).
+//   - Timing: all three pins are gated by /MREQ, so they cannot glitch low
+//     outside a memory cycle. Inside one they stay glitch-free as long as the
+//     Host's address is stable at least one pin-to-pin delay (addr to
+//     mem*_cs_n) before /MREQ falls, as the bus spec requires; an address
+//     that changes under a held /MREQ may pass through another region's
+//     levels. Banks qualify the space pins with bank_cs_n.
+//   - cfg_we strobes in a single byte on cfg_clk; addresses outside the
+//     table are ignored, so it can share the decoder's write strobe.
+//   - Power-on: all regions disabled, or with CFG_INIT_EN the bytes of
+//     CFG_INIT at the same config addresses (gen_cfg_init.sh).
+module mem_decoder #(
+    parameter integer ADDR_W      = 32,
+    parameter integer NUM_REGION  = 4,
+    parameter integer CFG_OFF     = 160,
+    parameter integer CFG_INIT_EN = 0,
+    parameter [2047:0] CFG_INIT   = 2048'd0
+)(
+    input  logic              cfg_clk,
+    input  logic              cfg_we,
+    input  logic [7:0]        cfg_addr,
+    input  logic [7:0]        cfg_wdata,
+
+    input  logic [ADDR_W-1:0] addr,
+    input  logic              mreq_n,
+    input  logic              iorq_n,
+
+    output logic              bank_cs_n,
+    output logic              mem0_cs_n,
+    output logic              mem1_cs_n
+);
+
+    // Bytes per BASE entry; BASE registers are kept byte-wide.
+    localparam integer CFG_BYTES = (ADDR_W + 7) / 8;
+    localparam integer BASE_W    = CFG_BYTES * 8;
+    localparam integer ATTR_OFF  = CFG_OFF + NUM_REGION * CFG_BYTES;
+
+    // Power-on byte at config address a
+    function automatic [7:0] init_byte(input integer a);
+        init_byte = CFG_INIT_EN ? CFG_INIT[8*a +: 8] : 8'h00;
+    endfunction
+
+    function automatic [NUM_REGION*BASE_W-1:0] init_base_tbl(input integer dummy);
+        for (int r = 0; r < NUM_REGION; r++)
+            for (int b = 0; b < CFG_BYTES; b++)
+                init_base_tbl[r*BASE_W + 8*b +: 8] = init_byte(CFG_OFF + r*CFG_BYTES + b);
+    endfunction
+
+    function automatic [NUM_REGION*8-1:0] init_attr_tbl(input integer dummy);
+        for (int r = 0; r < NUM_REGION; r++)
+            init_attr_tbl[r*8 +: 8] = init_byte(ATTR_OFF + r);
+    endfunction
+
+    logic [NUM_REGION*BASE_W-1:0] base_flat;
+    logic [NUM_REGION*8-1:0]      attr_flat;
+
+    initial begin
+        base_flat = init_base_tbl(0);
+        attr_flat = init_attr_tbl(0);
+    end
+
+    // Byte-wise config writes
+    always_ff @(posedge cfg_clk) begin
+        if (cfg_we) begin
+            for (int r = 0; r < NUM_REGION; r++) begin
+                for (int b = 0; b < CFG_BYTES; b++) begin
+                    if (cfg_addr == (CFG_OFF + r*CFG_BYTES + b))
+                        base_flat[r*BASE_W + 8*b +: 8] <= cfg_wdata;
+                end
+                if (cfg_addr == (ATTR_OFF + r))
+                    attr_flat[r*8 +: 8] <= cfg_wdata;
+            end
+        end
+    end
+
+    // Per-region match and pin levels
+    logic [NUM_REGION-1:0] hit;
+    logic [1:0]            pins [0:NUM_REGION-1]; // {mem1_cs_n, mem0_cs_n}
+
+    genvar gr;
+    generate
+        for (gr = 0; gr < NUM_REGION; gr++) begin : gen_region
+            wire [ADDR_W-1:0] base  = base_flat[gr*BASE_W +: ADDR_W];
+            wire [7:0]        attr  = attr_flat[gr*8 +: 8];
+            wire [1:0]        space = attr[6:5];
+            logic [ADDR_W-1:0] cmp;                 // 1 = bit compared
+
+            always_comb begin
+                for (int i = 0; i < ADDR_W; i++)
+                    cmp[i] = (i >= attr[4:0]);
+            end
+
+            assign hit[gr]  = attr[7] && &(~cmp | ~(addr ^ base));
+            assign pins[gr] = {~(space[1] ^ space[0]), space[0]};
+        end
+    endgenerate
+
+    // Lowest-index region wins
+    logic       mem_hit;
+    logic [1:0] mem_pins;
+
+    always_comb begin
+        mem_hit  = 1'b0;
+        mem_pins = 2'b11;
+        for (int r = NUM_REGION - 1; r >= 0; r--) begin
+            if (hit[r]) begin
+                mem_hit  = 1'b1;
+                mem_pins = pins[r];
+            end
+        end
+    end
+
+    wire bank_sel = !mreq_n && iorq_n && mem_hit;
+
+    assign bank_cs_n = !bank_sel;
+    assign mem0_cs_n = bank_sel ? mem_pins[0] : 1'b1;
+    assign mem1_cs_n = bank_sel ? mem_pins[1] : 1'b1;
+
+endmodule
@@ -0,0 +1,67 @@
+#!/usr/bin/env bash
+#
+# Wrap an icepack bitstream into a Dock MCU bitstream-variant image.
+#
+# The Dock MCU keeps several specialized builds of top in flash data
+# partitions (subtype 0x40) and loads the tightest one into the iCE40 after
+# reading the CPU descriptor (DECODER_CONFIGURATION.md, section 9). Each
+# partition holds a 16-byte header followed by the raw bitstream:
+#
+#   0x00  "UBVB"
+#   0x04  header version (1)
+#   0x05  ADDR_W
+#   0x06  NUM_WIN
+#   0x07  NUM_SLOTS
+#   0x08  bitstream length, little-endian u32
+#   0x0C  reserved (0)
+#
+# Usage:
+#   ./pack_variant.sh --bin hardware.bin --out variant.img
+#                     --addr-w 8 --num-win 8 [--num-slots 5]
+#
+# Normally driven by the bitstream_variants CMake target.
+
+set -euo pipefail
+
+bin=""
+out=""
+addr_w=""
+num_win=""
+num_slots=5
+
+while [[ $# -gt 0 ]]; do
+  case "$1" in
+    --bin)       bin="$2"; shift 2 ;;
+    --out)       out="$2"; shift 2 ;;
+    --addr-w)    addr_w="$2"; shift 2 ;;
+    --num-win)   num_win="$2"; shift 2 ;;
+    --num-slots) num_slots="$2"; shift 2 ;;
+    *) echo "Unknown argument: $1" >&2; exit 2 ;;
+  esac
+done
+
+if [[ -z "$bin" || -z "$out" || -z "$addr_w" || -z "$num_win" ]]; then
+  echo "Usage: $0 --bin hardware.bin --out variant.img --addr-w N --num-win N [--num-slots N]" >&2
+  exit 2
+fi
+if [[ ! -f "$bin" ]]; then
+  echo "Bitstream not found: $bin" >&2
+  exit 1
+fi
+
+len=$(wc -c < "$bin")
+
+# One byte as a printf escape.
+byte() {
+  printf '\\x%02x' $(( $1 & 0xFF ))
+}
+
+{
+  printf 'UBVB'
+  printf "$(byte 1)$(byte "$addr_w")$(byte "$num_win")$(byte "$num_slots")"
+  printf "$(byte "$len")$(byte $(( len >> 8 )))$(byte $(( len >> 16 )))$(byte $(( len >> 24 )))"
+  printf '\x00\x00\x00\x00'
+  cat "$bin"
+} > "$out"
+
+echo "pack_variant: ${out} ADDR_W=${addr_w} NUM_WIN=${num_win} NUM_SLOTS=${num_slots} ${len} bytes" >&2
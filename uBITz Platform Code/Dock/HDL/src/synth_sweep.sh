@@ -0,0 +1,243 @@
+#!/usr/bin/env bash
+#
+# Parameter-sweep synthesis benchmark for addr_decoder and top.
+#
+# Every (top, ADDR_W:NUM_WIN point, NUM_SLOTS) is synthesized with yosys
+# (chparam on the chosen top), placed and routed with nextpnr-ice40 with
+# unconstrained IOs, and its LC/IO/BRAM use and achieved core-clock fmax are
+# appended to a CSV scaling table. IRQ_CFG_BASE and NUM_MEM_REGION are read
+# from the top.v among the sources. A point whose decoder config layout does
+# not fit below IRQ_CFG_BASE, or that needs more than 8 slots (3-bit
+# sel_slot), is recorded as fail_cfg / fail_slots and fails the run: the
+# matrix lists only buildable points.
+#
+# With --baseline, each point is compared against the stored CSV and the
+# script exits non-zero if any point that was "ok" in the baseline now fails,
+# grows its LC count by more than --lc-tol percent, uses more IO/BRAM, or
+# loses more than --fmax-tol percent of fmax. A missing baseline file, or a
+# swept point the baseline does not cover, is an error too: the gate never
+# passes without numbers to compare. --update-baseline copies the new table
+# over the baseline instead of comparing (the only way to create one).
+#
+# Usage:
+#   ./synth_sweep.sh --out sweep.csv [--baseline synth_baseline.csv]
+#                    [--update-baseline] [--work DIR]
+#                    [--device hx8k] [--package ct256]
+#                    [--tops "addr_decoder top"]
+#                    [--points "8:4 8:32 16:16 32:16"] [--num-slots "5 8"]
+#                    [--lc-tol 5] [--fmax-tol 5]
+#                    -- src1.v src2.v ...
+#
+# Normally driven by the synth_sweep / synth_sweep_baseline CMake targets.
+
+set -euo pipefail
+
+out=""
+baseline=""
+update_baseline=0
+work=""
+device="hx8k"
+package="ct256"
+tops="addr_decoder top"
+points="8:4 8:8 8:16 8:32 16:4 16:8 16:16 32:4 32:8 32:16"
+num_slots_list="5 8"
+lc_tol=5
+fmax_tol=5
+srcs=()
+
+while [[ $# -gt 0 ]]; do
+  case "$1" in
+    --out)             out="$2"; shift 2 ;;
+    --baseline)        baseline="$2"; shift 2 ;;
+    --update-baseline) update_baseline=1; shift ;;
+    --work)            work="$2"; shift 2 ;;
+    --device)          device="$2"; shift 2 ;;
+    --package)         package="$2"; shift 2 ;;
+    --tops)            tops="$2"; shift 2 ;;
+    --points)          points="$2"; shift 2 ;;
+    --num-slots)       num_slots_list="$2"; shift 2 ;;
+    --lc-tol)          lc_tol="$2"; shift 2 ;;
+    --fmax-tol)        fmax_tol="$2"; shift 2 ;;
+    --)                shift; srcs=("$@"); break ;;
+    *) echo "Unknown argument: $1" >&2; exit 2 ;;
+  esac
+done
+
+if [[ -z "$out" || ${#srcs[@]} -eq 0 ]]; then
+  echo "Usage: $0 --out sweep.csv [options] -- src.v ..." >&2
+  exit 2
+fi
+
+for tool in yosys nextpnr-ice40 jq; do
+  if ! command -v "$tool" >/dev/null 2>&1; then
+    echo "$tool not found in PATH" >&2
+    exit 1
+  fi
+done
+
+# Config-bus layout limits, from top.v's parameter defaults
+top_v=""
+for src in "${srcs[@]}"; do
+  [[ "$(basename "$src")" == "top.v" ]] && top_v="$src"
+done
+if [[ -z "$top_v" ]]; then
+  echo "top.v not among the sources" >&2
+  exit 2
+fi
+top_param() {
+  sed -nE "s/^[[:space:]]*parameter[^=]*[[:space:]]$1[[:space:]]*=[[:space:]]*([0-9]+'h)?([0-9A-Fa-f]+).*/\1\2/p" \
+    "$top_v" | head -n 1
+}
+irq_cfg_base="$(top_param IRQ_CFG_BASE)"
+num_mem_region="$(top_param NUM_MEM_REGION)"
+if [[ -z "$irq_cfg_base" || -z "$num_mem_region" ]]; then
+  echo "IRQ_CFG_BASE / NUM_MEM_REGION not found in $top_v" >&2
+  exit 2
+fi
+[[ "$irq_cfg_base" == *"'h"* ]] && irq_cfg_base=$(( 16#${irq_cfg_base#*\'h} ))
+
+work="${work:-$(dirname "$out")/sweep}"
+mkdir -p "$work"
+
+# Decoder config bytes: BASE + MASK (CFG_BYTES each) + SLOT + OP per window.
+# top adds its NUM_MEM_REGION Bank regions after the decoder tables.
+cfg_layout_bytes() {
+  local top="$1" addr_w="$2" num_win="$3"
+  local cfg_bytes=$(( (addr_w + 7) / 8 ))
+  local mem=0
+  [[ "$top" == "top" ]] && mem=$(( num_mem_region * (cfg_bytes + 1) ))
+  echo $(( 2 * num_win * cfg_bytes + 2 * num_win + mem ))
+}
+
+# Pull "lc_used,lc_avail,io_used,bram_used,fmax_mhz" out of a nextpnr report.
+# fmax is the core clock ("clk"); falls back to the slowest reported clock.
+report_fields() {
+  jq -r '
+    (.fmax // {}) as $f
+    | [$f | to_entries[] | select(.key | test("^clk([$]|$)")) | .value.achieved] as $core
+    | (if ($core | length) > 0 then ($core | min) else ([$f[] | .achieved] | min) end) as $fmax
+    | [ .utilization["ICESTORM_LC"].used,
+        .utilization["ICESTORM_LC"].available,
+        .utilization["SB_IO"].used,
+        .utilization["ICESTORM_RAM"].used,
+        ((($fmax // 0) * 100 | round) / 100) ]
+    | @csv' "$1"
+}
+
+echo "top,addr_w,num_win,num_slots,status,lc_used,lc_avail,io_used,bram_used,fmax_mhz" > "$out"
+
+unbuildable=0
+for top in $tops; do
+  for point in $points; do
+    addr_w="${point%%:*}"
+    num_win="${point##*:}"
+    for num_slots in $num_slots_list; do
+      key="${top},${addr_w},${num_win},${num_slots}"
+      tag="${top}_a${addr_w}_w${num_win}_s${num_slots}"
+
+      if (( $(cfg_layout_bytes "$top" "$addr_w" "$num_win") > irq_cfg_base )); then
+        echo "${key},fail_cfg,,,,," >> "$out"
+        echo "[sweep] ${key}: config layout does not fit below IRQ_CFG_BASE ${irq_cfg_base}" >&2
+        unbuildable=$(( unbuildable + 1 ))
+        continue
+      fi
+      if (( num_slots > 8 )); then
+        echo "${key},fail_slots,,,,," >> "$out"
+        echo "[sweep] ${key}: more than 8 slots" >&2
+        unbuildable=$(( unbuildable + 1 ))
+        continue
+      fi
+
+      json="${work}/${tag}.json"
+      rpt="${work}/${tag}.rpt"
+      ys="${work}/${tag}.ys"
+      {
+        printf 'read_verilog -sv'
+        printf ' "%s"' "${srcs[@]}"
+        printf '\n'
+        printf 'chparam -set ADDR_W %s -set NUM_WIN %s -set NUM_SLOTS %s %s\n' \
+          "$addr_w" "$num_win" "$num_slots" "$top"
+        printf 'synth_ice40 -top %s -json "%s"\n' "$top" "$json"
+      } > "$ys"
+
+      echo "[sweep] ${key}" >&2
+      if ! yosys -q -l "${work}/${tag}.yosys.log" -s "$ys" >/dev/null; then
+        echo "${key},fail_synth,,,,," >> "$out"
+        continue
+      fi
+      if ! nextpnr-ice40 "--${device}" --package "$package" --json "$json" \
+             --pcf-allow-unconstrained --timing-allow-fail \
+             --report "$rpt" -q -l "${work}/${tag}.nextpnr.log" >/dev/null 2>&1; then
+        echo "${key},fail_pnr,,,,," >> "$out"
+        continue
+      fi
+      echo "${key},ok,$(report_fields "$rpt")" >> "$out"
+    done
+  done
+done
+
+if command -v column >/dev/null 2>&1; then
+  column -s, -t < "$out"
+else
+  cat "$out"
+fi
+
+if (( unbuildable > 0 )); then
+  echo "${unbuildable} point(s) of the matrix cannot be built; drop them from --points / --num-slots" >&2
+  exit 1
+fi
+
+if [[ "$update_baseline" -eq 1 ]]; then
+  if [[ -z "$baseline" ]]; then
+    echo "--update-baseline needs --baseline" >&2
+    exit 2
+  fi
+  cp "$out" "$baseline"
+  echo "Baseline updated: $baseline" >&2
+  exit 0
+fi
+
+if [[ -z "$baseline" ]]; then
+  exit 0
+fi
+if [[ ! -f "$baseline" ]]; then
+  echo "Baseline $baseline not found; record one with --update-baseline" \
+       "(CMake target synth_sweep_baseline)." >&2
+  exit 1
+fi
+
+awk -F, -v lc_tol="$lc_tol" -v fmax_tol="$fmax_tol" '
+  NR == FNR {
+    if (FNR > 1) {
+      key = $1 FS $2 FS $3 FS $4
+      b_status[key] = $5; b_lc[key] = $6; b_io[key] = $8; b_bram[key] = $9; b_fmax[key] = $10
+    }
+    next
+  }
+  FNR == 1 { next }
+  {
+    key = $1 FS $2 FS $3 FS $4
+    if (!(key in b_status)) {
+      printf "MISSING %s: not in baseline, re-record it\n", key; bad++; next
+    }
+    if (b_status[key] != "ok") next
+    if ($5 != "ok") {
+      printf "REGRESSION %s: status %s (baseline ok)\n", key, $5; bad++; next
+    }
+    if ($6 + 0 > b_lc[key] * (1 + lc_tol / 100)) {
+      printf "REGRESSION %s: LC %d > baseline %d (+%s%%)\n", key, $6, b_lc[key], lc_tol; bad++
+    }
+    if ($8 + 0 > b_io[key] + 0) {
+      printf "REGRESSION %s: IO %d > baseline %d\n", key, $8, b_io[key]; bad++
+    }
+    if ($9 + 0 > b_bram[key] + 0) {
+      printf "REGRESSION %s: BRAM %d > baseline %d\n", key, $9, b_bram[key]; bad++
+    }
+    if ($10 + 0 < b_fmax[key] * (1 - fmax_tol / 100)) {
+      printf "REGRESSION %s: fmax %.2f MHz < baseline %.2f MHz (-%s%%)\n", key, $10, b_fmax[key], fmax_tol; bad++
+    }
+  }
+  END {
+    if (bad) { printf "%d regression(s) or missing point(s) against baseline\n", bad; exit 1 }
+    print "No regressions against baseline."
+  }' "$baseline" "$out"
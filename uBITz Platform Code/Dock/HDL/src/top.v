@@ -5,6 +5,53 @@
 // instantiation point. The irq_router's active interrupt metadata
 // (irq_int_active/irq_int_slot) feeds the addr_decoder to steer
 // Mode-2 vector fetches. A shared cfg_clk drives both config buses.
+// cfg_re reads back irq_router state (routes, coalescing, counters)
+// on cfg_rdata, which shares the CFG_DATA pins with cfg_wdata on the
+// board: it is driven only while cfg_re is high and floats otherwise,
+// so the MCU must sample before dropping cfg_re. The decoder tables
+// are write-only, so reads below IRQ_CFG_BASE return a read-only
+// capability block instead: build parameters and config layout, letting
+// the MCU program any build.
+// With TRACE_EN, a bus_trace ring buffer records every I/O cycle and
+// owns the 16 config bytes at TRACE_CFG_BASE (see bus_trace.v).
+// With SVC_EN, decoder slot SVC_SLOT is the Dock services pseudo-slot
+// (dock_services.v): its cs, ready and INT_CH0 stay inside the CPLD,
+// it answers on the Tile-side data bus through dock_dout/dock_doe and the
+// MCU drains its mailbox FIFOs over SPI. cs_n[SVC_SLOT] stays high.
+// Decoder windows with the DOCK flag map irq_router's Host status window
+// (cause, pending, mask) with no /CS and no wait states; reads drive
+// dock_dout, writes are taken from dock_din when the Host cycle ends.
+// With CFG_INIT_EN, CFG_INIT is a 256-byte image of the config bus (byte a
+// at CFG_INIT[8a +: 8], generated by gen_cfg_init.sh) that the decoder tables,
+// Bank regions and irq_router routes power up / reset to, so the Host can boot
+// before the MCU has programmed anything. CAP_INIT_SUM lets the MCU confirm
+// the map.
+// Decoder windows with the BRIDGE flag point at a slot holding a downstream
+// Dock: its cs_n drives that Dock's /IORQ, its /READY comes back on
+// dev_ready_n and the FSM holds /READY low for BRIDGE_HOLD clocks first.
+// The downstream Dock's cpu_int/cpu_nmi come in as that slot's
+// tile_int_req/tile_nmi_req and slot_ack drives its irq_vec_cycle/irq_ack,
+// so interrupts and vector fetches pass through; CAUSE bit 5 tags them.
+// Memory cycles (/MREQ low, /IORQ high) take a separate path: mem_decoder
+// matches addr against NUM_MEM_REGION Bank regions, programmed on the
+// config bus after the decoder tables, and drives bank_cs_n with the
+// /MEM0_CS, /MEM1_CS space select. It is combinational and bypasses the
+// decoder FSM, so Bank cycles never see a Dock wait state.
+//
+// Capability block (cfg_re, cfg_addr = CAP_*):
+//   0x00-0x01 magic "UD"         0x02 CAP_VERSION
+//   0x03 ADDR_W                  0x04 NUM_WIN          0x05 NUM_RANGE_WIN
+//   0x06 NUM_SLOTS               0x07 NUM_TILE_INT_CH
+//   0x08 NUM_CPU_INT             0x09 NUM_CPU_NMI      0x0A IRQ_CFG_BASE
+//   0x0B decoder CFG_BYTES       0x0C-0x0F decoder BASE/MASK/SLOT/OP offsets
+//   0x10 IRQ NMI offset          0x11 IRQ coalescing offset
+//   0x12 IRQ counter snapshot    0x13 COAL_TICK_W      0x14 feature bits
+//   0x15 TRACE_CFG_BASE (0 = none)  0x16 trace DEPTH_LOG2  0x17 trace entry bytes
+//   0x18 SVC_SLOT (0xFF = none)     0x19 SVC_FIFO_LOG2
+//   0x1A-0x1B Fletcher-16 of the baked map {sum2, sum1} (0 = none)
+//   0x1C BRIDGE_HOLD
+//   0x1D Bank region offset (0 = none)  0x1E NUM_MEM_REGION
+//   (offsets of IRQ entries are relative to IRQ_CFG_BASE; others read 0x00)
 //
 // Note: irq_vec_cycle and irq_ack originate from the same external
 // /CPU_ACK pin; they remain separate inputs here so external logic
@@ -13,6 +60,7 @@
 module top #(
     parameter integer ADDR_W           = 32,
     parameter integer NUM_WIN          = 16,
+    parameter integer NUM_RANGE_WIN    = NUM_WIN,
     parameter integer NUM_SLOTS        = 5,
     parameter integer NUM_CPU_INT      = 4,
     parameter integer NUM_CPU_NMI      = 2,
@@ -20,8 +68,27 @@ module top #(
     parameter integer CFG_ADDR_WIDTH   = 8,
     // Shared 8-bit config bus: below IRQ_CFG_BASE -> addr_decoder,
     // at/above IRQ_CFG_BASE -> irq_router (offset by this base).
+    // 8-slot / 4-channel builds need the larger IRQ region: IRQ_CFG_BASE = 8'hA0
+    // (with ADDR_W = 32 / NUM_WIN = 16 that leaves no room for NUM_MEM_REGION).
     parameter [CFG_ADDR_WIDTH-1:0] IRQ_CFG_BASE = 8'hC0,
-    parameter integer SLOT_IDX_WIDTH   = (NUM_SLOTS <= 1) ? 1 : $clog2(NUM_SLOTS)
+    parameter integer SLOT_IDX_WIDTH   = (NUM_SLOTS <= 1) ? 1 : $clog2(NUM_SLOTS),
+    parameter integer COAL_TICK_W      = 8,
+    // Bus trace buffer: 2^TRACE_DEPTH_LOG2 entries, config at TRACE_CFG_BASE..+0x0F
+    parameter integer TRACE_EN         = 1,
+    parameter integer TRACE_DEPTH_LOG2 = 8,
+    parameter [7:0]   TRACE_CFG_BASE   = 8'hF0,
+    // Dock services pseudo-slot (virtual slot 0 by default)
+    parameter integer SVC_EN           = 1,
+    parameter integer SVC_SLOT         = 0,
+    parameter integer SVC_FIFO_LOG2    = 9,
+    // Baked power-on decode/route map (see gen_cfg_init.sh)
+    parameter integer CFG_INIT_EN      = 0,
+    parameter [2047:0] CFG_INIT        = 2048'd0,
+    // /READY-low clocks forced on BRIDGE windows: 3 for a downstream Dock on
+    // this clk, 4 for one on an unrelated clock (<= 7)
+    parameter integer BRIDGE_HOLD      = 3,
+    // Bank memory regions decoded for /MREQ cycles (0 = no Bank decode)
+    parameter integer NUM_MEM_REGION   = 4
 )(
     input  wire                         clk,
     input  wire                         rst_n,
@@ -29,6 +96,7 @@ module top #(
     // CPU bus interface
     input  wire [ADDR_W-1:0]            addr,
     input  wire                         iorq_n,
+    input  wire                         mreq_n,
     input  wire                         r_w_,
     input  wire                         irq_vec_cycle,
     input  wire                         irq_ack,
@@ -38,8 +106,17 @@ module top #(
     output wire                         data_oe_n,
     output wire                         data_dir,
     output wire                         ff_oe_n,
+    output wire                         post_le,
+    output wire                         post_oe_n,
+    output wire [ADDR_W-1:0]            post_addr,
+    output wire                         addr_oe_n,
     output wire [NUM_SLOTS-1:0]         cs_n,
 
+    // Bank slot select and memory space (valid while bank_cs_n is low)
+    output wire                         bank_cs_n,
+    output wire                         mem0_cs_n,
+    output wire                         mem1_cs_n,
+
     // CPU interrupt outputs
     output wire [NUM_CPU_INT-1:0]       cpu_int,
     output wire [NUM_CPU_NMI-1:0]       cpu_nmi,
@@ -50,20 +127,220 @@ module top #(
     input  wire [NUM_SLOTS-1:0]         tile_nmi_req,
     output wire [NUM_SLOTS-1:0]         slot_ack,
 
+    // Dock-internal registers on the Tile-side data bus (services slot,
+    // IRQ status window) and the services MCU SPI mailbox
+    input  wire [7:0]                   dock_din,
+    output wire [7:0]                   dock_dout,
+    output wire                         dock_doe,
+    input  wire                         svc_spi_sck,
+    input  wire                         svc_spi_cs_n,
+    input  wire                         svc_spi_mosi,
+    output wire                         svc_spi_miso,
+    output wire                         svc_mcu_irq,
+
     // Configuration interfaces
     input  wire                         cfg_clk,
     input  wire                         cfg_we,
     input  wire [7:0]                   cfg_addr,
-    input  wire [7:0]                   cfg_wdata
+    input  wire [7:0]                   cfg_wdata,
+    input  wire                         cfg_re,
+    output wire [7:0]                   cfg_rdata
 );
 
+    // Config layout (must match addr_decoder_cfg and irq_router)
+    localparam integer CFG_BYTES     = (ADDR_W + 7) / 8;
+    localparam integer DEC_MASK_OFF  = NUM_WIN * CFG_BYTES;
+    localparam integer DEC_SLOT_OFF  = DEC_MASK_OFF + NUM_WIN * CFG_BYTES;
+    localparam integer DEC_OP_OFF    = DEC_SLOT_OFF + NUM_WIN;
+    localparam integer DEC_CFG_END   = DEC_OP_OFF + NUM_WIN;
+    localparam integer MEM_CFG_OFF   = DEC_CFG_END;
+    localparam integer MEM_CFG_END   = MEM_CFG_OFF + NUM_MEM_REGION * (CFG_BYTES + 1);
+    localparam integer NUM_INT_SRC   = NUM_SLOTS * NUM_TILE_INT_CH;
+    localparam integer IRQ_NMI_OFF   = NUM_INT_SRC;
+    localparam integer IRQ_COAL_OFF  = NUM_INT_SRC + NUM_SLOTS;
+    localparam integer IRQ_COAL_SNAP = IRQ_COAL_OFF + NUM_INT_SRC;
+    localparam integer IRQ_CFG_END   = IRQ_COAL_SNAP + 3;
+    localparam integer WIN_INDEX_W   = (NUM_WIN <= 16) ? 4 : $clog2(NUM_WIN);
+    localparam integer TRACE_ENTRY_BYTES = 6 + CFG_BYTES;
+
+    localparam [7:0] CAP_VERSION  = 8'h01;
+    // Feature bits: [0] range windows, [1] posted writes, [2] IRQ coalescing,
+    // [3] bus trace, [4] Dock services slot, [5] DOCK windows / IRQ status window,
+    // [6] baked power-on map, [7] BRIDGE windows
+    localparam [7:0] CAP_FEATURES = {1'b1, (CFG_INIT_EN != 0), 1'b1, (SVC_EN != 0),
+                                     (TRACE_EN != 0), 1'b1, 1'b1, (NUM_RANGE_WIN > 0)};
+
+    // Fletcher-16 over the baked decoder and Bank region bytes [0, MEM_CFG_END),
+    // followed by the
+    // IRQ route/NMI/coalescing bytes [IRQ_CFG_BASE, IRQ_CFG_BASE + IRQ_COAL_SNAP).
+    // The MCU renders its own map the same way to decide whether to reprogram.
+    function automatic [15:0] init_sum(input integer dummy);
+        integer i, a;
+        reg [8:0] s1, s2;
+        begin
+            s1 = 0;
+            s2 = 0;
+            for (i = 0; i < MEM_CFG_END + IRQ_COAL_SNAP; i = i + 1) begin
+                a  = (i < MEM_CFG_END) ? i : IRQ_CFG_BASE + i - MEM_CFG_END;
+                s1 = (s1 + CFG_INIT[8*a +: 8]) % 255;
+                s2 = (s2 + s1) % 255;
+            end
+            init_sum = {s2[7:0], s1[7:0]};
+        end
+    endfunction
+
+    localparam [15:0] CAP_INIT_SUM = CFG_INIT_EN ? init_sum(0) : 16'h0000;
+
+`ifndef SYNTHESIS
+    initial begin
+        if (MEM_CFG_END > IRQ_CFG_BASE)
+            $fatal(1, "top: decoder config (%0d bytes) overlaps IRQ_CFG_BASE 0x%02h",
+                   MEM_CFG_END, IRQ_CFG_BASE);
+        if (IRQ_CFG_BASE + IRQ_CFG_END > 256)
+            $fatal(1, "top: irq_router config (%0d bytes) does not fit above IRQ_CFG_BASE 0x%02h",
+                   IRQ_CFG_END, IRQ_CFG_BASE);
+        if (NUM_SLOTS > 8)
+            $fatal(1, "top: NUM_SLOTS=%0d exceeds the 3-bit sel_slot", NUM_SLOTS);
+        if (TRACE_EN && (IRQ_CFG_BASE + IRQ_CFG_END > TRACE_CFG_BASE))
+            $fatal(1, "top: irq_router config overlaps TRACE_CFG_BASE 0x%02h", TRACE_CFG_BASE);
+        if (TRACE_EN && (TRACE_CFG_BASE[3:0] != 4'h0 || TRACE_DEPTH_LOG2 > 8))
+            $fatal(1, "top: TRACE_CFG_BASE must be 16-byte aligned and TRACE_DEPTH_LOG2 <= 8");
+        if (SVC_EN && SVC_SLOT >= NUM_SLOTS)
+            $fatal(1, "top: SVC_SLOT=%0d outside NUM_SLOTS=%0d", SVC_SLOT, NUM_SLOTS);
+        if (BRIDGE_HOLD > 7)
+            $fatal(1, "top: BRIDGE_HOLD=%0d exceeds the 3-bit hold counter", BRIDGE_HOLD);
+    end
+`endif
+
     // Wires bridging irq_router to addr_decoder for Mode-2 steering.
     wire irq_int_active_sig;
     wire [SLOT_IDX_WIDTH-1:0] irq_int_slot_sig;
 
-    // Shared 8-bit config bus split: low range to addr_decoder, high range to irq_router.
+    // Services pseudo-slot taps: decoder-side cs/ready and router-side request
+    wire [NUM_SLOTS-1:0]                 dec_cs_n;
+    wire [NUM_SLOTS-1:0]                 dec_dev_ready_n;
+    wire [NUM_SLOTS*NUM_TILE_INT_CH-1:0] irq_int_req;
+
+    // Decoder outcome, observed by the bus trace
+    wire                   win_valid_sig;
+    wire [WIN_INDEX_W-1:0] win_index_sig;
+    wire [2:0]             sel_slot_sig;
+    wire                   dock_sel_sig;
+    wire [NUM_SLOTS-1:0]   bridge_slots_sig;
+
+    // Dock-internal read data: services slot and IRQ status window
+    wire [7:0]             svc_dout;
+    wire                   svc_doe;
+    wire [7:0]             irq_host_rdata;
+
+    // IRQ status window: reads are combinational during the Host cycle;
+    // writes sample dock_din while the transceivers are on and are applied
+    // on the clk after /IORQ rises. A pending write belongs to the Host cycle
+    // as long as that stays a write to the same register; any other DOCK
+    // access seen first (a Host that keeps /IORQ low between cycles) applies
+    // it before being captured, with /READY held low for that clk.
+    reg                    dock_wr_pend;
+    reg  [3:0]             dock_wr_addr;
+    reg  [7:0]             dock_wr_data;
+    wire                   dock_wr_own   = dock_sel_sig && !r_w_ && addr[3:0] == dock_wr_addr;
+    wire                   irq_host_we   = dock_wr_pend && !dock_wr_own;
+    wire [3:0]             irq_host_addr = irq_host_we ? dock_wr_addr : addr[3:0];
+    wire                   dock_wr_stall = dock_sel_sig && irq_host_we;
+    wire                   dec_ready_n;
+
+    assign ready_n = dec_ready_n && !dock_wr_stall;
+
+    always @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            dock_wr_pend <= 1'b0;
+            dock_wr_addr <= 4'h0;
+            dock_wr_data <= 8'h00;
+        end else if (irq_host_we) begin
+            dock_wr_pend <= 1'b0;
+        end else if (dock_sel_sig && !r_w_ && !data_oe_n) begin
+            dock_wr_pend <= 1'b1;
+            dock_wr_addr <= addr[3:0];
+            dock_wr_data <= dock_din;
+        end else begin
+            dock_wr_pend <= 1'b0;
+        end
+    end
+
+    assign dock_doe  = svc_doe || (dock_sel_sig && r_w_);
+    assign dock_dout = dock_sel_sig ? irq_host_rdata : svc_dout;
+
+    // Shared 8-bit config bus split: low range to addr_decoder, high range to
+    // irq_router, top 16 bytes at TRACE_CFG_BASE to bus_trace.
+    wire        trace_sel    = (TRACE_EN != 0) && (cfg_addr >= TRACE_CFG_BASE);
     wire        dec_cfg_we   = cfg_we && (cfg_addr < IRQ_CFG_BASE[7:0]);
-    wire        irq_cfg_we   = cfg_we && (cfg_addr >= IRQ_CFG_BASE[7:0]);
+    wire        irq_cfg_we   = cfg_we && (cfg_addr >= IRQ_CFG_BASE[7:0]) && !trace_sel;
+    wire        irq_cfg_re   = cfg_re && (cfg_addr >= IRQ_CFG_BASE[7:0]) && !trace_sel;
+    wire        cap_cfg_re   = cfg_re && (cfg_addr <  IRQ_CFG_BASE[7:0]);
+    wire        trace_cfg_we = cfg_we && trace_sel;
+    wire        trace_cfg_re = cfg_re && trace_sel;
+    wire [7:0]  irq_cfg_rdata;
+    wire [7:0]  trace_cfg_rdata;
+
+    // Read-only capability block (read through the decoder's address range)
+    function [7:0] cap_byte(input [7:0] a);
+        begin
+            case (a)
+                8'h00:   cap_byte = 8'h55; // 'U'
+                8'h01:   cap_byte = 8'h44; // 'D'
+                8'h02:   cap_byte = CAP_VERSION;
+                8'h03:   cap_byte = ADDR_W;
+                8'h04:   cap_byte = NUM_WIN;
+                8'h05:   cap_byte = NUM_RANGE_WIN;
+                8'h06:   cap_byte = NUM_SLOTS;
+                8'h07:   cap_byte = NUM_TILE_INT_CH;
+                8'h08:   cap_byte = NUM_CPU_INT;
+                8'h09:   cap_byte = NUM_CPU_NMI;
+                8'h0A:   cap_byte = IRQ_CFG_BASE[7:0];
+                8'h0B:   cap_byte = CFG_BYTES;
+                8'h0C:   cap_byte = 8'h00; // decoder BASE offset
+                8'h0D:   cap_byte = DEC_MASK_OFF;
+                8'h0E:   cap_byte = DEC_SLOT_OFF;
+                8'h0F:   cap_byte = DEC_OP_OFF;
+                8'h10:   cap_byte = IRQ_NMI_OFF;
+                8'h11:   cap_byte = IRQ_COAL_OFF;
+                8'h12:   cap_byte = IRQ_COAL_SNAP;
+                8'h13:   cap_byte = COAL_TICK_W;
+                8'h14:   cap_byte = CAP_FEATURES;
+                8'h15:   cap_byte = TRACE_EN ? TRACE_CFG_BASE : 8'h00;
+                8'h16:   cap_byte = TRACE_EN ? TRACE_DEPTH_LOG2 : 0;
+                8'h17:   cap_byte = TRACE_EN ? TRACE_ENTRY_BYTES : 0;
+                8'h18:   cap_byte = SVC_EN ? SVC_SLOT : 8'hFF;
+                8'h19:   cap_byte = SVC_EN ? SVC_FIFO_LOG2 : 0;
+                8'h1A:   cap_byte = CAP_INIT_SUM[7:0];
+                8'h1B:   cap_byte = CAP_INIT_SUM[15:8];
+                8'h1C:   cap_byte = BRIDGE_HOLD;
+                8'h1D:   cap_byte = NUM_MEM_REGION ? MEM_CFG_OFF : 8'h00;
+                8'h1E:   cap_byte = NUM_MEM_REGION;
+                default: cap_byte = 8'h00;
+            endcase
+        end
+    endfunction
+
+    reg [7:0] cap_rdata;
+    reg       cap_rd_sel;   // last read targeted the capability block
+    reg       trace_rd_sel; // last read targeted the bus trace
+
+    always @(posedge cfg_clk or negedge rst_n) begin
+        if (!rst_n) begin
+            cap_rdata    <= 8'h00;
+            cap_rd_sel   <= 1'b0;
+            trace_rd_sel <= 1'b0;
+        end else if (cfg_re) begin
+            cap_rd_sel   <= cap_cfg_re;
+            trace_rd_sel <= trace_cfg_re;
+            cap_rdata    <= cap_byte(cfg_addr);
+        end
+    end
+
+    // Released whenever cfg_re is low so the MCU can drive CFG_DATA for writes
+    assign cfg_rdata = !cfg_re      ? 8'bz :
+                       cap_rd_sel   ? cap_rdata :
+                       trace_rd_sel ? trace_cfg_rdata : irq_cfg_rdata;
     wire [7:0]  dec_cfg_addr = cfg_addr;
     wire [CFG_ADDR_WIDTH-1:0] irq_cfg_addr = cfg_addr - IRQ_CFG_BASE[7:0];
 
@@ -73,12 +350,15 @@ module top #(
         .NUM_CPU_NMI     (NUM_CPU_NMI),
         .NUM_TILE_INT_CH (NUM_TILE_INT_CH),
         .CFG_ADDR_WIDTH  (CFG_ADDR_WIDTH),
-        .SLOT_IDX_WIDTH  (SLOT_IDX_WIDTH)
+        .SLOT_IDX_WIDTH  (SLOT_IDX_WIDTH),
+        .COAL_TICK_W     (COAL_TICK_W),
+        .CFG_INIT_EN     (CFG_INIT_EN),
+        .CFG_INIT        (CFG_INIT >> (8 * IRQ_CFG_BASE))
     ) u_irq_router (
         .clk           (clk),
         .rst_n         (rst_n),
         .cfg_clk       (cfg_clk),
-        .tile_int_req  (tile_int_req),
+        .tile_int_req  (irq_int_req),
         .tile_nmi_req  (tile_nmi_req),
         .irq_ack       (irq_ack),
         .cpu_int       (cpu_int),
@@ -86,24 +366,34 @@ module top #(
         .slot_ack      (slot_ack),
         .irq_int_active(irq_int_active_sig),
         .irq_int_slot  (irq_int_slot_sig),
+        .bridge_slots  (bridge_slots_sig),
         .cfg_wr_en     (irq_cfg_we),
-        .cfg_rd_en     (1'b0),
+        .cfg_rd_en     (irq_cfg_re),
         .cfg_addr      (irq_cfg_addr),
-        .cfg_wdata     (cfg_wdata)
+        .cfg_wdata     (cfg_wdata),
+        .cfg_rdata     (irq_cfg_rdata),
+        .host_we       (irq_host_we),
+        .host_addr     (irq_host_addr),
+        .host_wdata    (dock_wr_data),
+        .host_rdata    (irq_host_rdata)
     );
 
     addr_decoder #(
         .ADDR_W        (ADDR_W),
         .NUM_WIN       (NUM_WIN),
+        .NUM_RANGE_WIN (NUM_RANGE_WIN),
         .NUM_SLOTS     (NUM_SLOTS),
-        .SLOT_IDX_WIDTH(SLOT_IDX_WIDTH)
+        .SLOT_IDX_WIDTH(SLOT_IDX_WIDTH),
+        .CFG_INIT_EN   (CFG_INIT_EN),
+        .CFG_INIT      (CFG_INIT),
+        .BRIDGE_HOLD   (BRIDGE_HOLD)
     ) u_addr_decoder (
         .addr           (addr),
         .iorq_n         (iorq_n),
         .clk            (clk),
         .rst_n          (rst_n),
         .r_w_           (r_w_),
-        .dev_ready_n    (dev_ready_n),
+        .dev_ready_n    (dec_dev_ready_n),
         .irq_int_active (irq_int_active_sig),
         .irq_int_slot   (irq_int_slot_sig),
         .irq_vec_cycle  (irq_vec_cycle),
@@ -111,12 +401,137 @@ module top #(
         .cfg_we         (dec_cfg_we),
         .cfg_addr       (dec_cfg_addr),
         .cfg_wdata      (cfg_wdata),
-        .ready_n        (ready_n),
+        .ready_n        (dec_ready_n),
         .io_r_w_        (io_r_w_),
         .data_oe_n      (data_oe_n),
         .data_dir       (data_dir),
         .ff_oe_n        (ff_oe_n),
-        .cs_n           (cs_n)
+        .post_le        (post_le),
+        .post_oe_n      (post_oe_n),
+        .post_addr      (post_addr),
+        .addr_oe_n      (addr_oe_n),
+        .win_valid      (win_valid_sig),
+        .win_index      (win_index_sig),
+        .sel_slot       (sel_slot_sig),
+        .dock_sel       (dock_sel_sig),
+        .bridge_slots   (bridge_slots_sig),
+        .cs_n           (dec_cs_n)
     );
 
+    // Bank memory decode: shares the decoder's config write strobe and sits
+    // straight on the Host pins, beside (not behind) the I/O decoder.
+    generate
+        if (NUM_MEM_REGION > 0) begin : g_mem
+            mem_decoder #(
+                .ADDR_W     (ADDR_W),
+                .NUM_REGION (NUM_MEM_REGION),
+                .CFG_OFF    (MEM_CFG_OFF),
+                .CFG_INIT_EN(CFG_INIT_EN),
+                .CFG_INIT   (CFG_INIT)
+            ) u_mem_decoder (
+                .cfg_clk  (cfg_clk),
+                .cfg_we   (dec_cfg_we),
+                .cfg_addr (dec_cfg_addr),
+                .cfg_wdata(cfg_wdata),
+                .addr     (addr),
+                .mreq_n   (mreq_n),
+                .iorq_n   (iorq_n),
+                .bank_cs_n(bank_cs_n),
+                .mem0_cs_n(mem0_cs_n),
+                .mem1_cs_n(mem1_cs_n)
+            );
+        end else begin : g_no_mem
+            assign bank_cs_n = 1'b1;
+            assign mem0_cs_n = 1'b1;
+            assign mem1_cs_n = 1'b1;
+        end
+    endgenerate
+
+    generate
+        if (SVC_EN) begin : g_svc
+            wire svc_ready;
+            wire svc_irq;
+
+            dock_services #(
+                .FIFO_LOG2(SVC_FIFO_LOG2)
+            ) u_dock_services (
+                .clk      (clk),
+                .rst_n    (rst_n),
+                .cs       (!dec_cs_n[SVC_SLOT]),
+                .r_w_     (io_r_w_),
+                // A posted write drains after the Host has moved on: take its
+                // register from the latched address, like the Tile bus does
+                .addr     (post_oe_n ? addr[3:0] : post_addr[3:0]),
+                .vec_cycle(irq_vec_cycle && irq_int_active_sig && (irq_int_slot_sig == SVC_SLOT)),
+                .din      (dock_din),
+                .dout     (svc_dout),
+                .doe      (svc_doe),
+                .ready    (svc_ready),
+                .host_irq (svc_irq),
+                .spi_sck  (svc_spi_sck),
+                .spi_cs_n (svc_spi_cs_n),
+                .spi_mosi (svc_spi_mosi),
+                .spi_miso (svc_spi_miso),
+                .mcu_irq  (svc_mcu_irq)
+            );
+
+            // The slot's /CS, ready and INT_CH0 are internal; the pins idle.
+            genvar gs;
+            for (gs = 0; gs < NUM_SLOTS; gs = gs + 1) begin : g_slot
+                if (gs == SVC_SLOT) begin : g_int
+                    assign cs_n[gs]            = 1'b1;
+                    assign dec_dev_ready_n[gs] = svc_ready;
+                end else begin : g_ext
+                    assign cs_n[gs]            = dec_cs_n[gs];
+                    assign dec_dev_ready_n[gs] = dev_ready_n[gs];
+                end
+            end
+            for (gs = 0; gs < NUM_SLOTS*NUM_TILE_INT_CH; gs = gs + 1) begin : g_int_req
+                if (gs == SVC_SLOT*NUM_TILE_INT_CH) begin : g_int
+                    assign irq_int_req[gs] = svc_irq;
+                end else begin : g_ext
+                    assign irq_int_req[gs] = tile_int_req[gs];
+                end
+            end
+        end else begin : g_no_svc
+            assign cs_n            = dec_cs_n;
+            assign dec_dev_ready_n = dev_ready_n;
+            assign irq_int_req     = tile_int_req;
+            assign svc_dout        = 8'h00;
+            assign svc_doe         = 1'b0;
+            assign svc_spi_miso    = 1'b0;
+            assign svc_mcu_irq     = 1'b0;
+        end
+    endgenerate
+
+    generate
+        if (TRACE_EN) begin : g_trace
+            bus_trace #(
+                .ADDR_W     (ADDR_W),
+                .WIN_INDEX_W(WIN_INDEX_W),
+                .DEPTH_LOG2 (TRACE_DEPTH_LOG2)
+            ) u_bus_trace (
+                .clk       (clk),
+                .rst_n     (rst_n),
+                .addr      (addr),
+                .iorq_n    (iorq_n),
+                .r_w_      (r_w_),
+                .ready_n   (ready_n),
+                .win_valid (win_valid_sig),
+                .win_index (win_index_sig),
+                .sel_slot  (sel_slot_sig),
+                .vec_cycle (irq_vec_cycle && irq_int_active_sig),
+                .post_le   (post_le),
+                .cfg_clk   (cfg_clk),
+                .cfg_wr_en (trace_cfg_we),
+                .cfg_rd_en (trace_cfg_re),
+                .cfg_addr  (cfg_addr[3:0]),
+                .cfg_wdata (cfg_wdata),
+                .cfg_rdata (trace_cfg_rdata)
+            );
+        end else begin : g_no_trace
+            assign trace_cfg_rdata = 8'h00;
+        end
+    endgenerate
+
 endmodule
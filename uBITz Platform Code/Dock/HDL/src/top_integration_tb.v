@@ -4,6 +4,23 @@
 // - Programs addr_decoder window tables in the low address range.
 // - Programs irq_router route entries in the high address range.
 // - Verifies that writes land in the right block by observing cs_n and cpu_int.
+// - Reads the capability block and an IRQ route back over cfg_re/cfg_rdata,
+//   which floats again once cfg_re drops.
+// - Programs an 8-slot / 4-channel build purely from its capability block.
+// - Arms the bus trace on an address trigger and drains the frozen entries.
+// - Exchanges bytes between a Host and the MCU through the Dock services
+//   slot (slot 0) mailbox, including its interrupt and a posted write that
+//   drains while the Host is already on its next cycle.
+// - Reads the IRQ status window through a DOCK decoder window with no wait
+//   states and masks a route from the Host side.
+// - Decodes and routes from a baked power-on map (CFG_INIT) straight out of
+//   reset, with no config writes, and checks its capability checksum.
+// - Chains a second Dock behind a BRIDGE window on slot 2 and checks the
+//   per-hop /READY latency, interrupt pass-through, CAUSE bit 5 and a Mode-2
+//   vector fetch steered through both Docks.
+// - Decodes Bank memory cycles (/MREQ) to the Bank /CS and /MEM0_CS,
+//   /MEM1_CS for all four spaces with no clock edge and no /READY wait,
+//   including a baked Bank region.
 module top_integration_tb;
     localparam [7:0] IRQ_CFG_BASE = 8'hC0;
 
@@ -13,12 +30,30 @@ module top_integration_tb;
     localparam int NUM_CPU_INT     = 2;
     localparam int NUM_CPU_NMI     = 1;
     localparam int NUM_TILE_INT_CH = 2;
+    localparam [7:0] TRACE_CFG_BASE = 8'hF0; // top default
+
+    // Scaled build: 8 slots x 4 INT channels, IRQ region moved down to 0xA0.
+    localparam [7:0] IRQ_CFG_BASE8 = 8'hA0;
+    localparam int NUM_SLOTS8       = 8;
+    localparam int NUM_TILE_INT_CH8 = 4;
+
+    // Baked map: window 0 = 0x60/0xF0 -> slot 2 (OP any, others default),
+    // Bank region 0 = ROM0 at 0xE0 (32 bytes), slot 2 ch 0 -> CPU INT1.
+    // Fletcher-16 of the image is 0xED5B.
+    localparam [2047:0] CFG_INIT_IMG = (2048'h60 << (8*8'h00)) |
+                                       (2048'hF0 << (8*8'h04)) |
+                                       (2048'h02 << (8*8'h08)) |
+                                       (2048'hFFFFFFFF << (8*8'h0C)) |
+                                       (2048'hE0 << (8*8'h10)) |
+                                       (2048'hA5 << (8*8'h14)) |
+                                       (2048'h81 << (8*(IRQ_CFG_BASE + 2*NUM_TILE_INT_CH)));
 
     reg                          clk;
     reg                          cfg_clk;
     reg                          rst_n;
     reg  [ADDR_W-1:0]            addr;
     reg                          iorq_n;
+    reg                          mreq_n;
     reg                          r_w_;
     reg                          irq_vec_cycle;
     reg                          irq_ack;
@@ -28,17 +63,74 @@ module top_integration_tb;
     reg                          cfg_we;
     reg  [7:0]                   cfg_addr;
     reg  [7:0]                   cfg_wdata;
+    reg                          cfg_re;
+    wire [7:0]                   cfg_rdata;
+
+    reg                          cfg_we8;
+    reg                          cfg_re8;
+    wire [7:0]                   cfg_rdata8;
+    reg  [NUM_SLOTS8-1:0]        dev_ready_n8;
+    reg  [NUM_SLOTS8*NUM_TILE_INT_CH8-1:0] tile_int_req8;
+    wire [NUM_SLOTS8-1:0]        cs_n8;
+    wire [NUM_CPU_INT-1:0]       cpu_int8;
+
+    reg                          cfg_rei;
+    wire [7:0]                   cfg_rdatai;
+    reg  [NUM_SLOTS*NUM_TILE_INT_CH-1:0] tile_int_reqi;
+    wire [NUM_SLOTS-1:0]         cs_ni;
+    wire                         bank_cs_ni;
+    wire [NUM_CPU_INT-1:0]       cpu_inti;
 
     wire                         ready_n;
     wire                         io_r_w_;
     wire                         data_oe_n;
     wire                         data_dir;
     wire                         ff_oe_n;
+    wire                         post_le;
+    wire                         post_oe_n;
+    wire [ADDR_W-1:0]            post_addr;
     wire [NUM_SLOTS-1:0]         cs_n;
+    wire                         bank_cs_n;
+    wire                         mem0_cs_n;
+    wire                         mem1_cs_n;
     wire [NUM_CPU_INT-1:0]       cpu_int;
     wire [NUM_CPU_NMI-1:0]       cpu_nmi;
     wire [NUM_SLOTS-1:0]         slot_ack;
 
+    // Bridged pair: dut_up slot 2 holds dut_dn (wired as a bridge card would)
+    reg                          cfg_weu;
+    reg                          cfg_wed;
+    reg                          cfg_reu;
+    wire [7:0]                   cfg_rdatau;
+    reg                          irq_vec_cycleu;
+    reg                          irq_acku;
+    wire                         ready_nu;
+    wire                         io_r_w_u;
+    wire [NUM_SLOTS-1:0]         cs_nu;
+    wire [NUM_CPU_INT-1:0]       cpu_intu;
+    wire [NUM_SLOTS-1:0]         slot_acku;
+    wire [7:0]                   dock_doutu;
+    wire                         dock_doeu;
+    wire                         ready_nd;
+    wire [NUM_SLOTS-1:0]         cs_nd;
+    wire [NUM_CPU_INT-1:0]       cpu_intd;
+    wire [NUM_CPU_NMI-1:0]       cpu_nmid;
+    wire [NUM_SLOTS-1:0]         slot_ackd;
+    wire [7:0]                   dock_doutd;
+    wire                         dock_doed;
+    reg  [NUM_SLOTS-1:0]         dev_ready_nd;
+    reg  [NUM_SLOTS*NUM_TILE_INT_CH-1:0] tile_int_reqd;
+
+    // Dock-internal registers on the Tile-side data bus, services MCU SPI
+    reg  [7:0]                   dock_din;
+    wire [7:0]                   dock_dout;
+    wire                         dock_doe;
+    reg                          svc_spi_sck;
+    reg                          svc_spi_cs_n;
+    reg                          svc_spi_mosi;
+    wire                         svc_spi_miso;
+    wire                         svc_mcu_irq;
+
     // DUT
     top #(
         .ADDR_W         (ADDR_W),
@@ -53,6 +145,7 @@ module top_integration_tb;
         .rst_n      (rst_n),
         .addr       (addr),
         .iorq_n     (iorq_n),
+        .mreq_n     (mreq_n),
         .r_w_       (r_w_),
         .irq_vec_cycle(irq_vec_cycle),
         .irq_ack    (irq_ack),
@@ -61,17 +154,251 @@ module top_integration_tb;
         .data_oe_n  (data_oe_n),
         .data_dir   (data_dir),
         .ff_oe_n    (ff_oe_n),
+        .post_le    (post_le),
+        .post_oe_n  (post_oe_n),
+        .post_addr  (post_addr),
+        .addr_oe_n  (),
         .cs_n       (cs_n),
+        .bank_cs_n  (bank_cs_n),
+        .mem0_cs_n  (mem0_cs_n),
+        .mem1_cs_n  (mem1_cs_n),
         .cpu_int    (cpu_int),
         .cpu_nmi    (cpu_nmi),
         .dev_ready_n(dev_ready_n),
         .tile_int_req(tile_int_req),
         .tile_nmi_req(tile_nmi_req),
         .slot_ack   (slot_ack),
+        .dock_din   (dock_din),
+        .dock_dout  (dock_dout),
+        .dock_doe   (dock_doe),
+        .svc_spi_sck (svc_spi_sck),
+        .svc_spi_cs_n(svc_spi_cs_n),
+        .svc_spi_mosi(svc_spi_mosi),
+        .svc_spi_miso(svc_spi_miso),
+        .svc_mcu_irq (svc_mcu_irq),
         .cfg_clk    (cfg_clk),
         .cfg_we     (cfg_we),
         .cfg_addr   (cfg_addr),
-        .cfg_wdata  (cfg_wdata)
+        .cfg_wdata  (cfg_wdata),
+        .cfg_re     (cfg_re),
+        .cfg_rdata  (cfg_rdata)
+    );
+
+    top #(
+        .ADDR_W         (ADDR_W),
+        .NUM_WIN        (NUM_WIN),
+        .NUM_SLOTS      (NUM_SLOTS8),
+        .NUM_CPU_INT    (NUM_CPU_INT),
+        .NUM_CPU_NMI    (NUM_CPU_NMI),
+        .NUM_TILE_INT_CH(NUM_TILE_INT_CH8),
+        .IRQ_CFG_BASE   (IRQ_CFG_BASE8)
+    ) dut8 (
+        .clk        (clk),
+        .rst_n      (rst_n),
+        .addr       (addr),
+        .iorq_n     (iorq_n),
+        .mreq_n     (mreq_n),
+        .r_w_       (r_w_),
+        .irq_vec_cycle(irq_vec_cycle),
+        .irq_ack    (irq_ack),
+        .ready_n    (),
+        .io_r_w_    (),
+        .data_oe_n  (),
+        .data_dir   (),
+        .ff_oe_n    (),
+        .post_le    (),
+        .post_oe_n  (),
+        .post_addr  (),
+        .addr_oe_n  (),
+        .cs_n       (cs_n8),
+        .bank_cs_n  (),
+        .mem0_cs_n  (),
+        .mem1_cs_n  (),
+        .cpu_int    (cpu_int8),
+        .cpu_nmi    (),
+        .dev_ready_n(dev_ready_n8),
+        .tile_int_req(tile_int_req8),
+        .tile_nmi_req({NUM_SLOTS8{1'b0}}),
+        .slot_ack   (),
+        .dock_din   (8'h00),
+        .dock_dout  (),
+        .dock_doe   (),
+        .svc_spi_sck (1'b0),
+        .svc_spi_cs_n(1'b1),
+        .svc_spi_mosi(1'b0),
+        .svc_spi_miso(),
+        .svc_mcu_irq (),
+        .cfg_clk    (cfg_clk),
+        .cfg_we     (cfg_we8),
+        .cfg_addr   (cfg_addr),
+        .cfg_wdata  (cfg_wdata),
+        .cfg_re     (cfg_re8),
+        .cfg_rdata  (cfg_rdata8)
+    );
+
+    // Same layout as dut, powering up with the baked map (never configured)
+    top #(
+        .ADDR_W         (ADDR_W),
+        .NUM_WIN        (NUM_WIN),
+        .NUM_SLOTS      (NUM_SLOTS),
+        .NUM_CPU_INT    (NUM_CPU_INT),
+        .NUM_CPU_NMI    (NUM_CPU_NMI),
+        .NUM_TILE_INT_CH(NUM_TILE_INT_CH),
+        .IRQ_CFG_BASE   (IRQ_CFG_BASE),
+        .CFG_INIT_EN    (1),
+        .CFG_INIT       (CFG_INIT_IMG)
+    ) dut_init (
+        .clk        (clk),
+        .rst_n      (rst_n),
+        .addr       (addr),
+        .iorq_n     (iorq_n),
+        .mreq_n     (mreq_n),
+        .r_w_       (r_w_),
+        .irq_vec_cycle(irq_vec_cycle),
+        .irq_ack    (irq_ack),
+        .ready_n    (),
+        .io_r_w_    (),
+        .data_oe_n  (),
+        .data_dir   (),
+        .ff_oe_n    (),
+        .post_le    (),
+        .post_oe_n  (),
+        .post_addr  (),
+        .addr_oe_n  (),
+        .cs_n       (cs_ni),
+        .bank_cs_n  (bank_cs_ni),
+        .mem0_cs_n  (),
+        .mem1_cs_n  (),
+        .cpu_int    (cpu_inti),
+        .cpu_nmi    (),
+        .dev_ready_n({NUM_SLOTS{1'b1}}),
+        .tile_int_req(tile_int_reqi),
+        .tile_nmi_req({NUM_SLOTS{1'b0}}),
+        .slot_ack   (),
+        .dock_din   (8'h00),
+        .dock_dout  (),
+        .dock_doe   (),
+        .svc_spi_sck (1'b0),
+        .svc_spi_cs_n(1'b1),
+        .svc_spi_mosi(1'b0),
+        .svc_spi_miso(),
+        .svc_mcu_irq (),
+        .cfg_clk    (cfg_clk),
+        .cfg_we     (1'b0),
+        .cfg_addr   (cfg_addr),
+        .cfg_wdata  (cfg_wdata),
+        .cfg_re     (cfg_rei),
+        .cfg_rdata  (cfg_rdatai)
+    );
+
+    // Upstream Dock of the bridged pair, Host side on the shared bus
+    top #(
+        .ADDR_W         (ADDR_W),
+        .NUM_WIN        (NUM_WIN),
+        .NUM_SLOTS      (NUM_SLOTS),
+        .NUM_CPU_INT    (NUM_CPU_INT),
+        .NUM_CPU_NMI    (NUM_CPU_NMI),
+        .NUM_TILE_INT_CH(NUM_TILE_INT_CH),
+        .IRQ_CFG_BASE   (IRQ_CFG_BASE),
+        .TRACE_EN       (0),
+        .SVC_EN         (0)
+    ) dut_up (
+        .clk        (clk),
+        .rst_n      (rst_n),
+        .addr       (addr),
+        .iorq_n     (iorq_n),
+        .mreq_n     (mreq_n),
+        .r_w_       (r_w_),
+        .irq_vec_cycle(irq_vec_cycleu),
+        .irq_ack    (irq_acku),
+        .ready_n    (ready_nu),
+        .io_r_w_    (io_r_w_u),
+        .data_oe_n  (),
+        .data_dir   (),
+        .ff_oe_n    (),
+        .post_le    (),
+        .post_oe_n  (),
+        .post_addr  (),
+        .addr_oe_n  (),
+        .cs_n       (cs_nu),
+        .bank_cs_n  (),
+        .mem0_cs_n  (),
+        .mem1_cs_n  (),
+        .cpu_int    (cpu_intu),
+        .cpu_nmi    (),
+        .dev_ready_n({ready_nd, 2'b11}),
+        .tile_int_req({cpu_intd, {(2*NUM_TILE_INT_CH){1'b0}}}),
+        .tile_nmi_req({cpu_nmid[0], 2'b00}),
+        .slot_ack   (slot_acku),
+        .dock_din   (8'h00),
+        .dock_dout  (dock_doutu),
+        .dock_doe   (dock_doeu),
+        .svc_spi_sck (1'b0),
+        .svc_spi_cs_n(1'b1),
+        .svc_spi_mosi(1'b0),
+        .svc_spi_miso(),
+        .svc_mcu_irq (),
+        .cfg_clk    (cfg_clk),
+        .cfg_we     (cfg_weu),
+        .cfg_addr   (cfg_addr),
+        .cfg_wdata  (cfg_wdata),
+        .cfg_re     (cfg_reu),
+        .cfg_rdata  (cfg_rdatau)
+    );
+
+    // Downstream Dock: Host side driven by dut_up's slot 2
+    top #(
+        .ADDR_W         (ADDR_W),
+        .NUM_WIN        (NUM_WIN),
+        .NUM_SLOTS      (NUM_SLOTS),
+        .NUM_CPU_INT    (NUM_CPU_INT),
+        .NUM_CPU_NMI    (NUM_CPU_NMI),
+        .NUM_TILE_INT_CH(NUM_TILE_INT_CH),
+        .IRQ_CFG_BASE   (IRQ_CFG_BASE),
+        .TRACE_EN       (0),
+        .SVC_EN         (0)
+    ) dut_dn (
+        .clk        (clk),
+        .rst_n      (rst_n),
+        .addr       (addr),
+        .iorq_n     (cs_nu[2]),
+        .mreq_n     (1'b1),     // bridge cards do not carry /MREQ
+        .r_w_       (io_r_w_u),
+        .irq_vec_cycle(slot_acku[2]),
+        .irq_ack    (slot_acku[2]),
+        .ready_n    (ready_nd),
+        .io_r_w_    (),
+        .data_oe_n  (),
+        .data_dir   (),
+        .ff_oe_n    (),
+        .post_le    (),
+        .post_oe_n  (),
+        .post_addr  (),
+        .addr_oe_n  (),
+        .cs_n       (cs_nd),
+        .bank_cs_n  (),
+        .mem0_cs_n  (),
+        .mem1_cs_n  (),
+        .cpu_int    (cpu_intd),
+        .cpu_nmi    (cpu_nmid),
+        .dev_ready_n(dev_ready_nd),
+        .tile_int_req(tile_int_reqd),
+        .tile_nmi_req({NUM_SLOTS{1'b0}}),
+        .slot_ack   (slot_ackd),
+        .dock_din   (8'h00),
+        .dock_dout  (dock_doutd),
+        .dock_doe   (dock_doed),
+        .svc_spi_sck (1'b0),
+        .svc_spi_cs_n(1'b1),
+        .svc_spi_mosi(1'b0),
+        .svc_spi_miso(),
+        .svc_mcu_irq (),
+        .cfg_clk    (cfg_clk),
+        .cfg_we     (cfg_wed),
+        .cfg_addr   (cfg_addr),
+        .cfg_wdata  (cfg_wdata),
+        .cfg_re     (1'b0),
+        .cfg_rdata  ()
     );
 
     // Helpers
@@ -102,6 +429,98 @@ module top_integration_tb;
     end
     endtask
 
+    task automatic cfg_write(input [7:0] a, input [7:0] d);
+    begin
+        @(posedge cfg_clk);
+        cfg_addr  <= a;
+        cfg_wdata <= d;
+        cfg_we    <= 1'b1;
+        @(posedge cfg_clk);
+        cfg_we    <= 1'b0;
+    end
+    endtask
+
+    task automatic cfg_read(input [7:0] a, output [7:0] d);
+    begin
+        @(posedge cfg_clk);
+        cfg_addr <= a;
+        cfg_re   <= 1'b1;
+        @(posedge cfg_clk);
+        #1;
+        d = cfg_rdata;
+        cfg_re   <= 1'b0;
+    end
+    endtask
+
+    task automatic cfg_write8(input [7:0] a, input [7:0] d);
+    begin
+        @(posedge cfg_clk);
+        cfg_addr  <= a;
+        cfg_wdata <= d;
+        cfg_we8   <= 1'b1;
+        @(posedge cfg_clk);
+        cfg_we8   <= 1'b0;
+    end
+    endtask
+
+    task automatic cfg_read8(input [7:0] a, output [7:0] d);
+    begin
+        @(posedge cfg_clk);
+        cfg_addr <= a;
+        cfg_re8  <= 1'b1;
+        @(posedge cfg_clk);
+        #1;
+        d = cfg_rdata8;
+        cfg_re8  <= 1'b0;
+    end
+    endtask
+
+    task automatic cfg_readi(input [7:0] a, output [7:0] d);
+    begin
+        @(posedge cfg_clk);
+        cfg_addr <= a;
+        cfg_rei  <= 1'b1;
+        @(posedge cfg_clk);
+        #1;
+        d = cfg_rdatai;
+        cfg_rei  <= 1'b0;
+    end
+    endtask
+
+    task automatic cfg_writeu(input [7:0] a, input [7:0] d);
+    begin
+        @(posedge cfg_clk);
+        cfg_addr  <= a;
+        cfg_wdata <= d;
+        cfg_weu   <= 1'b1;
+        @(posedge cfg_clk);
+        cfg_weu   <= 1'b0;
+    end
+    endtask
+
+    task automatic cfg_writed(input [7:0] a, input [7:0] d);
+    begin
+        @(posedge cfg_clk);
+        cfg_addr  <= a;
+        cfg_wdata <= d;
+        cfg_wed   <= 1'b1;
+        @(posedge cfg_clk);
+        cfg_wed   <= 1'b0;
+    end
+    endtask
+
+    task automatic cfg_readu(input [7:0] a, output [7:0] d);
+    begin
+        @(posedge cfg_clk);
+        cfg_addr <= a;
+        cfg_reu  <= 1'b1;
+        @(posedge cfg_clk);
+        #1;
+        d = cfg_rdatau;
+        cfg_reu  <= 1'b0;
+    end
+    endtask
+
     task automatic io_cycle_expect_slot(input [7:0] a, input int exp_slot);
     begin
         addr    = a;
@@ -125,6 +544,114 @@ module top_integration_tb;
     end
     endtask
 
+    // Plain I/O cycle (no checks), two clocks with /IORQ low.
+    task automatic io_cycle(input [7:0] a, input rd);
+    begin
+        addr = a;
+        r_w_ = rd;
+        @(negedge clk);
+        iorq_n = 1'b0;
+        repeat (2) @(posedge clk);
+        @(negedge clk);
+        iorq_n = 1'b1;
+        repeat (2) @(posedge clk);
+    end
+    endtask
+
+    // Host I/O cycle that waits for /READY; returns the Dock register read
+    // data and leaves the clocks until /READY in host_io_clks (1 = no wait).
+    integer host_io_clks;
+    task automatic host_io(input [7:0] a, input rd, input [7:0] wd, output [7:0] rdat);
+        integer n;
+    begin
+        addr    = a;
+        r_w_    = rd;
+        dock_din = wd;
+        @(negedge clk);
+        iorq_n  = 1'b0;
+        @(posedge clk);
+        n = 0;
+        do begin
+            @(posedge clk);
+            #1;
+            n = n + 1;
+            if (n > 20) $fatal(1, "host_io: no /READY at addr %0h", a);
+        end while (ready_n !== 1'b1);
+        host_io_clks = n;
+        rdat = dock_doe ? dock_dout : 8'hZZ;
+        @(negedge clk);
+        iorq_n = 1'b1;
+        repeat (2) @(posedge clk);
+    end
+    endtask
+
+    // host_io against dut_up: bridge_io_clks counts its /READY-low clocks,
+    // bridge_dn_clks the downstream Dock's, bridge_cs_seen the downstream
+    // slots that got /CS. vec drives irq_vec_cycle/irq_ack for the cycle.
+    integer bridge_io_clks;
+    integer bridge_dn_clks;
+    reg [NUM_SLOTS-1:0] bridge_cs_seen;
+    task automatic bridge_io(input [7:0] a, input rd, input vec, output [7:0] rdat);
+        integer n;
+    begin
+        addr    = a;
+        r_w_    = rd;
+        @(negedge clk);
+        irq_vec_cycleu = vec;
+        irq_acku       = vec;
+        iorq_n  = 1'b0;
+        bridge_dn_clks = 0;
+        bridge_cs_seen = '0;
+        @(posedge clk);
+        n = 0;
+        rdat = 8'hZZ;
+        do begin
+            @(posedge clk);
+            #1;
+            n = n + 1;
+            if (ready_nd === 1'b0) bridge_dn_clks = bridge_dn_clks + 1;
+            bridge_cs_seen = bridge_cs_seen | ~cs_nd;
+            if (dock_doeu) rdat = dock_doutu;
+            else if (dock_doed) rdat = dock_doutd;
+            if (n > 40) $fatal(1, "bridge_io: no /READY at addr %0h", a);
+        end while (ready_nu !== 1'b1);
+        bridge_io_clks = n;
+        @(negedge clk);
+        iorq_n = 1'b1;
+        irq_vec_cycleu = 1'b0;
+        irq_acku       = 1'b0;
+        repeat (3) @(posedge clk);
+    end
+    endtask
+
+    // Edges on the Bank pins while mem_watch is set: one per pin that falls
+    // for the cycle, none while addr and /MREQ hold (bank section).
+    reg     mem_watch = 1'b0;
+    integer mem_ev_bank = 0;
+    integer mem_ev_m0   = 0;
+    integer mem_ev_m1   = 0;
+    always @(bank_cs_n) if (mem_watch) mem_ev_bank = mem_ev_bank + 1;
+    always @(mem0_cs_n) if (mem_watch) mem_ev_m0   = mem_ev_m0 + 1;
+    always @(mem1_cs_n) if (mem_watch) mem_ev_m1   = mem_ev_m1 + 1;
+
+    // One SPI mode-0 byte (SCK = clk/10), MSB first.
+    task automatic spi_byte(input [7:0] tx, output [7:0] rx);
+        integer i;
+    begin
+        for (i = 7; i >= 0; i = i - 1) begin
+            svc_spi_mosi = tx[i];
+            #50;
+            rx[i] = svc_spi_miso;
+            svc_spi_sck = 1'b1;
+            #50;
+            svc_spi_sck = 1'b0;
+        end
+    end
+    endtask
+
+    task automatic spi_begin; begin svc_spi_cs_n = 1'b0; #100; end endtask
+    task automatic spi_end;   begin #100; svc_spi_cs_n = 1'b1; #100; end endtask
+
     // Clocks
     always #5 clk = ~clk;
     always #5 cfg_clk = ~cfg_clk;
@@ -140,6 +667,7 @@ module top_integration_tb;
         rst_n        = 0;
         addr         = 0;
         iorq_n       = 1'b1;
+        mreq_n       = 1'b1;
         r_w_         = 1'b1;
         irq_vec_cycle= 1'b0;
         irq_ack      = 1'b0;
@@ -149,6 +677,24 @@ module top_integration_tb;
         cfg_we       = 1'b0;
         cfg_addr     = 8'h00;
         cfg_wdata    = 8'h00;
+        cfg_re       = 1'b0;
+        cfg_we8      = 1'b0;
+        cfg_re8      = 1'b0;
+        cfg_rei      = 1'b0;
+        tile_int_reqi= '0;
+        cfg_weu      = 1'b0;
+        cfg_wed      = 1'b0;
+        cfg_reu      = 1'b0;
+        irq_vec_cycleu = 1'b0;
+        irq_acku     = 1'b0;
+        dev_ready_nd = {NUM_SLOTS{1'b1}};
+        tile_int_reqd= '0;
+        dev_ready_n8 = {NUM_SLOTS8{1'b1}};
+        tile_int_req8= '0;
+        dock_din      = 8'h00;
+        svc_spi_sck  = 1'b0;
+        svc_spi_cs_n = 1'b1;
+        svc_spi_mosi = 1'b0;
 
         // Release reset after a few clocks.
         repeat (4) @(posedge clk);
@@ -178,6 +724,486 @@ module top_integration_tb;
             $fatal(1, "cpu_int did not clear: cpu_int=%b", cpu_int);
         end
 
+        // Capability block and IRQ readback on the default build.
+        begin : caps
+            reg [7:0] d;
+            cfg_read(8'h00, d); if (d !== 8'h55) $fatal(1, "cap magic[0]=%h", d);
+            cfg_read(8'h01, d); if (d !== 8'h44) $fatal(1, "cap magic[1]=%h", d);
+            cfg_read(8'h06, d); if (d !== NUM_SLOTS) $fatal(1, "cap NUM_SLOTS=%0d", d);
+            cfg_read(8'h07, d); if (d !== NUM_TILE_INT_CH) $fatal(1, "cap NUM_TILE_INT_CH=%0d", d);
+            cfg_read(8'h0A, d); if (d !== IRQ_CFG_BASE) $fatal(1, "cap IRQ_CFG_BASE=%h", d);
+            cfg_read(8'h0E, d); if (d !== 8'h08) $fatal(1, "cap SLOT_OFF=%h", d);
+            cfg_read(8'h11, d); if (d !== 8'h09) $fatal(1, "cap IRQ COAL_OFF=%h", d);
+            cfg_read(IRQ_CFG_BASE + int_idx(1,0), d);
+            if (d !== 8'h80) $fatal(1, "IRQ route readback=%h", d);
+            // cfg_rdata shares the CFG_DATA pins with cfg_wdata: released after the read
+            #1;
+            if (cfg_rdata !== 8'hzz) $fatal(1, "cfg_rdata driven with cfg_re low: %h", cfg_rdata);
+        end
+
+        // 8-slot / 4-channel build programmed from its capability block:
+        // window 0 -> slot 7, slot 7 channel 3 -> CPU INT1.
+        begin : scaled
+            reg [7:0] irq_base, num_ch, cfg_bytes, mask_off, slot_off, op_off, d;
+            cfg_read8(8'h06, d);
+            if (d !== NUM_SLOTS8) $fatal(1, "dut8 cap NUM_SLOTS=%0d", d);
+            cfg_read8(8'h07, num_ch);
+            if (num_ch !== NUM_TILE_INT_CH8) $fatal(1, "dut8 cap NUM_TILE_INT_CH=%0d", num_ch);
+            cfg_read8(8'h0A, irq_base);
+            if (irq_base !== IRQ_CFG_BASE8) $fatal(1, "dut8 cap IRQ_CFG_BASE=%h", irq_base);
+            cfg_read8(8'h0B, cfg_bytes);
+            cfg_read8(8'h0D, mask_off);
+            cfg_read8(8'h0E, slot_off);
+            cfg_read8(8'h0F, op_off);
+
+            cfg_write8(8'h00, 8'h70);                 // base[0]
+            cfg_write8(mask_off, 8'hF0);              // mask[0]
+            cfg_write8(slot_off, 8'h07);              // slot[0] = 7
+            cfg_write8(op_off, 8'hFF);                // op[0] = any
+            cfg_write8(irq_base + 7*num_ch + 3, 8'h81); // slot7,ch3 -> INT1
+
+            addr   = 8'h70;
+            r_w_   = 1'b1;
+            @(negedge clk);
+            iorq_n = 1'b0;
+            @(posedge clk);
+            #1;
+            if (cs_n8 !== 8'b0111_1111)
+                $fatal(1, "dut8: slot 7 not selected cs_n8=%b", cs_n8);
+            @(negedge clk);
+            iorq_n = 1'b1;
+
+            tile_int_req8[7*NUM_TILE_INT_CH8 + 3] = 1'b1;
+            repeat (2) @(posedge clk);
+            if (cpu_int8 !== 2'b10)
+                $fatal(1, "dut8: slot7,ch3 not routed to INT1 cpu_int8=%b", cpu_int8);
+            tile_int_req8[7*NUM_TILE_INT_CH8 + 3] = 1'b0;
+            repeat (2) @(posedge clk);
+        end
+
+        // Bus trace: trigger on address 0x10, one post-trigger entry, then freeze.
+        begin : trace
+            reg [7:0] d;
+            reg [7:0] ent [0:2][0:6];
+            integer   e, b;
+            cfg_read(8'h15, d); if (d !== TRACE_CFG_BASE) $fatal(1, "cap TRACE_CFG_BASE=%h", d);
+            cfg_read(8'h17, d); if (d !== 8'd7) $fatal(1, "cap trace entry bytes=%0d", d);
+
+            cfg_write(TRACE_CFG_BASE + 8'h1, 8'h01); // TRIG: address match
+            cfg_write(TRACE_CFG_BASE + 8'h4, 8'h10); // TRIG_ADDR
+            cfg_write(TRACE_CFG_BASE + 8'h8, 8'hFF); // TRIG_MASK
+            cfg_write(TRACE_CFG_BASE + 8'h3, 8'h01); // POST_CNT = 1
+            cfg_write(TRACE_CFG_BASE + 8'h0, 8'h07); // EN | ARM | CLEAR
+            repeat (4) @(posedge clk);
+
+            io_cycle(8'h20, 1'b1); // unmapped read (0xFF fill)
+            io_cycle(8'h10, 1'b1); // trigger: window 0, slot 1
+            io_cycle(8'h11, 1'b0); // post-trigger write
+            io_cycle(8'h12, 1'b1); // after freeze: not recorded
+
+            cfg_read(TRACE_CFG_BASE + 8'h0, d);
+            if (d !== 8'h33) $fatal(1, "trace CTRL status=%h (want EN|ARM|TRIGGERED|FROZEN)", d);
+            cfg_read(TRACE_CFG_BASE + 8'hC, d); if (d !== 8'd3) $fatal(1, "trace WR_PTR=%0d", d);
+            cfg_read(TRACE_CFG_BASE + 8'hF, d); if (d !== 8'd1) $fatal(1, "trace TRIG_IDX=%0d", d);
+
+            cfg_write(TRACE_CFG_BASE + 8'hD, 8'h00); // RD_IDX = 0
+            for (e = 0; e < 3; e = e + 1) begin
+                repeat (4) @(posedge clk); // RAM read port follows RD_IDX
+                for (b = 0; b < 7; b = b + 1) begin
+                    cfg_read(TRACE_CFG_BASE + 8'hE, d);
+                    ent[e][b] = d;
+                end
+            end
+
+            // Entry 0: unmapped read, no wait states
+            if (ent[0][4][4:0] !== 5'b00011 || ent[0][3] !== 8'd0 || ent[0][6] !== 8'h20)
+                $fatal(1, "trace entry 0: flags=%h wait=%0d addr=%h", ent[0][4], ent[0][3], ent[0][6]);
+            // Entry 1: trigger, mapped read of window 0 / slot 1, one wait clock
+            if (ent[1][4] !== 8'h31 || ent[1][5] !== 8'd0 || ent[1][3] !== 8'd1 || ent[1][6] !== 8'h10)
+                $fatal(1, "trace entry 1: flags=%h win=%0d wait=%0d addr=%h",
+                       ent[1][4], ent[1][5], ent[1][3], ent[1][6]);
+            if ({ent[1][2], ent[1][1], ent[1][0]} <= {ent[0][2], ent[0][1], ent[0][0]})
+                $fatal(1, "trace timestamps not increasing");
+            // Entry 2: mapped write to slot 1
+            if (ent[2][4] !== 8'h20 || ent[2][6] !== 8'h11)
+                $fatal(1, "trace entry 2: flags=%h addr=%h", ent[2][4], ent[2][6]);
+        end
+
+        // Dock services slot 0: window 1 (0x30-0x3F) -> slot 0, INT_CH0 -> CPU INT1.
+        begin : services
+            reg [7:0] d, st [0:4];
+            integer   i;
+            cfg_read(8'h18, d); if (d !== 8'h00) $fatal(1, "cap SVC_SLOT=%h", d);
+            dec_cfg_write(8'h01, 8'h30); // base[1]
+            dec_cfg_write(8'h05, 8'hF0); // mask[1]
+            dec_cfg_write(8'h09, 8'h00); // slot[1] = 0 (services)
+            dec_cfg_write(8'h0D, 8'hFF); // op[1] = any
+            irq_cfg_write(int_idx(0,0), 8'h81);
+
+            // Host -> MCU
+            host_io(8'h30, 1'b0, 8'h41, d);          // DATA <- 'A'
+            if (cs_n !== {NUM_SLOTS{1'b1}}) $fatal(1, "services access drove cs_n=%b", cs_n);
+            repeat (2) @(posedge clk);
+            if (svc_mcu_irq !== 1'b1) $fatal(1, "svc_mcu_irq not raised by Host write");
+
+            spi_begin;
+            spi_byte(8'h01, d);                      // STATUS
+            for (i = 0; i < 5; i = i + 1) spi_byte(8'h00, st[i]);
+            spi_end;
+            if (st[0] !== 8'h02 || st[1] !== 8'd1 || st[2] !== 8'd0 || st[3] !== 8'h00 || st[4] !== 8'h02)
+                $fatal(1, "SPI STATUS %h %h %h %h %h", st[0], st[1], st[2], st[3], st[4]);
+
+            spi_begin;
+            spi_byte(8'h02, d);                      // READ
+            spi_byte(8'h01, d);                      // length 1
+            spi_byte(8'h00, d);
+            spi_end;
+            if (d !== 8'h41) $fatal(1, "SPI READ returned %h", d);
+            repeat (2) @(posedge clk);
+            if (svc_mcu_irq !== 1'b0) $fatal(1, "svc_mcu_irq still set after drain");
+
+            // MCU -> Host, with the RX_AVAIL interrupt enabled
+            host_io(8'h32, 1'b0, 8'h01, d);          // IRQ_EN = RX_AVAIL
+            spi_begin;
+            spi_byte(8'h04, d);                      // CTRL: MCU_READY
+            spi_byte(8'h01, d);
+            spi_end;
+            spi_begin;
+            spi_byte(8'h03, d);                      // WRITE
+            spi_byte(8'h5A, d);
+            spi_byte(8'hA5, d);
+            spi_end;
+            repeat (4) @(posedge clk);
+            if (cpu_int !== 2'b10) $fatal(1, "services interrupt not on INT1: cpu_int=%b", cpu_int);
+
+            host_io(8'h31, 1'b1, 8'h00, d);          // STATUS
+            if (d !== 8'h85) $fatal(1, "services STATUS=%h", d);
+            host_io(8'h33, 1'b1, 8'h00, d);          // RX_COUNT
+            if (d !== 8'd2) $fatal(1, "services RX_COUNT=%0d", d);
+            host_io(8'h30, 1'b1, 8'h00, d);
+            if (d !== 8'h5A) $fatal(1, "services DATA[0]=%h", d);
+            host_io(8'h30, 1'b1, 8'h00, d);
+            if (d !== 8'hA5) $fatal(1, "services DATA[1]=%h", d);
+            repeat (4) @(posedge clk);
+            if (cpu_int !== 2'b00) $fatal(1, "services interrupt did not clear: cpu_int=%b", cpu_int);
+
+            // Posted write to DATA, then straight into an unrelated read of
+            // slot 1: the drain must push to DATA (post_addr), not to the
+            // IRQ_EN register the Host's new address 0x12 would pick.
+            dec_cfg_write(8'h09, 8'h40); // slot[1] = 0, POSTED
+            addr     = 8'h30;
+            r_w_     = 1'b0;
+            dock_din = 8'h77;            // the posted-write register drives the Tile bus
+            @(negedge clk);
+            iorq_n = 1'b0;
+            @(posedge clk);
+            #1;
+            if (ready_n !== 1'b1 || post_le !== 1'b1)
+                $fatal(1, "services posted entry: ready_n=%b post_le=%b", ready_n, post_le);
+            @(negedge clk);
+            iorq_n = 1'b1;
+            host_io(8'h12, 1'b1, 8'h77, d);
+            if (post_oe_n !== 1'b1) $fatal(1, "services posted write still draining");
+            dec_cfg_write(8'h09, 8'h00); // slot[1] = 0, not posted
+
+            host_io(8'h32, 1'b1, 8'h00, d);          // IRQ_EN untouched
+            if (d !== 8'h01) $fatal(1, "posted drain hit IRQ_EN=%h", d);
+            spi_begin;
+            spi_byte(8'h02, d);                      // READ
+            spi_byte(8'h01, d);                      // length 1
+            spi_byte(8'h00, d);
+            spi_end;
+            if (d !== 8'h77) $fatal(1, "posted DATA write drained as %h", d);
+        end
+
+        // IRQ status window: window 2 (0x40-0x4F) flagged DOCK.
+        begin : irq_status
+            reg [7:0] d;
+            dec_cfg_write(8'h02, 8'h40); // base[2]
+            dec_cfg_write(8'h06, 8'hF0); // mask[2]
+            dec_cfg_write(8'h0A, 8'h20); // slot[2]: DOCK
+            dec_cfg_write(8'h0E, 8'hFF); // op[2] = any
+            irq_cfg_write(int_idx(1,1), 8'h80);
+
+            host_io(8'h40, 1'b1, 8'h00, d);
+            if (d !== 8'h00) $fatal(1, "CAUSE with nothing pending=%h", d);
+            if (host_io_clks != 1) $fatal(1, "IRQ status read took %0d clocks", host_io_clks);
+
+            tile_int_req[int_idx(1,0)] = 1'b1;
+            tile_int_req[int_idx(1,1)] = 1'b1;
+            repeat (3) @(posedge clk);
+            host_io(8'h40, 1'b1, 8'h00, d);
+            if (d !== 8'h84) $fatal(1, "CAUSE=%h, expected slot1 ch0", d);
+            if (host_io_clks != 1) $fatal(1, "IRQ status read took %0d clocks", host_io_clks);
+            if (cs_n !== {NUM_SLOTS{1'b1}}) $fatal(1, "IRQ status read drove cs_n=%b", cs_n);
+            host_io(8'h44, 1'b1, 8'h00, d);
+            if (d !== 8'h0C) $fatal(1, "INT_PENDING[7:0]=%h", d);
+
+            // Host masks slot1 ch0: slot1 ch1 becomes the active source
+            host_io(8'h48, 1'b0, 8'h04, d);
+            if (host_io_clks != 1) $fatal(1, "IRQ mask write took %0d clocks", host_io_clks);
+            host_io(8'h48, 1'b1, 8'h00, d);
+            if (d !== 8'h04) $fatal(1, "INT_MASK[7:0]=%h", d);
+            host_io(8'h40, 1'b1, 8'h00, d);
+            if (d !== 8'h85) $fatal(1, "CAUSE after mask=%h", d);
+            host_io(8'h44, 1'b1, 8'h00, d);
+            if (d !== 8'h08) $fatal(1, "INT_PENDING[7:0] after mask=%h", d);
+            if (cpu_int !== 2'b01) $fatal(1, "cpu_int after mask=%b", cpu_int);
+
+            tile_int_req[int_idx(1,1)] = 1'b0;
+            repeat (3) @(posedge clk);
+            if (cpu_int !== 2'b00) $fatal(1, "masked route still drives cpu_int=%b", cpu_int);
+            host_io(8'h48, 1'b0, 8'h00, d);
+            repeat (3) @(posedge clk);
+            if (cpu_int !== 2'b01) $fatal(1, "unmasked route not delivered: cpu_int=%b", cpu_int);
+            tile_int_req[int_idx(1,0)] = 1'b0;
+            repeat (3) @(posedge clk);
+            host_io(8'h40, 1'b1, 8'h00, d);
+            if (d !== 8'h00 || cpu_int !== 2'b00) $fatal(1, "CAUSE=%h cpu_int=%b after clear", d, cpu_int);
+
+            // Host keeps /IORQ low between cycles: the next DOCK access holds
+            // /READY low for a clock while the pending write is applied.
+            addr     = 8'h48;
+            r_w_     = 1'b0;
+            dock_din = 8'h02;
+            @(negedge clk);
+            iorq_n   = 1'b0;
+            repeat (2) @(posedge clk);
+            @(negedge clk);
+            addr     = 8'h49;
+            dock_din = 8'h00;
+            #1;
+            if (ready_n !== 1'b0) $fatal(1, "DOCK write over a pending one not stalled");
+            @(posedge clk);
+            #1;
+            if (ready_n !== 1'b1) $fatal(1, "DOCK write stalled after the pending write was applied");
+            @(posedge clk);
+            @(negedge clk);
+            addr     = 8'h48;
+            r_w_     = 1'b1;
+            #1;
+            if (ready_n !== 1'b0) $fatal(1, "DOCK read over a pending write not stalled");
+            @(posedge clk);
+            #1;
+            if (ready_n !== 1'b1 || dock_doe !== 1'b1 || dock_dout !== 8'h02)
+                $fatal(1, "INT_MASK[7:0]=%h after back-to-back writes", dock_dout);
+            @(negedge clk);
+            iorq_n   = 1'b1;
+            repeat (2) @(posedge clk);
+            host_io(8'h48, 1'b0, 8'h00, d);
+        end
+
+        // Baked map: dut_init never sees a config write, yet decodes and routes.
+        begin : baked
+            reg [7:0] d;
+            addr   = 8'h65;
+            r_w_   = 1'b1;
+            @(negedge clk);
+            iorq_n = 1'b0;
+            @(posedge clk);
+            #1;
+            if (cs_ni !== 3'b011)
+                $fatal(1, "baked map: slot 2 not selected cs_ni=%b", cs_ni);
+            @(negedge clk);
+            iorq_n = 1'b1;
+
+            tile_int_reqi[int_idx(2,0)] = 1'b1;
+            repeat (2) @(posedge clk);
+            if (cpu_inti !== 2'b10)
+                $fatal(1, "baked map: slot2,ch0 not routed to INT1 cpu_inti=%b", cpu_inti);
+            tile_int_reqi[int_idx(2,0)] = 1'b0;
+            repeat (2) @(posedge clk);
+
+            cfg_readi(8'h14, d); if (d[6] !== 1'b1) $fatal(1, "baked map: feature bits=%h", d);
+            cfg_readi(8'h1A, d); if (d !== 8'h5B) $fatal(1, "baked map: sum1=%h", d);
+            cfg_readi(8'h1B, d); if (d !== 8'hED) $fatal(1, "baked map: sum2=%h", d);
+
+            addr   = 8'hE7;
+            mreq_n = 1'b0;
+            #1;
+            if (bank_cs_ni !== 1'b0) $fatal(1, "baked map: Bank region not selected");
+            addr   = 8'h65;
+            #1;
+            if (bank_cs_ni !== 1'b1) $fatal(1, "baked map: Bank selected outside its region");
+            mreq_n = 1'b1;
+            cfg_read(8'h14, d);  if (d[6] !== 1'b0) $fatal(1, "dut feature bits=%h", d);
+            cfg_read(8'h1A, d);  if (d !== 8'h00) $fatal(1, "dut sum1=%h", d);
+        end
+
+        // Bridge: dut_up 0x10/F0 -> slot 1, 0x80/80 -> slot 2 BRIDGE, 0x40/F0
+        // DOCK; dut_dn 0x80/F0 -> slot 1, 0x90/F0 DOCK. Unused windows 0xFF/FF.
+        begin : bridge
+            reg [7:0] d, hold;
+            integer   hop;
+            cfg_writeu(8'h00, 8'h10); cfg_writeu(8'h04, 8'hF0); cfg_writeu(8'h08, 8'h01);
+            cfg_writeu(8'h01, 8'h80); cfg_writeu(8'h05, 8'h80); cfg_writeu(8'h09, 8'h12);
+            cfg_writeu(8'h02, 8'h40); cfg_writeu(8'h06, 8'hF0); cfg_writeu(8'h0A, 8'h20);
+            cfg_writeu(8'h03, 8'hFF); cfg_writeu(8'h07, 8'hFF);
+            cfg_writed(8'h00, 8'h80); cfg_writed(8'h04, 8'hF0); cfg_writed(8'h08, 8'h01);
+            cfg_writed(8'h01, 8'h90); cfg_writed(8'h05, 8'hF0); cfg_writed(8'h09, 8'h20);
+            cfg_writed(8'h02, 8'hFF); cfg_writed(8'h06, 8'hFF);
+            cfg_writed(8'h03, 8'hFF); cfg_writed(8'h07, 8'hFF);
+            cfg_writeu(IRQ_CFG_BASE + int_idx(2,0), 8'h81); // bridge ch0 -> INT1
+            cfg_writed(IRQ_CFG_BASE + int_idx(1,0), 8'h80); // Tile ch0 -> INT0
+
+            cfg_readu(8'h14, d); if (d[7] !== 1'b1) $fatal(1, "bridge: feature bits=%h", d);
+            cfg_readu(8'h1C, hold); if (hold !== 8'd3) $fatal(1, "bridge: BRIDGE_HOLD=%0d", hold);
+
+            // Local slot: unchanged single-clock cycle
+            bridge_io(8'h10, 1'b1, 1'b0, d);
+            if (bridge_io_clks != 1) $fatal(1, "bridge: local slot took %0d clocks", bridge_io_clks);
+            // One hop to a ready Tile. The clocks the upstream Dock adds to
+            // the downstream wait are the measured per-hop latency; the cases
+            // below and the model's chain tests (Emu/dock_emu_test.c,
+            // BRIDGE_HOP_CLKS) are held to it.
+            bridge_io(8'h85, 1'b1, 1'b0, d);
+            if (bridge_cs_seen !== 3'b010) $fatal(1, "bridge: downstream cs=%b", bridge_cs_seen);
+            if (bridge_dn_clks != 1)
+                $fatal(1, "bridge: ready Tile took %0d downstream clocks", bridge_dn_clks);
+            hop = bridge_io_clks - bridge_dn_clks;
+            $display("bridge: per-hop latency %0d clocks (BRIDGE_HOLD %0d)", hop, hold);
+            if (hop <= hold)
+                $fatal(1, "bridge: per-hop latency %0d within BRIDGE_HOLD %0d", hop, hold);
+            // Downstream unmapped: no Tile, the hop alone
+            bridge_io(8'hA0, 1'b1, 1'b0, d);
+            if (bridge_cs_seen !== 3'b000 || bridge_io_clks != bridge_dn_clks + hop)
+                $fatal(1, "bridge: unmapped took %0d/%0d clocks, cs=%b", bridge_io_clks, bridge_dn_clks,
+                       bridge_cs_seen);
+            // Busy downstream Tile: upstream waits the downstream time + one hop
+            dev_ready_nd[1] = 1'b0;
+            fork
+                bridge_io(8'h81, 1'b0, 1'b0, d);
+                begin repeat (8) @(posedge clk); @(negedge clk); dev_ready_nd[1] = 1'b1; end
+            join
+            if (bridge_dn_clks < 4 || bridge_io_clks != bridge_dn_clks + hop)
+                $fatal(1, "bridge: busy Tile took %0d/%0d clocks", bridge_io_clks, bridge_dn_clks);
+
+            // Downstream INT arrives on the bridge slot, tagged in CAUSE
+            tile_int_reqd[int_idx(1,0)] = 1'b1;
+            repeat (4) @(posedge clk);
+            if (cpu_intu !== 2'b10) $fatal(1, "bridge: INT not passed through cpu_intu=%b", cpu_intu);
+            bridge_io(8'h40, 1'b1, 1'b0, d);
+            if (d !== 8'hA8) $fatal(1, "bridge: upstream CAUSE=%h", d);
+            bridge_io(8'h90, 1'b1, 1'b0, d);
+            if (d !== 8'h84 || bridge_io_clks != bridge_dn_clks + hop)
+                $fatal(1, "bridge: downstream CAUSE=%h in %0d/%0d clocks", d, bridge_io_clks, bridge_dn_clks);
+
+            // Mode-2 vector fetch: dut_up steers to slot 2, dut_dn to slot 1
+            bridge_io(8'h00, 1'b1, 1'b1, d);
+            if (bridge_cs_seen !== 3'b010 || bridge_io_clks != bridge_dn_clks + hop)
+                $fatal(1, "bridge: vector took %0d/%0d clocks, cs=%b", bridge_io_clks, bridge_dn_clks,
+                       bridge_cs_seen);
+
+            tile_int_reqd[int_idx(1,0)] = 1'b0;
+            repeat (4) @(posedge clk);
+            if (cpu_intu !== 2'b00) $fatal(1, "bridge: INT did not clear cpu_intu=%b", cpu_intu);
+        end
+
+        // Bank memory decode: ROM0 0xE0/32, ROM1 0xC0/16, ROM2 0xD0/16 over
+        // RAM everywhere. Window 0 (0x10/F0 -> slot 1) must stay quiet.
+        begin : bank
+            reg [7:0] mem_off, num_reg;
+            reg [2:0] want; // {bank_cs_n, mem1_cs_n, mem0_cs_n}
+            integer   a;
+            cfg_read(8'h1D, mem_off);
+            cfg_read(8'h1E, num_reg);
+            if (mem_off !== 8'h10 || num_reg !== 8'd4)
+                $fatal(1, "bank: cap region offset=%h count=%0d", mem_off, num_reg);
+            cfg_write(mem_off + 0, 8'hE0); cfg_write(mem_off + 4, 8'hA5); // ROM0
+            cfg_write(mem_off + 1, 8'hC0); cfg_write(mem_off + 5, 8'hC4); // ROM1
+            cfg_write(mem_off + 2, 8'hD0); cfg_write(mem_off + 6, 8'hE4); // ROM2
+            cfg_write(mem_off + 3, 8'h00); cfg_write(mem_off + 7, 8'h88); // RAM
+
+            // Combinational: pins follow /MREQ and addr with no clk edge.
+            @(negedge clk);
+            r_w_   = 1'b1;
+            addr   = 8'h10;
+            mreq_n = 1'b0;
+            #1;
+            if ({bank_cs_n, mem1_cs_n, mem0_cs_n} !== 3'b010)
+                $fatal(1, "bank: RAM pins=%b", {bank_cs_n, mem1_cs_n, mem0_cs_n});
+            addr = 8'hE5;
+            #1;
+            if ({bank_cs_n, mem1_cs_n, mem0_cs_n} !== 3'b001)
+                $fatal(1, "bank: ROM0 pins=%b", {bank_cs_n, mem1_cs_n, mem0_cs_n});
+            addr = 8'hC3;
+            #1;
+            if ({bank_cs_n, mem1_cs_n, mem0_cs_n} !== 3'b000)
+                $fatal(1, "bank: ROM1 pins=%b", {bank_cs_n, mem1_cs_n, mem0_cs_n});
+            addr = 8'hDF;
+            #1;
+            if ({bank_cs_n, mem1_cs_n, mem0_cs_n} !== 3'b011)
+                $fatal(1, "bank: ROM2 pins=%b", {bank_cs_n, mem1_cs_n, mem0_cs_n});
+
+            // Chip-select windows: every address, one memory cycle each with
+            // addr set up before /MREQ falls. Each pin that goes low does so
+            // exactly once and returns high once /MREQ rises.
+            mreq_n = 1'b1;
+            for (a = 0; a < 256; a = a + 1) begin
+                want = (a >= 8'hE0) ? 3'b001 :  // ROM0 0xE0-0xFF
+                       (a >= 8'hD0) ? 3'b011 :  // ROM2 0xD0-0xDF
+                       (a >= 8'hC0) ? 3'b000 :  // ROM1 0xC0-0xCF
+                                      3'b010;   // RAM
+                addr = a;
+                #5;
+                if ({bank_cs_n, mem1_cs_n, mem0_cs_n} !== 3'b111)
+                    $fatal(1, "bank: %h selected before /MREQ", a[7:0]);
+                mem_ev_bank = 0;
+                mem_ev_m0   = 0;
+                mem_ev_m1   = 0;
+                mem_watch   = 1'b1;
+                mreq_n      = 1'b0;
+                #20;
+                if ({bank_cs_n, mem1_cs_n, mem0_cs_n} !== want ||
+                    mem_ev_bank != 1 || mem_ev_m1 != !want[1] || mem_ev_m0 != !want[0])
+                    $fatal(1, "bank: %h pins=%b want %b, edges bank=%0d mem1=%0d mem0=%0d",
+                           a[7:0], {bank_cs_n, mem1_cs_n, mem0_cs_n}, want,
+                           mem_ev_bank, mem_ev_m1, mem_ev_m0);
+                mreq_n = 1'b1;
+                #5;
+                if ({bank_cs_n, mem1_cs_n, mem0_cs_n} !== 3'b111 || mem_ev_bank != 2 ||
+                    mem_ev_m1 != 2 * !want[1] || mem_ev_m0 != 2 * !want[0])
+                    $fatal(1, "bank: %h release pins=%b, edges bank=%0d mem1=%0d mem0=%0d",
+                           a[7:0], {bank_cs_n, mem1_cs_n, mem0_cs_n},
+                           mem_ev_bank, mem_ev_m1, mem_ev_m0);
+                mem_watch = 1'b0;
+            end
+            mreq_n = 1'b0;
+
+            // The I/O path stays idle through a held memory cycle.
+            addr = 8'h10;
+            repeat (4) begin
+                @(posedge clk);
+                #1;
+                if (ready_n !== 1'b1 || cs_n !== 3'b111 || bank_cs_n !== 1'b0)
+                    $fatal(1, "bank: memory cycle ready_n=%b cs_n=%b bank_cs_n=%b",
+                           ready_n, cs_n, bank_cs_n);
+            end
+
+            // Only /MREQ=0 with /IORQ=1 selects the Bank.
+            iorq_n = 1'b0;
+            #1;
+            if ({bank_cs_n, mem1_cs_n, mem0_cs_n} !== 3'b111)
+                $fatal(1, "bank: selected with /IORQ low pins=%b", {bank_cs_n, mem1_cs_n, mem0_cs_n});
+            @(negedge clk);
+            iorq_n = 1'b1;
+            mreq_n = 1'b1;
+            #1;
+            if ({bank_cs_n, mem1_cs_n, mem0_cs_n} !== 3'b111)
+                $fatal(1, "bank: selected without /MREQ pins=%b", {bank_cs_n, mem1_cs_n, mem0_cs_n});
+            repeat (4) @(posedge clk);
+
+            // Disabled region: the RAM hole no longer selects the Bank.
+            cfg_write(mem_off + 7, 8'h08);
+            mreq_n = 1'b0;
+            #1;
+            if (bank_cs_n !== 1'b1) $fatal(1, "bank: disabled region selected");
+            addr = 8'hE0;
+            #1;
+            if (bank_cs_n !== 1'b0 || mem0_cs_n !== 1'b1) $fatal(1, "bank: ROM0 lost");
+            mreq_n = 1'b1;
+        end
+
         $display("top_integration_tb passed.");
         $finish;
     end
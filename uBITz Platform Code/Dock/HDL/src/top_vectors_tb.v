@@ -0,0 +1,207 @@
+`timescale 1ns/1ps
+
+// Replays top_vectors.hex, the shared pin vectors written by the software
+// model (Emu/dock_emu_test --record, replayed there by ctest), through top:
+// - Applies the config-bus writes of the file with cfg_clk alone (clk held),
+//   matching the model, where config writes take effect at once.
+// - Per step, drives the Host, Tile /READY, INT/NMI request and dock_din
+//   pins before a clk rising edge and compares every Host/Tile-side output
+//   after it with the recorded values.
+// Same build as top_integration_tb's dut; bus trace and services slot off
+// (the model has neither). Override the file with +vectors=<path>.
+module top_vectors_tb;
+    localparam [7:0] IRQ_CFG_BASE = 8'hC0;
+
+    localparam int ADDR_W          = 8;
+    localparam int NUM_WIN         = 4;
+    localparam int NUM_SLOTS       = 3;
+    localparam int NUM_CPU_INT     = 2;
+    localparam int NUM_CPU_NMI     = 1;
+    localparam int NUM_TILE_INT_CH = 2;
+    localparam int MAX_VEC         = 4096;
+
+    reg                          clk;
+    reg                          cfg_clk;
+    reg                          rst_n;
+    reg  [ADDR_W-1:0]            addr;
+    reg                          iorq_n;
+    reg                          mreq_n;
+    reg                          r_w_;
+    reg                          irq_vec_cycle;
+    reg                          irq_ack;
+    reg  [NUM_SLOTS-1:0]         dev_ready_n;
+    reg  [NUM_SLOTS*NUM_TILE_INT_CH-1:0] tile_int_req;
+    reg  [NUM_SLOTS-1:0]         tile_nmi_req;
+    reg  [7:0]                   dock_din;
+    reg                          cfg_we;
+    reg  [7:0]                   cfg_addr;
+    reg  [7:0]                   cfg_wdata;
+
+    wire                         ready_n;
+    wire                         io_r_w_;
+    wire                         data_oe_n;
+    wire                         data_dir;
+    wire                         ff_oe_n;
+    wire                         post_le;
+    wire                         post_oe_n;
+    wire [ADDR_W-1:0]            post_addr;
+    wire                         addr_oe_n;
+    wire [NUM_SLOTS-1:0]         cs_n;
+    wire                         bank_cs_n;
+    wire                         mem0_cs_n;
+    wire                         mem1_cs_n;
+    wire [NUM_CPU_INT-1:0]       cpu_int;
+    wire [NUM_CPU_NMI-1:0]       cpu_nmi;
+    wire [NUM_SLOTS-1:0]         slot_ack;
+    wire [7:0]                   dock_dout;
+    wire                         dock_doe;
+    wire [7:0]                   cfg_rdata;
+
+    top #(
+        .ADDR_W         (ADDR_W),
+        .NUM_WIN        (NUM_WIN),
+        .NUM_SLOTS      (NUM_SLOTS),
+        .NUM_CPU_INT    (NUM_CPU_INT),
+        .NUM_CPU_NMI    (NUM_CPU_NMI),
+        .NUM_TILE_INT_CH(NUM_TILE_INT_CH),
+        .IRQ_CFG_BASE   (IRQ_CFG_BASE),
+        .TRACE_EN       (0),
+        .SVC_EN         (0)
+    ) dut (
+        .clk        (clk),
+        .rst_n      (rst_n),
+        .addr       (addr),
+        .iorq_n     (iorq_n),
+        .mreq_n     (mreq_n),
+        .r_w_       (r_w_),
+        .irq_vec_cycle(irq_vec_cycle),
+        .irq_ack    (irq_ack),
+        .ready_n    (ready_n),
+        .io_r_w_    (io_r_w_),
+        .data_oe_n  (data_oe_n),
+        .data_dir   (data_dir),
+        .ff_oe_n    (ff_oe_n),
+        .post_le    (post_le),
+        .post_oe_n  (post_oe_n),
+        .post_addr  (post_addr),
+        .addr_oe_n  (addr_oe_n),
+        .cs_n       (cs_n),
+        .bank_cs_n  (bank_cs_n),
+        .mem0_cs_n  (mem0_cs_n),
+        .mem1_cs_n  (mem1_cs_n),
+        .cpu_int    (cpu_int),
+        .cpu_nmi    (cpu_nmi),
+        .dev_ready_n(dev_ready_n),
+        .tile_int_req(tile_int_req),
+        .tile_nmi_req(tile_nmi_req),
+        .slot_ack   (slot_ack),
+        .dock_din   (dock_din),
+        .dock_dout  (dock_dout),
+        .dock_doe   (dock_doe),
+        .svc_spi_sck (1'b0),
+        .svc_spi_cs_n(1'b1),
+        .svc_spi_mosi(1'b0),
+        .svc_spi_miso(),
+        .svc_mcu_irq (),
+        .cfg_clk    (cfg_clk),
+        .cfg_we     (cfg_we),
+        .cfg_addr   (cfg_addr),
+        .cfg_wdata  (cfg_wdata),
+        .cfg_re     (1'b0),
+        .cfg_rdata  (cfg_rdata)
+    );
+
+    // Record layout: byte k at vec[i][127-8*k -: 8] (see Emu/dock_emu_test.c).
+    reg  [127:0] vec [0:MAX_VEC-1];
+    wire [55:0]  got = {ready_n, io_r_w_, data_oe_n, data_dir, ff_oe_n, post_le, post_oe_n, addr_oe_n,
+                        5'b0, cs_n,
+                        3'b0, cpu_nmi, 2'b0, cpu_int,
+                        5'b0, slot_ack,
+                        4'b0, dock_doe, mem1_cs_n, mem0_cs_n, bank_cs_n,
+                        dock_dout,
+                        post_addr};
+
+    task automatic clk_edge;
+    begin
+        #5 clk = 1'b1;
+        #1;
+    end
+    endtask
+
+    task automatic clk_low;
+    begin
+        #4 clk = 1'b0;
+    end
+    endtask
+
+    string  path;
+    integer i;
+    integer steps;
+
+    initial begin
+        if (!$value$plusargs("vectors=%s", path))
+            path = "top_vectors.hex";
+        for (i = 0; i < MAX_VEC; i = i + 1)
+            vec[i] = 'x;
+        $readmemh(path, vec);
+
+        clk           = 0;
+        cfg_clk       = 0;
+        rst_n         = 0;
+        addr          = 0;
+        iorq_n        = 1'b1;
+        mreq_n        = 1'b1;
+        r_w_          = 1'b1;
+        irq_vec_cycle = 1'b0;
+        irq_ack       = 1'b0;
+        dev_ready_n   = {NUM_SLOTS{1'b1}};
+        tile_int_req  = '0;
+        tile_nmi_req  = '0;
+        dock_din      = 8'h00;
+        cfg_we        = 1'b0;
+        cfg_addr      = 8'h00;
+        cfg_wdata     = 8'h00;
+
+        // Reset, then the four idle clocks the model's init runs
+        repeat (4) begin clk_edge; clk_low; end
+        rst_n = 1'b1;
+        repeat (4) begin clk_edge; clk_low; end
+
+        steps = 0;
+        for (i = 0; i < MAX_VEC; i = i + 1) begin
+            if (^vec[i][127:120] === 1'bx)
+                $fatal(1, "vectors: no end record in %0s after %0d records", path, i);
+            if (vec[i][127:120] == 8'hFF)
+                break;
+            if (vec[i][127:120] == 8'h01) begin
+                cfg_addr  = vec[i][15:8];
+                cfg_wdata = vec[i][7:0];
+                cfg_we    = 1'b1;
+                #1 cfg_clk = 1'b1;
+                #1 cfg_clk = 1'b0;
+                cfg_we    = 1'b0;
+                #1;
+            end else begin
+                addr          = vec[i][119:112];
+                iorq_n        = vec[i][104];
+                mreq_n        = vec[i][105];
+                r_w_          = vec[i][106];
+                irq_vec_cycle = vec[i][107];
+                irq_ack       = vec[i][108];
+                dev_ready_n   = vec[i][96 +: NUM_SLOTS];
+                tile_int_req  = vec[i][88 +: NUM_SLOTS*NUM_TILE_INT_CH];
+                tile_nmi_req  = vec[i][80 +: NUM_SLOTS];
+                dock_din      = vec[i][79:72];
+                clk_edge;
+                if (got !== vec[i][63:8])
+                    $fatal(1, "vectors: step %0d (record %0d) got %h expected %h",
+                           steps, i, got, vec[i][63:8]);
+                steps = steps + 1;
+                clk_low;
+            end
+        end
+
+        $display("top_vectors_tb passed (%0d steps).", steps);
+        $finish;
+    end
+endmodule
@@ -1,11 +1,20 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include <string.h>
+#include "ubitz_chain.h"
 #include "ubitz_cpld_cfg.h"
+#include "ubitz_dock_svc.h"
 #include "ubitz_enumerator.h"
+#include "ubitz_fpga.h"
 #include "ubitz_monitor.h"
 
 // Minimal entry point: reset snapshot and start UART monitor on core 1.
 void app_main(void) {
+    if (ubitz_chain_is_downstream()) {
+        // Chained Dock: the head enumerates and sends this Dock its map.
+        ubitz_chain_link_serve();
+    }
+
     // Hold /RESET low during enumeration to keep platform quiescent.
     ubitz_reset_init();
     ubitz_reset_assert();
@@ -13,25 +22,51 @@ void app_main(void) {
     ubitz_snapshot_reset();
     ubitz_cpu_desc_t cpu = {0};
     ubitz_bank_desc_t bank = {0};
-    ubitz_dev_desc_t tiles[UBITZ_MAX_TILES] = {0};
-    uint8_t slots[UBITZ_MAX_TILES] = {0};
+    static ubitz_dev_desc_t tiles[UBITZ_MAX_TILES * UBITZ_MAX_HOPS];
+    uint8_t slots[UBITZ_MAX_TILES * UBITZ_MAX_HOPS] = {0};
     ubitz_decode_binding_t wins[UBITZ_MAX_WINDOWS] = {0};
     ubitz_irq_binding_t irqs[UBITZ_MAX_IRQ_ROUTES] = {0};
-    int tile_count = 0, win_count = 0, irq_count = 0;
+    ubitz_cpu_memmap_t memmap;
+    ubitz_mem_binding_t mems[UBITZ_MAX_MEM_REGIONS] = {0};
+    // Chain: Dock layouts and bridge slots per hop; the head's share of the map.
+    static ubitz_cpld_caps_t hop_caps[UBITZ_MAX_HOPS];
+    uint8_t bridge_slot[UBITZ_MAX_HOPS];
+    ubitz_decode_binding_t local_wins[UBITZ_MAX_WINDOWS] = {0};
+    ubitz_irq_binding_t local_irqs[UBITZ_MAX_IRQ_ROUTES] = {0};
+    int tile_count = 0, win_count = 0, irq_count = 0, mem_count = 0;
+    int local_win_count = 0, local_irq_count = 0;
+    int hops = 1;
+    bool chained = false;
     bool win_collision = false;
     bool irq_duplicate = false;
+    bool baked_live = false;
 
     if (ubitz_i2c_init() != ESP_OK) {
         ubitz_snapshot_set_failure(UBITZ_ENUM_I2C_ERROR);
         goto done;
     }
+    // A segment mux means a Dock chain; probing also parks it on the head's bus.
+    chained = ubitz_chain_probe() == ESP_OK;
+
+    // The CPU descriptor picks the iCE40 bitstream variant, so read it first.
+    esp_err_t err = ubitz_read_cpu_desc(&cpu);
+    bool cpu_ok = (err == ESP_OK) && ubitz_validate_cpu_desc(&cpu);
+    if (ubitz_fpga_configure(cpu_ok ? &cpu : NULL) != ESP_OK) {
+        ubitz_snapshot_set_failure(UBITZ_ENUM_FPGA_CONFIG_FAIL);
+        goto done;
+    }
     if (ubitz_cpld_cfg_init() != ESP_OK) {
         ubitz_snapshot_set_failure(UBITZ_ENUM_UNKNOWN_FAIL);
         goto done;
     }
+    ubitz_svc_init();
+    if (ubitz_cpld_get_caps()->features & UBITZ_CAP_FEAT_CFG_INIT) {
+        // Baked power-on map: let the Host boot on it now, confirm it below.
+        ubitz_reset_release();
+        baked_live = true;
+    }
 
-    esp_err_t err = ubitz_read_cpu_desc(&cpu);
-    if (err != ESP_OK || !ubitz_validate_cpu_desc(&cpu)) {
+    if (!cpu_ok) {
         ubitz_snapshot_set_failure(err == ESP_OK ? UBITZ_ENUM_CPU_DESC_BAD : UBITZ_ENUM_I2C_ERROR);
         goto done;
     }
@@ -49,22 +84,62 @@ void app_main(void) {
         ubitz_snapshot_set_failure(UBITZ_ENUM_BANK_DESC_BAD);
         goto done;
     }
+    // Bank regions: the CPU card's memory map if it carries one, else the
+    // default layout from the Bank's RAM/ROM widths. Head Dock only.
+    bool have_memmap = ubitz_read_cpu_memmap(&memmap) == ESP_OK;
+    if (!ubitz_build_mem_map(&cpu, have_memmap ? &memmap : NULL, &bank, mems, &mem_count)) {
+        ubitz_snapshot_set_failure(UBITZ_ENUM_MEM_MAP_BAD);
+        goto done;
+    }
 
-    for (int slot = 0; slot < UBITZ_MAX_TILES; ++slot) {
-        esp_err_t dev_err = ubitz_read_dev_desc(UBITZ_TILE_BASE_ADDR + slot, &tiles[tile_count]);
-        if (dev_err == ESP_OK) {
-            for (int inst = 0; inst < 7; ++inst) {
-                if (tiles[tile_count].inst[inst].function != 0x00 &&
-                    tiles[tile_count].inst[inst].data_bus_width > cpu.data_bus_width) {
-                    ubitz_snapshot_set_failure(UBITZ_ENUM_DEV_WIDTH_INCOMPAT);
-                    goto done;
-                }
-            }
-            slots[tile_count++] = slot;
-        } else if (dev_err != ESP_FAIL) {
+    // Walk the chain: a bridge card in a slot adds the Dock behind it
+    // (one per Dock), whose segment is then scanned the same way.
+    hop_caps[0] = *ubitz_cpld_get_caps();
+    memset(bridge_slot, UBITZ_NO_BRIDGE, sizeof(bridge_slot));
+    for (int hop = 0; hop < hops; ++hop) {
+        if (hop > 0 && ubitz_chain_read_caps(hop, &hop_caps[hop]) != ESP_OK) {
+            ubitz_snapshot_set_failure(UBITZ_ENUM_CHAIN_LINK_FAIL);
+            goto done;
+        }
+        if (chained && ubitz_chain_select(hop) != ESP_OK) {
             ubitz_snapshot_set_failure(UBITZ_ENUM_I2C_ERROR);
             goto done;
         }
+        const int dock_slots = hop_caps[hop].num_slots;
+        for (int slot = 0; slot < UBITZ_MAX_TILES && slot < dock_slots; ++slot) {
+            if (hop == 0 && ubitz_svc_present() && slot == ubitz_svc_slot()) {
+                // Dock services slot has no EEPROM: describe it locally.
+                bool routed = false;
+                for (int i = 0; i < 16; ++i) {
+                    routed |= cpu.introute[i].function == UBITZ_SVC_FUNCTION;
+                }
+                ubitz_svc_fill_desc(&tiles[tile_count], routed);
+                slots[tile_count++] = slot;
+                continue;
+            }
+            esp_err_t dev_err = ubitz_read_dev_desc(UBITZ_TILE_BASE_ADDR + slot, &tiles[tile_count]);
+            if (dev_err == ESP_OK) {
+                for (int inst = 0; inst < 7; ++inst) {
+                    if (tiles[tile_count].inst[inst].function != 0x00 &&
+                        tiles[tile_count].inst[inst].data_bus_width > cpu.data_bus_width) {
+                        ubitz_snapshot_set_failure(UBITZ_ENUM_DEV_WIDTH_INCOMPAT);
+                        goto done;
+                    }
+                }
+                slots[tile_count++] = UBITZ_CHAIN_SLOT(hop, slot);
+            } else if (dev_err == ESP_FAIL && chained && ubitz_is_bridge_desc(&tiles[tile_count]) &&
+                       hops == hop + 1 && hops < UBITZ_MAX_HOPS &&
+                       (hop_caps[hop].features & UBITZ_CAP_FEAT_BRIDGE)) {
+                bridge_slot[hop] = (uint8_t)slot;
+                hops = hop + 2;
+            } else if (dev_err != ESP_FAIL) {
+                ubitz_snapshot_set_failure(UBITZ_ENUM_I2C_ERROR);
+                goto done;
+            }
+        }
+    }
+    if (chained) {
+        ubitz_chain_select(0);
     }
 
     for (int i = 0; i < 16 && !win_collision; ++i) {
@@ -89,7 +164,14 @@ void app_main(void) {
         goto done;
     }
 
-    if (!ubitz_build_window_map(&cpu, tiles, slots, tile_count, wins, &win_count)) {
+    // Range windows the map may use: the fewest of any Dock in the chain.
+    int max_range = hop_caps[0].num_range_win;
+    for (int hop = 1; hop < hops; ++hop) {
+        if (hop_caps[hop].num_range_win < max_range) {
+            max_range = hop_caps[hop].num_range_win;
+        }
+    }
+    if (!ubitz_build_window_map(&cpu, tiles, slots, tile_count, max_range, wins, &win_count)) {
         ubitz_snapshot_set_failure(UBITZ_ENUM_REQUIRED_WINDOW_MISSING);
         goto done;
     }
@@ -127,13 +209,63 @@ void app_main(void) {
         goto done;
     }
 
-    ubitz_cpld_program_decoder(wins, win_count);
-    ubitz_cpld_program_irq_router(irqs, irq_count);
-    ubitz_snapshot_publish(&cpu, &bank, tiles, tile_count, wins, win_count, irqs, irq_count);
+    // Each Dock gets its share of the chain map: its own slots plus BRIDGE
+    // windows and pass-through routes for the Docks behind it. The head's
+    // share replaces the chain map below.
+    if (hops > 1) {
+        uint8_t pass_ch = UBITZ_MAX_INT_CH;
+        for (int hop = 0; hop < hops - 1; ++hop) {
+            if (hop_caps[hop].num_int_ch < pass_ch) {
+                pass_ch = hop_caps[hop].num_int_ch;
+            }
+        }
+        for (int hop = hops - 1; hop >= 0; --hop) {
+            if (!ubitz_chain_split_map(hop, bridge_slot, pass_ch, wins, win_count, irqs, irq_count,
+                                       local_wins, &local_win_count,
+                                       local_irqs, &local_irq_count)) {
+                ubitz_snapshot_set_failure(UBITZ_ENUM_CHAIN_MAP_FAIL);
+                goto done;
+            }
+            if (hop == 0) {
+                break;
+            }
+            if (!ubitz_cpld_map_fits(&hop_caps[hop], local_wins, local_win_count)) {
+                ubitz_snapshot_set_failure(UBITZ_ENUM_DECODER_FULL);
+                goto done;
+            }
+            if (ubitz_chain_program(hop, &hop_caps[hop], local_wins, local_win_count,
+                                    local_irqs, local_irq_count) != ESP_OK) {
+                ubitz_snapshot_set_failure(UBITZ_ENUM_CHAIN_LINK_FAIL);
+                goto done;
+            }
+        }
+        ubitz_chain_select(0);
+        memcpy(wins, local_wins, sizeof(wins));
+        memcpy(irqs, local_irqs, sizeof(irqs));
+        win_count = local_win_count;
+        irq_count = local_irq_count;
+    }
+
+    if (!ubitz_cpld_map_fits(ubitz_cpld_get_caps(), wins, win_count)) {
+        ubitz_snapshot_set_failure(UBITZ_ENUM_DECODER_FULL);
+        goto done;
+    }
+    if (!baked_live) {
+        ubitz_cpld_program_decoder(wins, win_count);
+        ubitz_cpld_program_irq_router(irqs, irq_count);
+        ubitz_cpld_program_mem(mems, mem_count);
+    } else if (!ubitz_cpld_map_matches_baked(wins, win_count, irqs, irq_count, mems, mem_count)) {
+        // Enumerated map differs from the baked one: restart the Host on it.
+        ubitz_reset_assert();
+        ubitz_cpld_program_map(wins, win_count, irqs, irq_count, mems, mem_count);
+    }
+    ubitz_snapshot_publish(&cpu, &bank, tiles, tile_count, wins, win_count, irqs, irq_count,
+                           mems, mem_count);
 
 done:
     ubitz_reset_release();
 
+    ubitz_svc_start(NULL);
     ubitz_monitor_start();
     vTaskDelay(portMAX_DELAY);
 }
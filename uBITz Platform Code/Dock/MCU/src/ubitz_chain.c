@@ -0,0 +1,134 @@
+#include "ubitz_chain.h"
+#include "ubitz_enumerator.h"
+#include "ubitz_fpga.h"
+#include "driver/gpio.h"
+#include "driver/i2c.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+static const char *TAG = "ubitz_chain";
+
+#define LINK_RETRY_MS 50
+
+// Hop 0 is the head's own bus, upstream of the mux: all channels off.
+esp_err_t ubitz_chain_select(int hop) {
+    uint8_t ch = (hop == 0) ? 0x00 : (uint8_t)(1u << (hop - 1));
+    return i2c_master_write_to_device(UBITZ_I2C_PORT, UBITZ_I2C_MUX_ADDR, &ch, 1,
+                                      pdMS_TO_TICKS(50));
+}
+
+esp_err_t ubitz_chain_probe(void) {
+    esp_err_t err = ubitz_chain_select(0);
+    return (err == ESP_OK) ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t ubitz_chain_read_caps(int hop, ubitz_cpld_caps_t *out) {
+    uint8_t raw[UBITZ_CAP_BLOCK_LEN];
+    esp_err_t err = ubitz_chain_select(hop);
+    if (err != ESP_OK) {
+        return err;
+    }
+    // The downstream MCU boots alongside the head: give it time to answer.
+    for (int t = 0; t < UBITZ_LINK_BOOT_MS; t += LINK_RETRY_MS) {
+        err = i2c_master_read_from_device(UBITZ_I2C_PORT, UBITZ_LINK_ADDR, raw, sizeof(raw),
+                                          pdMS_TO_TICKS(50));
+        if (err == ESP_OK) {
+            break;
+        }
+        vTaskDelay(pdMS_TO_TICKS(LINK_RETRY_MS));
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "hop %d: no Dock link", hop);
+        return err;
+    }
+    // The rendered image needs the shared config bus layout.
+    if (!ubitz_cpld_parse_caps(raw, sizeof(raw), out)) {
+        ESP_LOGE(TAG, "hop %d: Dock has no capability block", hop);
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    ESP_LOGI(TAG, "hop %d: %u slots x %u ch, %u windows", hop,
+             out->num_slots, out->num_int_ch, out->num_win);
+    return ESP_OK;
+}
+
+esp_err_t ubitz_chain_program(int hop, const ubitz_cpld_caps_t *caps,
+                              const ubitz_decode_binding_t *wins, int win_count,
+                              const ubitz_irq_binding_t *irqs, int irq_count) {
+    uint8_t msg[1 + 256];
+    msg[0] = UBITZ_LINK_CMD_IMAGE;
+    // Bank cycles stay on the head Dock: bridge cards carry no /MREQ.
+    ubitz_cpld_render_map(caps, msg + 1, wins, win_count, irqs, irq_count, NULL, 0);
+    esp_err_t err = ubitz_chain_select(hop);
+    if (err == ESP_OK) {
+        err = i2c_master_write_to_device(UBITZ_I2C_PORT, UBITZ_LINK_ADDR, msg, sizeof(msg),
+                                         pdMS_TO_TICKS(100));
+    }
+    return err;
+}
+
+bool ubitz_chain_is_downstream(void) {
+    gpio_config_t cfg = {
+        .pin_bit_mask = 1ULL << UBITZ_LINK_ROLE_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_ENABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    gpio_config(&cfg);
+    return gpio_get_level(UBITZ_LINK_ROLE_GPIO) == 0;
+}
+
+// Keep the capability block queued for the head's next read.
+static void link_prime(const uint8_t *raw) {
+    i2c_reset_tx_fifo(UBITZ_I2C_PORT);
+    i2c_slave_write_buffer(UBITZ_I2C_PORT, raw, UBITZ_CAP_BLOCK_LEN, 0);
+}
+
+void ubitz_chain_link_serve(void) {
+    ubitz_reset_init();
+    ubitz_reset_assert();
+    // No CPU descriptor here: the widest variant serves any Host.
+    ubitz_fpga_configure(NULL);
+    if (ubitz_cpld_cfg_init() != ESP_OK) {
+        ESP_LOGE(TAG, "config bus init failed");
+        vTaskDelay(portMAX_DELAY);
+    }
+    uint8_t raw[UBITZ_CAP_BLOCK_LEN];
+    ubitz_cpld_read_cap_block(raw);
+
+    i2c_config_t cfg = {
+        .mode = I2C_MODE_SLAVE,
+        .sda_io_num = UBITZ_I2C_SDA_PIN,
+        .scl_io_num = UBITZ_I2C_SCL_PIN,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .slave.addr_10bit_en = 0,
+        .slave.slave_addr = UBITZ_LINK_ADDR,
+    };
+    ESP_ERROR_CHECK(i2c_param_config(UBITZ_I2C_PORT, &cfg));
+    ESP_ERROR_CHECK(i2c_driver_install(UBITZ_I2C_PORT, cfg.mode, 512, 64, 0));
+    link_prime(raw);
+    ESP_LOGI(TAG, "downstream Dock: waiting for the head");
+
+    static uint8_t img[256];
+    for (;;) {
+        uint8_t cmd;
+        if (i2c_slave_read_buffer(UBITZ_I2C_PORT, &cmd, 1, portMAX_DELAY) != 1) {
+            continue;
+        }
+        if (cmd == UBITZ_LINK_CMD_IMAGE) {
+            int n = i2c_slave_read_buffer(UBITZ_I2C_PORT, img, sizeof(img), pdMS_TO_TICKS(100));
+            if (n == (int)sizeof(img)) {
+                // Tiles restart on the new map, as on the head after a patch.
+                ubitz_reset_assert();
+                ubitz_cpld_program_image(img);
+                ubitz_reset_release();
+                ESP_LOGI(TAG, "map programmed");
+            } else {
+                ESP_LOGE(TAG, "short image (%d bytes)", n);
+            }
+        }
+        link_prime(raw);
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+// Dock chains: Docks behind bridge cards (BRIDGE windows, see
+// HDL/src/DECODER_CONFIGURATION.md section 2.6), enumerated by the head Dock.
+// The head's own EEPROMs sit on its I2C bus upstream of a TCA9548A mux; the
+// bus of the Dock at hop h >= 1 is mux channel h - 1, so slot EEPROM
+// addresses repeat per segment without clashing. The head reads every segment's slot EEPROMs itself, builds
+// one map for the chain and sends each downstream Dock its rendered config
+// image over the Dock link: the downstream MCU (role strap low) is an I2C
+// target on its own segment that hands out its capability block and writes
+// the images it receives into its CPLD.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "ubitz_cpld_cfg.h"
+
+// Dock link commands (head -> downstream MCU, UBITZ_LINK_ADDR). A plain read
+// returns the raw capability block (UBITZ_CAP_BLOCK_LEN bytes).
+#define UBITZ_LINK_CMD_IMAGE   0x01  // + 256-byte config image; programmed, then /RESET released
+#define UBITZ_LINK_BOOT_MS     2000  // how long the head waits for a downstream MCU
+
+// Head side. Probe finds the segment mux (ESP_ERR_NOT_FOUND: single Dock).
+esp_err_t ubitz_chain_probe(void);
+esp_err_t ubitz_chain_select(int hop);
+// Layout of the Dock at hop (>= 1), read over its link.
+esp_err_t ubitz_chain_read_caps(int hop, ubitz_cpld_caps_t *out);
+// Render the Dock's share of a chain map and send it over its link.
+esp_err_t ubitz_chain_program(int hop, const ubitz_cpld_caps_t *caps,
+                              const ubitz_decode_binding_t *wins, int win_count,
+                              const ubitz_irq_binding_t *irqs, int irq_count);
+
+// Downstream side.
+bool      ubitz_chain_is_downstream(void);
+// Serve the Dock link: hold /RESET until the head sends a map. Never returns.
+void      ubitz_chain_link_serve(void);
@@ -1,5 +1,50 @@
 #include "ubitz_cpld_cfg.h"
 #include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include <string.h>
+
+static const char *TAG = "ubitz_cpld";
+
+// Capability block byte addresses (read with cfg_re below IRQ_CFG_BASE)
+enum {
+    CAP_MAGIC0 = 0x00, CAP_MAGIC1, CAP_VERSION, CAP_ADDR_W, CAP_NUM_WIN,
+    CAP_NUM_RANGE_WIN, CAP_NUM_SLOTS, CAP_NUM_INT_CH, CAP_NUM_CPU_INT,
+    CAP_NUM_CPU_NMI, CAP_IRQ_BASE, CAP_CFG_BYTES, CAP_BASE_OFF, CAP_MASK_OFF,
+    CAP_SLOT_OFF, CAP_OP_OFF, CAP_NMI_OFF, CAP_COAL_OFF, CAP_COAL_SNAP,
+    CAP_COAL_TICK_W, CAP_FEATURES, CAP_TRACE_BASE, CAP_TRACE_DEPTH,
+    CAP_TRACE_ENTRY, CAP_SVC_SLOT, CAP_SVC_FIFO_LOG2, CAP_INIT_SUM0, CAP_INIT_SUM1,
+    CAP_BRIDGE_HOLD, CAP_MEM_OFF, CAP_NUM_MEM_REGION,
+};
+
+// Bus trace registers, relative to caps.trace_base
+enum {
+    TRACE_CTRL = 0x0, TRACE_TRIG = 0x1, TRACE_WAIT_THR = 0x2, TRACE_POST_CNT = 0x3,
+    TRACE_ADDR = 0x4, TRACE_MASK = 0x8, TRACE_WR_PTR = 0xC, TRACE_RD_IDX = 0xD,
+    TRACE_DATA = 0xE, TRACE_TRIG_IDX = 0xF,
+};
+#define TRACE_CTRL_EN    0x01
+#define TRACE_CTRL_ARM   0x02
+#define TRACE_CTRL_CLEAR 0x04
+
+// Layout of the pre-capability 5-slot, 2-channel, 16 x 32-bit build. It
+// predates range windows, posted writes and coalescing, so none are claimed.
+static const ubitz_cpld_caps_t legacy_caps = {
+    .present = false, .version = 0, .addr_w = 32, .num_win = 16, .num_range_win = 0,
+    .num_slots = 5, .num_int_ch = 2, .num_cpu_int = 4, .num_cpu_nmi = 2,
+    .irq_base = 0xC0, .cfg_bytes = 4, .base_off = 0x00, .mask_off = 0x40,
+    .slot_off = 0x80, .op_off = 0x90, .nmi_off = 10, .coal_off = 15, .coal_snap = 25,
+    .coal_tick_w = 8, .svc_slot = 0xFF,
+    .features = 0,
+};
+
+static ubitz_cpld_caps_t s_caps;
+
+// While set, dec_write stores into this config-bus image instead of driving
+// the pins, so the programming code doubles as the map renderer. s_lay is
+// the layout being programmed: this Dock's, or a chained Dock's while rendering.
+static uint8_t *s_render;
+static const ubitz_cpld_caps_t *s_lay = &s_caps;
 
 // Helper arrays for address/data bit driving.
 static const gpio_num_t addr_pins[8] = {
@@ -30,6 +75,10 @@ static inline void pulse_clk(void) {
 
 // Decoder write: cfg_we high, latch on cfg_clk edge.
 static void dec_write(uint8_t addr, uint8_t data) {
+    if (s_render) {
+        s_render[addr] = data;
+        return;
+    }
     set_addr(addr);
     set_data(data);
     gpio_set_level(UBITZ_CFG_WE_GPIO, 1);
@@ -37,15 +86,101 @@ static void dec_write(uint8_t addr, uint8_t data) {
     gpio_set_level(UBITZ_CFG_WE_GPIO, 0);
 }
 
-// IRQ router write: cfg_wr_en high, latch on cfg_clk edge.
-static void irq_write(uint8_t addr, uint8_t data) {
-    set_addr(addr);
+// IRQ router write at a router-relative index. Builds with a capability
+// block share cfg_we with the decoder (offset by IRQ_CFG_BASE); older
+// builds strobe the router's own cfg_wr_en.
+static void irq_write(uint8_t idx, uint8_t data) {
+    if (s_lay->present) {
+        dec_write((uint8_t)(s_lay->irq_base + idx), data);
+        return;
+    }
+    set_addr(idx);
     set_data(data);
     gpio_set_level(UBITZ_CFG_WR_GPIO, 1);
     pulse_clk();
     gpio_set_level(UBITZ_CFG_WR_GPIO, 0);
 }
 
+// Config read: data pins turned around, cfg_re high, sample after the edge.
+// The CPLD drives CFG_DATA only while cfg_re is high, so sample before
+// dropping it and take the pins back only once it is low.
+static uint8_t cfg_read(uint8_t addr) {
+    set_addr(addr);
+    for (int i = 0; i < 8; ++i) {
+        gpio_set_direction(data_pins[i], GPIO_MODE_INPUT);
+    }
+    gpio_set_level(UBITZ_CFG_RD_GPIO, 1);
+    pulse_clk();
+    uint8_t d = 0;
+    for (int i = 0; i < 8; ++i) {
+        d |= (uint8_t)(gpio_get_level(data_pins[i]) & 0x1) << i;
+    }
+    gpio_set_level(UBITZ_CFG_RD_GPIO, 0);
+    for (int i = 0; i < 8; ++i) {
+        gpio_set_direction(data_pins[i], GPIO_MODE_OUTPUT);
+    }
+    return d;
+}
+
+static uint8_t irq_read(uint8_t idx) {
+    return cfg_read(s_caps.present ? (uint8_t)(s_caps.irq_base + idx) : idx);
+}
+
+bool ubitz_cpld_parse_caps(const uint8_t *raw, int len, ubitz_cpld_caps_t *c) {
+    if (len < UBITZ_CAP_BLOCK_LEN || raw[CAP_MAGIC0] != 'U' || raw[CAP_MAGIC1] != 'D') {
+        *c = legacy_caps;
+        return false;
+    }
+    memset(c, 0, sizeof(*c));
+    c->present       = true;
+    c->version       = raw[CAP_VERSION];
+    c->addr_w        = raw[CAP_ADDR_W];
+    c->num_win       = raw[CAP_NUM_WIN];
+    c->num_range_win = raw[CAP_NUM_RANGE_WIN];
+    c->num_slots     = raw[CAP_NUM_SLOTS];
+    c->num_int_ch    = raw[CAP_NUM_INT_CH];
+    c->num_cpu_int   = raw[CAP_NUM_CPU_INT];
+    c->num_cpu_nmi   = raw[CAP_NUM_CPU_NMI];
+    c->irq_base      = raw[CAP_IRQ_BASE];
+    c->cfg_bytes     = raw[CAP_CFG_BYTES];
+    c->base_off      = raw[CAP_BASE_OFF];
+    c->mask_off      = raw[CAP_MASK_OFF];
+    c->slot_off      = raw[CAP_SLOT_OFF];
+    c->op_off        = raw[CAP_OP_OFF];
+    c->nmi_off       = raw[CAP_NMI_OFF];
+    c->coal_off      = raw[CAP_COAL_OFF];
+    c->coal_snap     = raw[CAP_COAL_SNAP];
+    c->coal_tick_w   = raw[CAP_COAL_TICK_W];
+    c->features      = raw[CAP_FEATURES];
+    if (c->features & UBITZ_CAP_FEAT_TRACE) {
+        c->trace_base        = raw[CAP_TRACE_BASE];
+        c->trace_depth_log2  = raw[CAP_TRACE_DEPTH];
+        c->trace_entry_bytes = raw[CAP_TRACE_ENTRY];
+    }
+    c->svc_slot = 0xFF;
+    if (c->features & UBITZ_CAP_FEAT_SVC) {
+        c->svc_slot      = raw[CAP_SVC_SLOT];
+        c->svc_fifo_log2 = raw[CAP_SVC_FIFO_LOG2];
+    }
+    if (c->features & UBITZ_CAP_FEAT_CFG_INIT) {
+        c->cfg_init_sum = raw[CAP_INIT_SUM0] | ((uint16_t)raw[CAP_INIT_SUM1] << 8);
+    }
+    if (c->features & UBITZ_CAP_FEAT_BRIDGE) {
+        c->bridge_hold = raw[CAP_BRIDGE_HOLD];
+    }
+    if (raw[CAP_MEM_OFF] != 0) {
+        c->mem_off        = raw[CAP_MEM_OFF];
+        c->num_mem_region = raw[CAP_NUM_MEM_REGION];
+    }
+    return true;
+}
+
+void ubitz_cpld_read_cap_block(uint8_t *raw) {
+    for (int a = 0; a < UBITZ_CAP_BLOCK_LEN; ++a) {
+        raw[a] = cfg_read((uint8_t)a);
+    }
+}
+
 esp_err_t ubitz_cpld_cfg_init(void) {
     gpio_config_t cfg = {
         .mode = GPIO_MODE_OUTPUT,
@@ -71,74 +206,315 @@ esp_err_t ubitz_cpld_cfg_init(void) {
     gpio_set_level(UBITZ_CFG_WE_GPIO, 0);
     gpio_set_level(UBITZ_CFG_WR_GPIO, 0);
     gpio_set_level(UBITZ_CFG_RD_GPIO, 0);
+
+    uint8_t raw[UBITZ_CAP_BLOCK_LEN];
+    ubitz_cpld_read_cap_block(raw);
+    ubitz_cpld_parse_caps(raw, sizeof(raw), &s_caps);
+    ESP_LOGI(TAG, "%s: %u slots x %u ch, %u windows (%u-bit), irq_base=0x%02X",
+             s_caps.present ? "capability block" : "no capability block, legacy layout",
+             s_caps.num_slots, s_caps.num_int_ch, s_caps.num_win, s_caps.addr_w,
+             s_caps.irq_base);
     return ESP_OK;
 }
 
-// Map OpSel to CPLD OP encoding (simplified).
-static uint8_t op_encode(uint8_t opsel) {
-    if (opsel == UBITZ_OP_READ) {
-        return 0x01;
+const ubitz_cpld_caps_t *ubitz_cpld_get_caps(void) {
+    return &s_caps;
+}
+
+// Why window w of a map cannot be programmed on a Dock with layout c, or NULL.
+static const char *window_unfit(const ubitz_cpld_caps_t *c, const ubitz_decode_binding_t *b, int w) {
+    if (w >= c->num_win) {
+        return "is beyond the Dock's windows";
+    }
+    if (b->slot == UBITZ_SLOT_DOCK && !(c->features & UBITZ_CAP_FEAT_DOCK_WIN)) {
+        return "targets the Dock IRQ status window (not in this build)";
+    }
+    if (b->bridge && !(c->features & UBITZ_CAP_FEAT_BRIDGE)) {
+        return "is a BRIDGE window (not in this build)";
     }
-    if (opsel == UBITZ_OP_WRITE) {
-        return 0x00;
+    if (b->type == UBITZ_WIN_RANGE && w >= c->num_range_win) {
+        return "needs a range comparator";
     }
-    return 0xFF; // ANY
+    if ((b->win.flags & UBITZ_WIN_FLAG_POSTED) && !(c->features & UBITZ_CAP_FEAT_POSTED)) {
+        return "is a posted-write window (not in this build)";
+    }
+    return NULL;
+}
+
+bool ubitz_cpld_map_fits(const ubitz_cpld_caps_t *c, const ubitz_decode_binding_t *wins, int count) {
+    for (int w = 0; w < count; ++w) {
+        const char *why = window_unfit(c, &wins[w], w);
+        if (why) {
+            ESP_LOGE(TAG, "window %d %s (build: %u windows, %u range)", w, why,
+                     c->num_win, c->num_range_win);
+            return false;
+        }
+    }
+    return true;
 }
 
 void ubitz_cpld_program_decoder(const ubitz_decode_binding_t *wins, int count) {
-    // BASE region: 0x00-0x3F, MASK region: 0x40-0x7F, SLOT: 0x80-0x8F, OP: 0x90-0x9F
+    // Layout from the capability block (default build: BASE 0x00-0x3F,
+    // MASK 0x40-0x7F, SLOT 0x80-0x8F, OP 0x90-0x9F).
+    // Range windows store LIMIT in the MASK bytes and set SLOT bit 7 (TYPE).
+    // Windows flagged for posted writes set SLOT bit 6 (POSTED); windows bound
+    // to the Dock's own IRQ status window set SLOT bit 5 (DOCK) instead of a slot;
+    // windows to a bridge card set SLOT bit 4 (BRIDGE).
+    const ubitz_cpld_caps_t *c = s_lay;
+    if (count > c->num_win) {
+        ESP_LOGE(TAG, "%d windows, Dock build has %u; extra windows dropped", count, c->num_win);
+        count = c->num_win;
+    }
     for (int idx = 0; idx < count; ++idx) {
         const ubitz_decode_binding_t *b = &wins[idx];
+        bool range    = (b->type == UBITZ_WIN_RANGE);
         uint32_t base = b->win.iowin;
-        uint32_t mask = b->win.mask;
-        uint8_t slot  = b->slot & 0x07;
-        uint8_t op    = op_encode(b->win.opsel);
+        uint32_t mask = range ? b->limit : b->win.mask;
+        uint8_t slot  = ubitz_map_slot_byte(b);
+        uint8_t op    = ubitz_map_op_byte(b->win.opsel);
         int w = idx; // programming in sorted order supplied by builder
+        // Enumeration rejects such maps (ubitz_cpld_map_fits) before they get here.
+        const char *why = window_unfit(c, b, w);
+        if (why) {
+            ESP_LOGE(TAG, "window %d %s; skipped", w, why);
+            continue;
+        }
         // Write BASE bytes
-        for (int byte = 0; byte < 4; ++byte) {
-            dec_write(0x00 + w * 4 + byte, (base >> (8 * byte)) & 0xFF);
+        for (int byte = 0; byte < c->cfg_bytes && byte < 4; ++byte) {
+            dec_write(c->base_off + w * c->cfg_bytes + byte, (base >> (8 * byte)) & 0xFF);
         }
-        // Write MASK bytes
-        for (int byte = 0; byte < 4; ++byte) {
-            dec_write(0x40 + w * 4 + byte, (mask >> (8 * byte)) & 0xFF);
+        // Write MASK (or LIMIT) bytes
+        for (int byte = 0; byte < c->cfg_bytes && byte < 4; ++byte) {
+            dec_write(c->mask_off + w * c->cfg_bytes + byte, (mask >> (8 * byte)) & 0xFF);
         }
-        // SLOT
-        dec_write(0x80 + w, slot);
+        // SLOT + TYPE + POSTED + DOCK
+        dec_write(c->slot_off + w, slot);
         // OP
-        dec_write(0x90 + w, op);
+        dec_write(c->op_off + w, op);
     }
 }
 
-// Helpers for IRQ routing flattening
-static inline uint8_t int_entry(uint8_t dest_pin) {
-    return 0x80 | (dest_pin & 0x0F); // bit7 enable, low nibble dest
-}
-
-static inline uint8_t nmi_entry(uint8_t dest_pin) {
-    return 0x80 | (dest_pin & 0x0F); // same format
-}
-
+// Maskable idx = slot * num_int_ch + ch; NMI entries at nmi_off + slot,
+// coalescing bytes at coal_off + maskable idx (offsets from the capability block).
 void ubitz_cpld_program_irq_router(const ubitz_irq_binding_t *irqs, int count) {
-    // Assume 5 slots, 2 INT channels per slot: maskable idx = slot*2 + ch
-    // NMI entries follow at idx = NUM_SLOTS*2 + slot
-    const int num_slots = 5;
+    const ubitz_cpld_caps_t *c = s_lay;
     for (int i = 0; i < count; ++i) {
         const ubitz_irq_binding_t *b = &irqs[i];
         uint8_t chmask = b->route.channel;
         uint8_t dest = b->route.dest_pin;
-        if (chmask & 0x01) { // INT_CH0
-            uint8_t idx = (b->slot * 2) + 0;
-            irq_write(idx, int_entry(dest));
+        if (b->slot >= c->num_slots) {
+            ESP_LOGE(TAG, "IRQ route for slot %u beyond Dock build (%u slots)", b->slot, c->num_slots);
+            continue;
         }
-        if (chmask & 0x02) { // INT_CH1
-            uint8_t idx = (b->slot * 2) + 1;
-            irq_write(idx, int_entry(dest));
+        for (int ch = 0; ch < c->num_int_ch && ch < UBITZ_MAX_INT_CH; ++ch) {
+            if ((chmask & (1 << ch)) == 0) { // INT_CH0..3
+                continue;
+            }
+            uint8_t idx = (uint8_t)(b->slot * c->num_int_ch + ch);
+            irq_write(idx, ubitz_map_route_byte(dest));
+            if (c->features & UBITZ_CAP_FEAT_COALESCE) {
+                irq_write(c->coal_off + idx, b->route.coalesce);
+            }
         }
         if (chmask & 0x10) { // NMI
-            uint8_t idx = (num_slots * 2) + b->slot;
+            uint8_t idx = c->nmi_off + b->slot;
             // dest_pin expected 0x10/0x11 -> map to NMI index 0/1
             uint8_t nmi_dest = (dest >= 0x10) ? (dest - 0x10) : dest;
-            irq_write(idx, nmi_entry(nmi_dest));
+            irq_write(idx, ubitz_map_route_byte(nmi_dest));
+        }
+    }
+}
+
+// Region r: BASE bytes at mem_off + r * cfg_bytes, ATTR byte after all the
+// BASE entries (EN, SPACE, SIZE). Unwritten regions stay disabled.
+void ubitz_cpld_program_mem(const ubitz_mem_binding_t *mems, int count) {
+    const ubitz_cpld_caps_t *c = s_lay;
+    if (count > c->num_mem_region) {
+        ESP_LOGE(TAG, "%d Bank regions, Dock build has %u; extra regions dropped",
+                 count, c->num_mem_region);
+        count = c->num_mem_region;
+    }
+    uint8_t attr_off = (uint8_t)(c->mem_off + c->num_mem_region * c->cfg_bytes);
+    for (int r = 0; r < count; ++r) {
+        for (int byte = 0; byte < c->cfg_bytes && byte < 4; ++byte) {
+            dec_write(c->mem_off + r * c->cfg_bytes + byte, (mems[r].base >> (8 * byte)) & 0xFF);
+        }
+        dec_write(attr_off + r, ubitz_map_mem_attr(&mems[r]));
+    }
+}
+
+void ubitz_cpld_render_map(const ubitz_cpld_caps_t *c, uint8_t *img,
+                           const ubitz_decode_binding_t *wins, int win_count,
+                           const ubitz_irq_binding_t *irqs, int irq_count,
+                           const ubitz_mem_binding_t *mems, int mem_count) {
+    memset(img, 0x00, 256);
+    memset(img + c->op_off, 0xFF, c->num_win);
+    s_render = img;
+    s_lay = c;
+    ubitz_cpld_program_decoder(wins, win_count);
+    ubitz_cpld_program_irq_router(irqs, irq_count);
+    ubitz_cpld_program_mem(mems, mem_count);
+    s_lay = &s_caps;
+    s_render = NULL;
+}
+
+static void render_map(uint8_t *img,
+                       const ubitz_decode_binding_t *wins, int win_count,
+                       const ubitz_irq_binding_t *irqs, int irq_count,
+                       const ubitz_mem_binding_t *mems, int mem_count) {
+    ubitz_cpld_render_map(&s_caps, img, wins, win_count, irqs, irq_count, mems, mem_count);
+}
+
+// End of the decoder-side config bytes: the OP table, or the Bank region
+// ATTR table where the build has one.
+static int dec_cfg_end(const ubitz_cpld_caps_t *c) {
+    if (c->num_mem_region) {
+        return c->mem_off + c->num_mem_region * (c->cfg_bytes + 1);
+    }
+    return c->op_off + c->num_win;
+}
+
+// Decoder bytes [0, dec_cfg_end), then IRQ bytes [irq_base, irq_base + coal_snap).
+static uint16_t image_sum(const uint8_t *img) {
+    const ubitz_cpld_caps_t *c = &s_caps;
+    int dec_end = dec_cfg_end(c);
+    uint16_t s1 = 0, s2 = 0;
+    for (int i = 0; i < dec_end + c->coal_snap; ++i) {
+        int a = (i < dec_end) ? i : c->irq_base + i - dec_end;
+        s1 = (s1 + img[a]) % 255;
+        s2 = (s2 + s1) % 255;
+    }
+    return (uint16_t)((s2 << 8) | s1);
+}
+
+uint16_t ubitz_cpld_map_sum(const ubitz_decode_binding_t *wins, int win_count,
+                            const ubitz_irq_binding_t *irqs, int irq_count,
+                            const ubitz_mem_binding_t *mems, int mem_count) {
+    uint8_t img[256];
+    if (!s_caps.present) {
+        return 0;
+    }
+    render_map(img, wins, win_count, irqs, irq_count, mems, mem_count);
+    return image_sum(img);
+}
+
+bool ubitz_cpld_map_matches_baked(const ubitz_decode_binding_t *wins, int win_count,
+                                  const ubitz_irq_binding_t *irqs, int irq_count,
+                                  const ubitz_mem_binding_t *mems, int mem_count) {
+    if (!(s_caps.features & UBITZ_CAP_FEAT_CFG_INIT)) {
+        return false;
+    }
+    return ubitz_cpld_map_sum(wins, win_count, irqs, irq_count, mems, mem_count) ==
+           s_caps.cfg_init_sum;
+}
+
+void ubitz_cpld_program_map(const ubitz_decode_binding_t *wins, int win_count,
+                            const ubitz_irq_binding_t *irqs, int irq_count,
+                            const ubitz_mem_binding_t *mems, int mem_count) {
+    const ubitz_cpld_caps_t *c = &s_caps;
+    if (!c->present) {
+        ubitz_cpld_program_decoder(wins, win_count);
+        ubitz_cpld_program_irq_router(irqs, irq_count);
+        return;
+    }
+    uint8_t img[256];
+    render_map(img, wins, win_count, irqs, irq_count, mems, mem_count);
+    ubitz_cpld_program_image(img);
+}
+
+void ubitz_cpld_program_image(const uint8_t *img) {
+    const ubitz_cpld_caps_t *c = &s_caps;
+    if (!c->present) {
+        return;
+    }
+    for (int a = 0; a < dec_cfg_end(c); ++a) {
+        dec_write((uint8_t)a, img[a]);
+    }
+    for (int i = 0; i < c->coal_snap; ++i) {
+        irq_write((uint8_t)i, img[c->irq_base + i]);
+    }
+}
+
+void ubitz_cpld_read_irq_coal_stats(uint8_t slot, uint8_t ch,
+                                    uint8_t *delivered, uint8_t *coalesced) {
+    const ubitz_cpld_caps_t *c = &s_caps;
+    irq_write(c->coal_snap, (uint8_t)(slot * c->num_int_ch + ch));
+    esp_rom_delay_us(2); // snapshot crosses into the core clock domain
+    *delivered = irq_read(c->coal_snap + 1);
+    *coalesced = irq_read(c->coal_snap + 2);
+}
+
+esp_err_t ubitz_cpld_trace_start(const ubitz_trace_trigger_t *trig) {
+    const ubitz_cpld_caps_t *c = &s_caps;
+    if (!(c->features & UBITZ_CAP_FEAT_TRACE)) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    // Trigger registers are sampled by the core clock: program with EN=0.
+    dec_write(c->trace_base + TRACE_CTRL, 0x00);
+    if (trig) {
+        dec_write(c->trace_base + TRACE_TRIG, trig->qual);
+        dec_write(c->trace_base + TRACE_WAIT_THR, trig->wait_thr);
+        dec_write(c->trace_base + TRACE_POST_CNT, trig->post_cnt);
+        for (int byte = 0; byte < 4; ++byte) {
+            dec_write(c->trace_base + TRACE_ADDR + byte, (trig->addr >> (8 * byte)) & 0xFF);
+            dec_write(c->trace_base + TRACE_MASK + byte, (trig->mask >> (8 * byte)) & 0xFF);
+        }
+    }
+    dec_write(c->trace_base + TRACE_CTRL,
+              TRACE_CTRL_EN | TRACE_CTRL_CLEAR | (trig ? TRACE_CTRL_ARM : 0));
+    return ESP_OK;
+}
+
+void ubitz_cpld_trace_stop(void) {
+    if (s_caps.features & UBITZ_CAP_FEAT_TRACE) {
+        dec_write(s_caps.trace_base + TRACE_CTRL, 0x00);
+    }
+}
+
+uint8_t ubitz_cpld_trace_status(void) {
+    if (!(s_caps.features & UBITZ_CAP_FEAT_TRACE)) {
+        return 0;
+    }
+    return cfg_read(s_caps.trace_base + TRACE_CTRL);
+}
+
+int ubitz_cpld_trace_read(ubitz_trace_entry_t *out, int max) {
+    const ubitz_cpld_caps_t *c = &s_caps;
+    if (!(c->features & UBITZ_CAP_FEAT_TRACE) || max <= 0) {
+        return 0;
+    }
+    // Keep the status (TRIGGERED/FROZEN) but stop recording before draining.
+    uint8_t st = ubitz_cpld_trace_status();
+    dec_write(c->trace_base + TRACE_CTRL, st & TRACE_CTRL_ARM);
+    esp_rom_delay_us(2); // let an in-flight cycle commit in the core clock domain
+
+    int depth = 1 << c->trace_depth_log2;
+    int wr    = cfg_read(c->trace_base + TRACE_WR_PTR);
+    bool wrapped = (cfg_read(c->trace_base + TRACE_CTRL) & UBITZ_TRACE_S_WRAPPED) != 0;
+    int count = wrapped ? depth : wr;
+    int first = wrapped ? wr : 0;
+    if (count > max) {
+        first += count - max;
+        count = max;
+    }
+
+    dec_write(c->trace_base + TRACE_RD_IDX, (uint8_t)(first & (depth - 1)));
+    for (int i = 0; i < count; ++i) {
+        uint8_t e[16] = {0};
+        esp_rom_delay_us(1); // RAM read port follows RD_IDX on the core clock
+        for (int b = 0; b < c->trace_entry_bytes && b < (int)sizeof(e); ++b) {
+            e[b] = cfg_read(c->trace_base + TRACE_DATA); // advances to the next entry
+        }
+        ubitz_trace_entry_t *t = &out[i];
+        t->timestamp = e[0] | ((uint32_t)e[1] << 8) | ((uint32_t)e[2] << 16);
+        t->wait      = e[3];
+        t->flags     = e[4] & 0x1F;
+        t->slot      = e[4] >> 5;
+        t->win       = e[5];
+        t->addr      = 0;
+        for (int b = 0; b < c->trace_entry_bytes - 6 && b < 4; ++b) {
+            t->addr |= (uint32_t)e[6 + b] << (8 * b);
         }
     }
+    return count;
 }
@@ -1,9 +1,141 @@
 #pragma once
 #include <stdint.h>
+#include <stdbool.h>
 #include "esp_err.h"
 #include "ubitz_enumerator.h"
 #include "ubitz_pins.h"
 
+// Capability feature bits
+#define UBITZ_CAP_FEAT_RANGE    0x01  // BASE/LIMIT range windows
+#define UBITZ_CAP_FEAT_POSTED   0x02  // posted-write windows
+#define UBITZ_CAP_FEAT_COALESCE 0x04  // IRQ coalescing + counters
+#define UBITZ_CAP_FEAT_TRACE    0x08  // bus trace ring buffer
+#define UBITZ_CAP_FEAT_SVC      0x10  // Dock services slot (MCU mailbox)
+#define UBITZ_CAP_FEAT_DOCK_WIN 0x20  // DOCK windows: Host IRQ status window
+#define UBITZ_CAP_FEAT_CFG_INIT 0x40  // baked power-on decode/route map
+#define UBITZ_CAP_FEAT_BRIDGE   0x80  // BRIDGE windows to a chained Dock
+
+#define UBITZ_CAP_BLOCK_LEN     0x1F  // capability bytes 0x00-0x1E
+
+// Dock build parameters and config layout, read from the CPLD capability
+// block at init. Without one (older/standalone builds) the 5-slot, 2-channel,
+// 16 x 32-bit window layout is assumed and IRQ entries use cfg_wr_en.
+typedef struct {
+    bool    present;        // capability block found; IRQ uses the shared bus
+    uint8_t version;
+    uint8_t addr_w;         // decoder ADDR_W
+    uint8_t num_win;
+    uint8_t num_range_win;  // windows 0..num_range_win-1 accept range TYPE
+    uint8_t num_slots;
+    uint8_t num_int_ch;     // maskable INT channels per slot
+    uint8_t num_cpu_int;
+    uint8_t num_cpu_nmi;
+    uint8_t irq_base;       // IRQ_CFG_BASE on the shared config bus
+    uint8_t cfg_bytes;      // bytes per BASE/MASK entry
+    uint8_t base_off;
+    uint8_t mask_off;
+    uint8_t slot_off;
+    uint8_t op_off;
+    uint8_t nmi_off;        // IRQ-relative offsets
+    uint8_t coal_off;
+    uint8_t coal_snap;
+    uint8_t coal_tick_w;
+    uint8_t features;       // UBITZ_CAP_FEAT_*
+    uint8_t trace_base;     // bus trace registers (absolute), 0 = none
+    uint8_t trace_depth_log2;
+    uint8_t trace_entry_bytes;
+    uint8_t svc_slot;       // Dock services slot, 0xFF = none
+    uint8_t svc_fifo_log2;
+    uint16_t cfg_init_sum;  // Fletcher-16 of the baked map {sum2, sum1}, 0 = none
+    uint8_t bridge_hold;    // /READY hold (clk) on BRIDGE windows
+    uint8_t mem_off;        // Bank region BASE table, 0 = no Bank decode
+    uint8_t num_mem_region;
+} ubitz_cpld_caps_t;
+
+// Bus trace trigger qualifiers (all enabled terms must match)
+#define UBITZ_TRACE_Q_ADDR     0x01  // (addr & mask) == (trig addr & mask)
+#define UBITZ_TRACE_Q_UNMAPPED 0x02
+#define UBITZ_TRACE_Q_VECTOR   0x04  // Mode-2 vector fetch
+#define UBITZ_TRACE_Q_WAIT     0x08  // wait clocks >= wait_thr
+#define UBITZ_TRACE_Q_WRITE    0x10
+#define UBITZ_TRACE_Q_READ     0x20
+#define UBITZ_TRACE_Q_POSTED   0x40
+
+typedef struct {
+    uint8_t  qual;          // UBITZ_TRACE_Q_*; 0 = trigger on the first cycle
+    uint8_t  wait_thr;
+    uint8_t  post_cnt;      // entries kept after the trigger entry
+    uint32_t addr;
+    uint32_t mask;
+} ubitz_trace_trigger_t;
+
+// Bus trace entry flags
+#define UBITZ_TRACE_F_READ     0x01
+#define UBITZ_TRACE_F_UNMAPPED 0x02  // 0xFF filler on reads
+#define UBITZ_TRACE_F_VECTOR   0x04
+#define UBITZ_TRACE_F_POSTED   0x08
+#define UBITZ_TRACE_F_TRIGGER  0x10
+
+// Trace status (CTRL readback)
+#define UBITZ_TRACE_S_EN        0x01
+#define UBITZ_TRACE_S_ARM       0x02
+#define UBITZ_TRACE_S_TRIGGERED 0x10
+#define UBITZ_TRACE_S_FROZEN    0x20
+#define UBITZ_TRACE_S_WRAPPED   0x40
+
+typedef struct {
+    uint32_t timestamp;     // 24-bit CPLD clk count at cycle start
+    uint32_t addr;
+    uint8_t  wait;          // clk cycles the host was held (255 = saturated)
+    uint8_t  flags;         // UBITZ_TRACE_F_*
+    uint8_t  win;
+    uint8_t  slot;
+} ubitz_trace_entry_t;
+
 esp_err_t ubitz_cpld_cfg_init(void);
+const ubitz_cpld_caps_t *ubitz_cpld_get_caps(void);
+// Raw capability block (UBITZ_CAP_BLOCK_LEN bytes) and its decoding; a block
+// without the magic decodes as the legacy layout and returns false. Chained
+// Docks hand their raw block to the head over the Dock link.
+void ubitz_cpld_read_cap_block(uint8_t *raw);
+bool ubitz_cpld_parse_caps(const uint8_t *raw, int len, ubitz_cpld_caps_t *out);
+// True when every window of a map can be programmed on a Dock with layout
+// caps: within its windows, range windows on range comparators, DOCK/BRIDGE
+// windows only where the build has them.
+bool ubitz_cpld_map_fits(const ubitz_cpld_caps_t *caps, const ubitz_decode_binding_t *wins, int count);
 void ubitz_cpld_program_decoder(const ubitz_decode_binding_t *wins, int count);
 void ubitz_cpld_program_irq_router(const ubitz_irq_binding_t *irqs, int count);
+// Bank memory regions, in priority order (builds with num_mem_region > 0).
+void ubitz_cpld_program_mem(const ubitz_mem_binding_t *mems, int count);
+// Fletcher-16 of a map rendered the way the programming calls above write it
+// (same bytes and order as the capability block's baked-map checksum).
+uint16_t ubitz_cpld_map_sum(const ubitz_decode_binding_t *wins, int win_count,
+                            const ubitz_irq_binding_t *irqs, int irq_count,
+                            const ubitz_mem_binding_t *mems, int mem_count);
+// True when the build has a baked map and it equals the rendered map.
+bool ubitz_cpld_map_matches_baked(const ubitz_decode_binding_t *wins, int win_count,
+                                  const ubitz_irq_binding_t *irqs, int irq_count,
+                                  const ubitz_mem_binding_t *mems, int mem_count);
+// Write the complete rendered map: every window, route and Bank region byte,
+// so unused entries return to their defaults over a baked map.
+void ubitz_cpld_program_map(const ubitz_decode_binding_t *wins, int win_count,
+                            const ubitz_irq_binding_t *irqs, int irq_count,
+                            const ubitz_mem_binding_t *mems, int mem_count);
+// Render a map into the 256-byte config-bus image of a Dock with layout caps
+// (present builds only), and write such an image to this Dock's CPLD.
+void ubitz_cpld_render_map(const ubitz_cpld_caps_t *caps, uint8_t *img,
+                           const ubitz_decode_binding_t *wins, int win_count,
+                           const ubitz_irq_binding_t *irqs, int irq_count,
+                           const ubitz_mem_binding_t *mems, int mem_count);
+void ubitz_cpld_program_image(const uint8_t *img);
+// Snapshot-and-clear the coalescing counters of one maskable route.
+void ubitz_cpld_read_irq_coal_stats(uint8_t slot, uint8_t ch,
+                                    uint8_t *delivered, uint8_t *coalesced);
+// Bus trace (UBITZ_CAP_FEAT_TRACE builds). Start clears the buffer; with a
+// trigger it freezes post_cnt entries after the trigger, with NULL it
+// free-runs. Read stops recording and copies out up to max entries, oldest
+// first (the newest ones if the buffer holds more); returns the count.
+esp_err_t ubitz_cpld_trace_start(const ubitz_trace_trigger_t *trig);
+void ubitz_cpld_trace_stop(void);
+uint8_t ubitz_cpld_trace_status(void);
+int ubitz_cpld_trace_read(ubitz_trace_entry_t *out, int max);
@@ -0,0 +1,193 @@
+#include "ubitz_dock_svc.h"
+#include "ubitz_cpld_cfg.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include <string.h>
+
+static const char *TAG = "ubitz_svc";
+
+// SPI commands (dock_services.v)
+enum { SVC_CMD_STATUS = 0x01, SVC_CMD_READ = 0x02, SVC_CMD_WRITE = 0x03, SVC_CMD_CTRL = 0x04 };
+#define SVC_CTRL_MCU_READY 0x01
+#define SVC_CHUNK          255   // READ length byte limit
+
+static spi_device_handle_t s_dev;
+static bool s_present;
+static ubitz_svc_handler_t s_handler;
+static uint8_t s_tx[SVC_CHUNK + 2];
+static uint8_t s_rx[SVC_CHUNK + 2];
+
+// One /CS-framed transaction of len bytes from s_tx, response in s_rx.
+static esp_err_t xfer(int len) {
+    spi_transaction_t t = {
+        .length = (size_t)len * 8,
+        .tx_buffer = s_tx,
+        .rx_buffer = s_rx,
+    };
+    return spi_device_polling_transmit(s_dev, &t);
+}
+
+esp_err_t ubitz_svc_init(void) {
+    const ubitz_cpld_caps_t *c = ubitz_cpld_get_caps();
+    if (!(c->features & UBITZ_CAP_FEAT_SVC) || c->svc_slot >= c->num_slots) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    spi_bus_config_t bus = {
+        .mosi_io_num = UBITZ_SVC_SPI_MOSI_GPIO,
+        .miso_io_num = UBITZ_SVC_SPI_MISO_GPIO,
+        .sclk_io_num = UBITZ_SVC_SPI_SCK_GPIO,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = sizeof(s_tx),
+    };
+    spi_device_interface_config_t dev = {
+        .mode = 0,
+        .clock_speed_hz = UBITZ_SVC_SPI_HZ,
+        .spics_io_num = UBITZ_SVC_SPI_CS_GPIO,
+        .queue_size = 1,
+    };
+    esp_err_t err = spi_bus_initialize(SPI2_HOST, &bus, SPI_DMA_CH_AUTO);
+    if (err == ESP_OK) {
+        err = spi_bus_add_device(SPI2_HOST, &dev, &s_dev);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    gpio_config_t irq = {
+        .pin_bit_mask = 1ULL << UBITZ_SVC_IRQ_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    err = gpio_config(&irq);
+    if (err != ESP_OK) {
+        return err;
+    }
+    s_present = true;
+    ESP_LOGI(TAG, "services on slot %u, %u-byte FIFOs", c->svc_slot, 1u << c->svc_fifo_log2);
+    return ESP_OK;
+}
+
+bool ubitz_svc_present(void) {
+    return s_present;
+}
+
+uint8_t ubitz_svc_slot(void) {
+    return ubitz_cpld_get_caps()->svc_slot;
+}
+
+esp_err_t ubitz_svc_status(ubitz_svc_status_t *out) {
+    if (!s_present) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    memset(s_tx, 0, 6);
+    s_tx[0] = SVC_CMD_STATUS;
+    esp_err_t err = xfer(6);
+    if (err != ESP_OK) {
+        return err;
+    }
+    out->flags     = s_rx[1];
+    out->h2m_count = (uint16_t)(s_rx[2] | (s_rx[3] << 8));
+    out->m2h_free  = (uint16_t)(s_rx[4] | (s_rx[5] << 8));
+    return ESP_OK;
+}
+
+int ubitz_svc_read(uint8_t *buf, int max) {
+    ubitz_svc_status_t st;
+    int got = 0;
+    if (ubitz_svc_status(&st) != ESP_OK) {
+        return -1;
+    }
+    int avail = st.h2m_count < max ? st.h2m_count : max;
+    while (got < avail) {
+        int n = avail - got > SVC_CHUNK ? SVC_CHUNK : avail - got;
+        memset(s_tx, 0, (size_t)n + 2);
+        s_tx[0] = SVC_CMD_READ;
+        s_tx[1] = (uint8_t)n;
+        if (xfer(n + 2) != ESP_OK) {
+            return -1;
+        }
+        memcpy(buf + got, s_rx + 2, (size_t)n);
+        got += n;
+    }
+    return got;
+}
+
+int ubitz_svc_write(const uint8_t *buf, int len) {
+    ubitz_svc_status_t st;
+    int put = 0;
+    if (ubitz_svc_status(&st) != ESP_OK) {
+        return -1;
+    }
+    int room = st.m2h_free < len ? st.m2h_free : len;
+    while (put < room) {
+        int n = room - put > SVC_CHUNK ? SVC_CHUNK : room - put;
+        s_tx[0] = SVC_CMD_WRITE;
+        memcpy(s_tx + 1, buf + put, (size_t)n);
+        if (xfer(n + 1) != ESP_OK) {
+            return -1;
+        }
+        put += n;
+    }
+    return put;
+}
+
+esp_err_t ubitz_svc_set_ready(bool ready) {
+    if (!s_present) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_tx[0] = SVC_CMD_CTRL;
+    s_tx[1] = ready ? SVC_CTRL_MCU_READY : 0x00;
+    return xfer(2);
+}
+
+void ubitz_svc_fill_desc(ubitz_dev_desc_t *out, bool routed) {
+    memset(out, 0, sizeof(*out));
+    memcpy(out->magic, "UPCI", 4);
+    out->version = 0x01;
+    out->device_type = 0x02;
+    out->inst[0].function = UBITZ_SVC_FUNCTION;
+    out->inst[0].instance = 0;
+    out->inst[0].data_bus_width = 8;
+    out->inst[0].addr_bus_width = 4;
+    out->inst[0].int_ack_mode = 0x00;
+    out->inst[0].int_channel = routed ? 0x01 : 0x00;
+    strncpy(out->inst[0].name, "Dock services", sizeof(out->inst[0].name));
+}
+
+static void echo_handler(const uint8_t *data, int len) {
+    ubitz_svc_write(data, len);
+}
+
+// Drain H2M whenever the CPLD raises the mailbox IRQ (H2M not empty).
+static void svc_task(void *arg) {
+    static uint8_t buf[SVC_CHUNK];
+    (void)arg;
+    while (1) {
+        if (!gpio_get_level(UBITZ_SVC_IRQ_GPIO)) {
+            vTaskDelay(1);
+            continue;
+        }
+        int n = ubitz_svc_read(buf, sizeof(buf));
+        if (n > 0) {
+            s_handler(buf, n);
+        } else if (n < 0) {
+            ESP_LOGE(TAG, "mailbox read failed");
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+    }
+}
+
+void ubitz_svc_start(ubitz_svc_handler_t handler) {
+    if (!s_present) {
+        return;
+    }
+    s_handler = handler ? handler : echo_handler;
+    xTaskCreatePinnedToCore(svc_task, "ubitz_svc", UBITZ_SVC_STACK_WORDS, NULL,
+                            UBITZ_SVC_TASK_PRIO, NULL, UBITZ_SVC_CORE);
+    ubitz_svc_set_ready(true);
+}
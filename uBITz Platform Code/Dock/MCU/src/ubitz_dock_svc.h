@@ -0,0 +1,51 @@
+#pragma once
+// Dock services slot: MCU side of the CPLD mailbox (dock_services.v).
+// The Host reads/writes a Tile-like register block on the services slot;
+// the MCU drains the Host->MCU FIFO and fills the MCU->Host FIFO over SPI.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "ubitz_enumerator.h"
+#include "ubitz_pins.h"
+
+#define UBITZ_SVC_FUNCTION     0x10      // vendor-specific Function ID for Dock services
+#define UBITZ_SVC_SPI_HZ       2000000   // must stay <= CPLD clk / 4
+#define UBITZ_SVC_TASK_PRIO    5
+#define UBITZ_SVC_STACK_WORDS  3072
+#define UBITZ_SVC_CORE         1
+
+// SPI STATUS response
+#define UBITZ_SVC_S_H2M_EMPTY  0x01
+#define UBITZ_SVC_S_M2H_EMPTY  0x02
+#define UBITZ_SVC_S_M2H_FULL   0x04
+#define UBITZ_SVC_S_TX_OVF     0x08      // Host wrote DATA while H2M was full
+#define UBITZ_SVC_S_MCU_READY  0x80
+
+typedef struct {
+    uint8_t  flags;      // UBITZ_SVC_S_*
+    uint16_t h2m_count;  // bytes waiting from the Host
+    uint16_t m2h_free;   // room for bytes to the Host
+} ubitz_svc_status_t;
+
+// Called from the service task with bytes drained from the Host; the
+// default handler echoes them back.
+typedef void (*ubitz_svc_handler_t)(const uint8_t *data, int len);
+
+// Set up the SPI link (no-op returning ESP_ERR_NOT_SUPPORTED when the
+// Dock build has no services slot).
+esp_err_t ubitz_svc_init(void);
+bool      ubitz_svc_present(void);
+uint8_t   ubitz_svc_slot(void);
+esp_err_t ubitz_svc_status(ubitz_svc_status_t *out);
+// Drain up to max bytes from H2M / queue up to len bytes into M2H; both
+// return the number of bytes moved, or -1 on an SPI error.
+int       ubitz_svc_read(uint8_t *buf, int max);
+int       ubitz_svc_write(const uint8_t *buf, int len);
+esp_err_t ubitz_svc_set_ready(bool ready);
+// Synthetic descriptor for the services slot, used in place of an I2C
+// EEPROM read. The INT_CH0 bit is only declared when routed is set so
+// CPU descriptors that do not route the services interrupt still enumerate.
+void      ubitz_svc_fill_desc(ubitz_dev_desc_t *out, bool routed);
+// Start the service task (NULL = echo handler) and raise MCU_READY.
+void      ubitz_svc_start(ubitz_svc_handler_t handler);
@@ -3,9 +3,6 @@
 
 #include "driver/gpio.h"
 
-static int popcount32(uint32_t v) { return __builtin_popcount(v); }
-static int popcount8(uint8_t v) { return __builtin_popcount(v); }
-
 static bool magic_ok(const uint8_t m[4]) {
     return m[0] == 'U' && m[1] == 'P' && m[2] == 'C' && m[3] == 'I';
 }
@@ -53,6 +50,17 @@ esp_err_t ubitz_read_cpu_desc(ubitz_cpu_desc_t *out) {
     return (magic_ok(out->magic) && out->device_type == 0x01) ? ESP_OK : ESP_FAIL;
 }
 
+esp_err_t ubitz_read_cpu_memmap(ubitz_cpu_memmap_t *out) {
+    esp_err_t err = i2c_read_block(UBITZ_CPU_DESC_ADDR, UBITZ_CPU_DESC_LEN, (uint8_t *)out,
+                                   UBITZ_CPU_MEMMAP_LEN);
+    if (err != ESP_OK) {
+        return err;
+    }
+    bool ok = out->magic[0] == 'U' && out->magic[1] == 'M' && out->magic[2] == 'E' &&
+              out->magic[3] == 'M';
+    return ok ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
 esp_err_t ubitz_read_dev_desc(uint8_t i2c_addr, ubitz_dev_desc_t *out) {
     esp_err_t err = i2c_read_block(i2c_addr, 0, (uint8_t *)out, UBITZ_DEV_DESC_LEN);
     if (err != ESP_OK) {
@@ -61,6 +69,10 @@ esp_err_t ubitz_read_dev_desc(uint8_t i2c_addr, ubitz_dev_desc_t *out) {
     return (magic_ok(out->magic) && out->device_type == 0x02) ? ESP_OK : ESP_FAIL;
 }
 
+bool ubitz_is_bridge_desc(const ubitz_dev_desc_t *desc) {
+    return magic_ok(desc->magic) && desc->device_type == UBITZ_BRIDGE_DEVICE_TYPE;
+}
+
 esp_err_t ubitz_read_bank_desc(ubitz_bank_desc_t *out) {
     esp_err_t err = i2c_read_block(UBITZ_BANK_DESC_ADDR, 0, (uint8_t *)out, UBITZ_BANK_DESC_LEN);
     if (err != ESP_OK) {
@@ -116,164 +128,6 @@ void ubitz_reset_release(void) {
     gpio_set_level(UBITZ_RESET_GPIO, 1);
 }
 
-// Build window map bindings; returns false on required-missing or collisions.
-bool ubitz_build_window_map(const ubitz_cpu_desc_t *cpu,
-                            const ubitz_dev_desc_t *devs, const uint8_t *slots,
-                            int dev_count, ubitz_decode_binding_t *out, int *out_count) {
-    int o = 0;
-    // Collisions: identical mask+IOWin for different functions are undefined; reject.
-    for (int i = 0; i < 16; ++i) {
-        const ubitz_window_entry_t *wi = &cpu->window[i];
-        if (wi->function == 0x00) {
-            continue;
-        }
-        for (int j = i + 1; j < 16; ++j) {
-            const ubitz_window_entry_t *wj = &cpu->window[j];
-            if (wj->function == 0x00) {
-                continue;
-            }
-            if (wi->iowin == wj->iowin && wi->mask == wj->mask && wi->opsel == wj->opsel &&
-                (wi->function != wj->function || wi->instance != wj->instance)) {
-                return false; // ambiguous decode
-            }
-        }
-    }
-
-    for (int i = 0; i < 16; ++i) {
-        const ubitz_window_entry_t *w = &cpu->window[i];
-        if (w->function == 0x00) {
-            continue;
-        }
-        int found = -1;
-        int found_inst = -1;
-        for (int d = 0; d < dev_count; ++d) {
-            for (int inst = 0; inst < 7; ++inst) {
-                if (devs[d].inst[inst].function == w->function &&
-                    devs[d].inst[inst].instance == w->instance) {
-                    found = d;
-                    found_inst = inst;
-                    break;
-                }
-            }
-            if (found >= 0) {
-                break;
-            }
-        }
-        if (found < 0) {
-            if (w->flags & 0x01) {
-                return false; // required but missing
-            }
-            continue; // optional missing: ignore
-        }
-        uint8_t dev_width = devs[found].inst[found_inst].data_bus_width;
-        bool width_ok = dev_width <= cpu->data_bus_width;
-        out[o++] = (ubitz_decode_binding_t){ .win = *w, .slot = slots[found], .width_ok = width_ok };
-    }
-    // Write order: highest mask specificity first (popcount of mask).
-    for (int i = 1; i < o; ++i) {
-        ubitz_decode_binding_t key = out[i];
-        int key_pc = popcount32(key.win.mask);
-        int j = i - 1;
-        while (j >= 0 && popcount32(out[j].win.mask) < key_pc) {
-            out[j + 1] = out[j];
-            --j;
-        }
-        out[j + 1] = key;
-    }
-    *out_count = o;
-    return true;
-}
-
-static bool route_dup(const ubitz_introute_entry_t *a, const ubitz_introute_entry_t *b) {
-    return a->function == b->function && a->instance == b->instance && a->channel == b->channel;
-}
-
-bool ubitz_build_irq_map(const ubitz_cpu_desc_t *cpu,
-                         const ubitz_dev_desc_t *devs, const uint8_t *slots,
-                         int dev_count, ubitz_irq_binding_t *out, int *out_count) {
-    int o = 0;
-    // Reject duplicate routing entries.
-    for (int i = 0; i < 16; ++i) {
-        if (cpu->introute[i].function == 0x00) {
-            continue;
-        }
-        for (int j = i + 1; j < 16; ++j) {
-            if (cpu->introute[j].function == 0x00) {
-                continue;
-            }
-            if (route_dup(&cpu->introute[i], &cpu->introute[j])) {
-                return false;
-            }
-        }
-    }
-
-    // Ensure each declared device channel has routing.
-    for (int d = 0; d < dev_count; ++d) {
-        for (int inst = 0; inst < 7; ++inst) {
-            const uint8_t chmask = devs[d].inst[inst].int_channel;
-            if (chmask == 0) {
-                continue;
-            }
-            // INT_CH[0..1]
-            for (int bit = 0; bit < 2; ++bit) {
-                if ((chmask & (1 << bit)) == 0) {
-                    continue;
-                }
-                bool ok = false;
-                for (int r = 0; r < 16; ++r) {
-                    const ubitz_introute_entry_t *e = &cpu->introute[r];
-                    if (e->function == 0x00) {
-                        continue;
-                    }
-                    if (e->function == devs[d].inst[inst].function &&
-                        e->instance == devs[d].inst[inst].instance &&
-                        (e->channel & (1 << bit))) {
-                        ok = true;
-                        out[o++] = (ubitz_irq_binding_t){ .route = *e, .slot = slots[d] };
-                        break;
-                    }
-                }
-                if (!ok) {
-                    return false;
-                }
-            }
-            // NMI_CH bit (0x10)
-            if (chmask & 0x10) {
-                bool ok = false;
-                for (int r = 0; r < 16; ++r) {
-                    const ubitz_introute_entry_t *e = &cpu->introute[r];
-                    if (e->function == 0x00) {
-                        continue;
-                    }
-                    if (e->function == devs[d].inst[inst].function &&
-                        e->instance == devs[d].inst[inst].instance &&
-                        (e->channel & 0x10)) {
-                        ok = true;
-                        out[o++] = (ubitz_irq_binding_t){ .route = *e, .slot = slots[d] };
-                        break;
-                    }
-                }
-                if (!ok) {
-                    return false;
-                }
-            }
-        }
-    }
-    // Write order: more specific channel bitmasks first (popcount of channel).
-    for (int i = 1; i < o; ++i) {
-        ubitz_irq_binding_t key = out[i];
-        int key_pc = popcount8(key.route.channel);
-        int j = i - 1;
-        while (j >= 0 && popcount8(out[j].route.channel) < key_pc) {
-            out[j + 1] = out[j];
-            --j;
-        }
-        out[j + 1] = key;
-    }
-    *out_count = o;
-    return true;
-}
-
 void ubitz_snapshot_reset(void) {
     memset(&g_snapshot, 0, sizeof(g_snapshot));
     g_snapshot.fail_reason = UBITZ_ENUM_UNKNOWN_FAIL;
@@ -288,7 +142,8 @@ void ubitz_snapshot_publish(const ubitz_cpu_desc_t *cpu,
                             const ubitz_bank_desc_t *bank,
                             const ubitz_dev_desc_t *devs, int dev_count,
                             const ubitz_decode_binding_t *wins, int win_count,
-                            const ubitz_irq_binding_t *irqs, int irq_count) {
+                            const ubitz_irq_binding_t *irqs, int irq_count,
+                            const ubitz_mem_binding_t *mems, int mem_count) {
     g_snapshot.success = true;
     g_snapshot.fail_reason = UBITZ_ENUM_OK;
     if (cpu) {
@@ -309,6 +164,10 @@ void ubitz_snapshot_publish(const ubitz_cpu_desc_t *cpu,
     for (int i = 0; i < g_snapshot.irq_route_count; ++i) {
         g_snapshot.irq_routes[i] = irqs[i];
     }
+    g_snapshot.mem_region_count = (mem_count > UBITZ_MAX_MEM_REGIONS) ? UBITZ_MAX_MEM_REGIONS : mem_count;
+    for (int i = 0; i < g_snapshot.mem_region_count; ++i) {
+        g_snapshot.mem_regions[i] = mems[i];
+    }
 }
 
 const ubitz_enum_snapshot_t *ubitz_snapshot_get(void) {
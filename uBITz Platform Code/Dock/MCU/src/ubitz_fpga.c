@@ -0,0 +1,246 @@
+#include "ubitz_fpga.h"
+#include "driver/gpio.h"
+#include "driver/spi_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_rom_sys.h"
+#include <string.h>
+
+static const char *TAG = "ubitz_fpga";
+
+#define FPGA_CHUNK         4096
+#define FPGA_CLEAR_US      1200   // CRESET_B high to first SPI clock (HX8K)
+#define FPGA_BOOT_FLASH_MS 500    // master-mode boot from the iCE40's own flash
+
+static spi_device_handle_t s_dev;
+static bool s_ready;
+static ubitz_fpga_variant_t s_loaded;
+static bool s_have_loaded;
+static uint8_t s_buf[FPGA_CHUNK] __attribute__((aligned(4)));
+
+static esp_err_t fpga_init(void) {
+    if (s_ready) {
+        return ESP_OK;
+    }
+    gpio_config_t out = {
+        .pin_bit_mask = (1ULL << UBITZ_FPGA_CRESET_GPIO) | (1ULL << UBITZ_FPGA_SS_GPIO),
+        .mode = GPIO_MODE_OUTPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_DISABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    gpio_config_t in = {
+        .pin_bit_mask = 1ULL << UBITZ_FPGA_CDONE_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    esp_err_t err = gpio_config(&out);
+    if (err == ESP_OK) {
+        err = gpio_config(&in);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    gpio_set_level(UBITZ_FPGA_SS_GPIO, 1);
+    gpio_set_level(UBITZ_FPGA_CRESET_GPIO, 1);
+
+    spi_bus_config_t bus = {
+        .mosi_io_num = UBITZ_FPGA_MOSI_GPIO,
+        .miso_io_num = -1,
+        .sclk_io_num = UBITZ_FPGA_SCK_GPIO,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1,
+        .max_transfer_sz = FPGA_CHUNK,
+    };
+    spi_device_interface_config_t dev = {
+        .mode = 3,                 // iCE40 samples SPI_SI on the rising edge, SCK idles high
+        .clock_speed_hz = UBITZ_FPGA_SPI_HZ,
+        .spics_io_num = -1,        // SPI_SS_B stays low across the whole bitstream
+        .queue_size = 1,
+    };
+    err = spi_bus_initialize(SPI3_HOST, &bus, SPI_DMA_CH_AUTO);
+    if (err == ESP_OK) {
+        err = spi_bus_add_device(SPI3_HOST, &dev, &s_dev);
+    }
+    s_ready = (err == ESP_OK);
+    return err;
+}
+
+// CDONE only: reading it leaves CRESET_B and SPI_SS_B undriven.
+static esp_err_t cdone_wait(void) {
+    gpio_config_t in = {
+        .pin_bit_mask = 1ULL << UBITZ_FPGA_CDONE_GPIO,
+        .mode = GPIO_MODE_INPUT,
+        .pull_up_en = GPIO_PULLUP_DISABLE,
+        .pull_down_en = GPIO_PULLDOWN_ENABLE,
+        .intr_type = GPIO_INTR_DISABLE,
+    };
+    esp_err_t err = gpio_config(&in);
+    if (err != ESP_OK) {
+        return err;
+    }
+    for (int t = 0; t < FPGA_BOOT_FLASH_MS; t += 10) {
+        if (gpio_get_level(UBITZ_FPGA_CDONE_GPIO)) {
+            return ESP_OK;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return ESP_ERR_TIMEOUT;
+}
+
+static esp_err_t spi_send(const uint8_t *data, size_t len) {
+    spi_transaction_t t = {
+        .length = len * 8,
+        .tx_buffer = data,
+    };
+    return spi_device_polling_transmit(s_dev, &t);
+}
+
+// n bytes of dummy clocks (SPI_SI don't care).
+static esp_err_t spi_clocks(size_t n) {
+    memset(s_buf, 0, n);
+    return spi_send(s_buf, n);
+}
+
+int ubitz_fpga_list(ubitz_fpga_variant_t *out, int max) {
+    int n = 0;
+    esp_partition_iterator_t it = esp_partition_find(ESP_PARTITION_TYPE_DATA,
+                                                     UBITZ_FPGA_PART_SUBTYPE, NULL);
+    for (; it != NULL && n < max; it = esp_partition_next(it)) {
+        const esp_partition_t *p = esp_partition_get(it);
+        uint8_t hdr[UBITZ_FPGA_HDR_LEN];
+        if (esp_partition_read(p, 0, hdr, sizeof(hdr)) != ESP_OK) {
+            continue;
+        }
+        uint32_t len = hdr[8] | ((uint32_t)hdr[9] << 8) | ((uint32_t)hdr[10] << 16) |
+                       ((uint32_t)hdr[11] << 24);
+        if (memcmp(hdr, "UBVB", 4) != 0 || hdr[4] != 1 || len == 0 ||
+            len > p->size - UBITZ_FPGA_HDR_LEN) {
+            continue; // erased or foreign partition
+        }
+        out[n++] = (ubitz_fpga_variant_t){ .part = p, .addr_w = hdr[5], .num_win = hdr[6],
+                                           .num_slots = hdr[7], .length = len };
+    }
+    esp_partition_iterator_release(it);
+    return n;
+}
+
+int ubitz_fpga_pick(const ubitz_fpga_variant_t *v, int count, const ubitz_cpu_desc_t *cpu) {
+    int best = -1;
+    if (!cpu) {
+        for (int i = 0; i < count; ++i) {
+            if (best < 0 || v[i].addr_w > v[best].addr_w ||
+                (v[i].addr_w == v[best].addr_w && v[i].num_win > v[best].num_win)) {
+                best = i;
+            }
+        }
+        return best;
+    }
+    // Every descriptor window may need a decoder window (merging only saves).
+    int wins = 0;
+    for (int i = 0; i < 16; ++i) {
+        wins += cpu->window[i].function != 0x00;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (v[i].addr_w < cpu->addr_bus_width || v[i].num_win < wins) {
+            continue;
+        }
+        uint32_t cost = (uint32_t)v[i].addr_w * v[i].num_win;
+        uint32_t best_cost = (best < 0) ? 0 : (uint32_t)v[best].addr_w * v[best].num_win;
+        if (best < 0 || cost < best_cost ||
+            (cost == best_cost && v[i].num_win < v[best].num_win)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+// Lattice TN1248 slave SPI configuration: SS low through the CRESET_B
+// rising edge selects slave mode; CDONE rises once the bitstream checks out.
+esp_err_t ubitz_fpga_load(const ubitz_fpga_variant_t *v) {
+    esp_err_t err = fpga_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+    gpio_set_level(UBITZ_FPGA_SS_GPIO, 0);
+    gpio_set_level(UBITZ_FPGA_CRESET_GPIO, 0);
+    esp_rom_delay_us(1);
+    gpio_set_level(UBITZ_FPGA_CRESET_GPIO, 1);
+    esp_rom_delay_us(FPGA_CLEAR_US);
+
+    gpio_set_level(UBITZ_FPGA_SS_GPIO, 1);
+    err = spi_clocks(1);
+    gpio_set_level(UBITZ_FPGA_SS_GPIO, 0);
+    for (uint32_t off = 0; off < v->length && err == ESP_OK; off += FPGA_CHUNK) {
+        uint32_t n = v->length - off;
+        if (n > FPGA_CHUNK) {
+            n = FPGA_CHUNK;
+        }
+        err = esp_partition_read(v->part, UBITZ_FPGA_HDR_LEN + off, s_buf, n);
+        if (err == ESP_OK) {
+            err = spi_send(s_buf, n);
+        }
+    }
+    gpio_set_level(UBITZ_FPGA_SS_GPIO, 1);
+    if (err == ESP_OK) {
+        err = spi_clocks(13); // >= 100 clocks for CDONE
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (!gpio_get_level(UBITZ_FPGA_CDONE_GPIO)) {
+        ESP_LOGE(TAG, "%s: CDONE low after %lu bytes", v->part->label, (unsigned long)v->length);
+        return ESP_ERR_INVALID_CRC;
+    }
+    err = spi_clocks(7); // >= 49 more clocks release the user I/O
+    if (err == ESP_OK) {
+        s_loaded = *v;
+        s_have_loaded = true;
+    }
+    return err;
+}
+
+esp_err_t ubitz_fpga_boot_flash(void) {
+    esp_err_t err = fpga_init();
+    if (err != ESP_OK) {
+        return err;
+    }
+    s_have_loaded = false;
+    gpio_set_level(UBITZ_FPGA_SS_GPIO, 1); // SS high at CRESET_B: master mode
+    gpio_set_level(UBITZ_FPGA_CRESET_GPIO, 0);
+    esp_rom_delay_us(1);
+    gpio_set_level(UBITZ_FPGA_CRESET_GPIO, 1);
+    return cdone_wait();
+}
+
+esp_err_t ubitz_fpga_configure(const ubitz_cpu_desc_t *cpu) {
+    static ubitz_fpga_variant_t variants[UBITZ_FPGA_MAX_VARIANTS];
+    int count = ubitz_fpga_list(variants, UBITZ_FPGA_MAX_VARIANTS);
+    int pick = ubitz_fpga_pick(variants, count, cpu);
+    if (pick >= 0) {
+        const ubitz_fpga_variant_t *v = &variants[pick];
+        esp_err_t err = ubitz_fpga_load(v);
+        if (err == ESP_OK) {
+            ESP_LOGI(TAG, "%s: ADDR_W=%u NUM_WIN=%u NUM_SLOTS=%u", v->part->label,
+                     v->addr_w, v->num_win, v->num_slots);
+            return ESP_OK;
+        }
+        // The failed load left the iCE40 cleared: reboot it from its flash.
+        ESP_LOGE(TAG, "%s failed (%s); booting the iCE40 flash", v->part->label,
+                 esp_err_to_name(err));
+        return ubitz_fpga_boot_flash();
+    }
+    if (count > 0) {
+        ESP_LOGW(TAG, "no variant fits the Host; keeping the iCE40 flash configuration");
+    }
+    // Nothing to load: CRESET_B stays untouched and the configuration the
+    // iCE40 booted from its own flash at power-up stays in place.
+    return cdone_wait();
+}
+
+const ubitz_fpga_variant_t *ubitz_fpga_loaded(void) {
+    return s_have_loaded ? &s_loaded : NULL;
+}
@@ -0,0 +1,43 @@
+#pragma once
+// iCE40 bitstream variants: specialized builds of top (ADDR_W / NUM_WIN)
+// kept in the fpga_* data partitions, each a 16-byte header from
+// HDL/src/pack_variant.sh followed by the bitstream. After reading the CPU
+// descriptor app_main loads the tightest variant in SPI slave mode; with no
+// usable variant the iCE40 boots its own configuration flash as before.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "ubitz_map.h"
+#include "ubitz_pins.h"
+
+#define UBITZ_FPGA_PART_SUBTYPE  0x40      // data partition subtype of a variant
+#define UBITZ_FPGA_MAX_VARIANTS  8
+#define UBITZ_FPGA_HDR_LEN       16
+#define UBITZ_FPGA_SPI_HZ        10000000  // iCE40 slave configuration, <= 25 MHz
+
+typedef struct {
+    const esp_partition_t *part;
+    uint8_t  addr_w;
+    uint8_t  num_win;
+    uint8_t  num_slots;
+    uint32_t length;         // bitstream bytes after the header
+} ubitz_fpga_variant_t;
+
+// Variants found in flash (bad headers skipped); returns the count.
+int       ubitz_fpga_list(ubitz_fpga_variant_t *out, int max);
+// Tightest variant for a Host: ADDR_W >= its address bus, NUM_WIN >= its
+// descriptor windows, fewest comparator bits (ADDR_W * NUM_WIN). cpu NULL
+// picks the widest. Returns the index, -1 if none fits.
+int       ubitz_fpga_pick(const ubitz_fpga_variant_t *v, int count, const ubitz_cpu_desc_t *cpu);
+// Configure the iCE40 from a variant (SPI slave mode) or from its own flash.
+esp_err_t ubitz_fpga_load(const ubitz_fpga_variant_t *v);
+esp_err_t ubitz_fpga_boot_flash(void);
+// Pick and load for cpu. With no variant to load CRESET_B is left alone and
+// the iCE40 keeps the configuration it booted from its own flash (this waits
+// for CDONE); only a failed load reboots it from there. Call with /RESET
+// asserted, before ubitz_cpld_cfg_init().
+esp_err_t ubitz_fpga_configure(const ubitz_cpu_desc_t *cpu);
+// Variant in the iCE40, NULL when it booted its own flash.
+const ubitz_fpga_variant_t *ubitz_fpga_loaded(void);
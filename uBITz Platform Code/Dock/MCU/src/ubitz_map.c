@@ -0,0 +1,456 @@
+#include "ubitz_map.h"
+
+static int popcount32(uint32_t v) { return __builtin_popcount(v); }
+static int popcount8(uint8_t v) { return __builtin_popcount(v); }
+
+// Inclusive address span decoded by a binding, clipped to the Host address
+// width. Returns false for BASE/MASK windows whose mask has holes: those decode
+// a strided pattern no single range can express (lo/hi still bound it).
+static bool binding_span(const ubitz_decode_binding_t *b, uint32_t width_mask,
+                         uint32_t *lo, uint32_t *hi) {
+    if (b->type == UBITZ_WIN_RANGE) {
+        *lo = b->win.iowin;
+        *hi = b->limit;
+        return true;
+    }
+    uint32_t care = b->win.mask | ~width_mask;
+    uint32_t dont_care = ~care;
+    *lo = b->win.iowin & care & width_mask;
+    *hi = *lo | dont_care;
+    return (dont_care & (dont_care + 1u)) == 0;
+}
+
+// Bindings that decode to the same Dock behaviour (slot, OP gating, posting).
+// IRQ status windows of different Docks in a chain stay apart.
+static bool same_target(const ubitz_decode_binding_t *a, const ubitz_decode_binding_t *b) {
+    return a->slot == b->slot && a->bridge == b->bridge && a->win.opsel == b->win.opsel &&
+           (a->win.flags & UBITZ_WIN_FLAG_POSTED) == (b->win.flags & UBITZ_WIN_FLAG_POSTED) &&
+           (a->slot != UBITZ_SLOT_DOCK || a->win.instance == b->win.instance);
+}
+
+// Sort key: care-bit count for BASE/MASK; for ranges, the care-bit count of
+// the smallest aligned block that could hold the span.
+static int binding_specificity(const ubitz_decode_binding_t *b, uint32_t width_mask) {
+    if (b->type == UBITZ_WIN_RANGE) {
+        uint32_t span = b->limit - b->win.iowin;
+        span |= span >> 1;
+        span |= span >> 2;
+        span |= span >> 4;
+        span |= span >> 8;
+        span |= span >> 16;
+        return popcount32(~span & width_mask);
+    }
+    return popcount32(b->win.mask);
+}
+
+static uint32_t addr_width_mask(uint8_t addr_bus_width) {
+    return (addr_bus_width >= 32) ? 0xFFFFFFFFu : ((1u << addr_bus_width) - 1u);
+}
+
+// Collapse windows of one Function instance whose spans touch into one
+// binding, so e.g. 0x10-0x1F + 0x20-0x2F + 0x30-0x3F costs one decoder window
+// instead of three. The result stays BASE/MASK when it is an aligned
+// power-of-two block and becomes a BASE/LIMIT range otherwise. A merge is
+// skipped if the combined span would overlap a binding with a different
+// target, so priority between targets is unchanged, and if it would need more
+// than max_range range windows. Returns the new binding count.
+static int merge_range_windows(ubitz_decode_binding_t *out, int count, uint8_t addr_bus_width,
+                               int max_range) {
+    const uint32_t width_mask = addr_width_mask(addr_bus_width);
+    int ranges = 0;
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (int i = 0; i < count && !merged; ++i) {
+            uint32_t ilo, ihi;
+            if (!binding_span(&out[i], width_mask, &ilo, &ihi)) {
+                continue;
+            }
+            for (int j = i + 1; j < count; ++j) {
+                uint32_t jlo, jhi;
+                // Same Function instance only: the binding keeps one identity.
+                if (!same_target(&out[i], &out[j]) ||
+                    out[i].win.function != out[j].win.function ||
+                    out[i].win.instance != out[j].win.instance) {
+                    continue;
+                }
+                if (!binding_span(&out[j], width_mask, &jlo, &jhi)) {
+                    continue;
+                }
+                // Spans must overlap or be adjacent (guard the +1 at the top of the space).
+                if ((ihi != 0xFFFFFFFFu && jlo > ihi + 1u) || (jhi != 0xFFFFFFFFu && ilo > jhi + 1u)) {
+                    continue;
+                }
+                uint32_t lo = (ilo < jlo) ? ilo : jlo;
+                uint32_t hi = (ihi > jhi) ? ihi : jhi;
+                bool conflict = false;
+                for (int k = 0; k < count && !conflict; ++k) {
+                    uint32_t klo, khi;
+                    if (k == i || k == j || same_target(&out[k], &out[i])) {
+                        continue;
+                    }
+                    binding_span(&out[k], width_mask, &klo, &khi);
+                    conflict = (klo <= hi) && (lo <= khi);
+                }
+                if (conflict) {
+                    continue;
+                }
+
+                uint32_t size_m1 = hi - lo;
+                bool block = (size_m1 & (size_m1 + 1u)) == 0 && (lo & size_m1) == 0;
+                int left = ranges - (out[i].type == UBITZ_WIN_RANGE) - (out[j].type == UBITZ_WIN_RANGE);
+                if (!block && left + 1 > max_range) {
+                    continue; // no range comparator left: keep the mask windows
+                }
+                ranges = left + !block;
+                out[i].width_ok = out[i].width_ok && out[j].width_ok;
+                out[i].win.iowin = lo;
+                if (block) {
+                    out[i].type = UBITZ_WIN_MASK;
+                    out[i].win.mask = ~size_m1 & width_mask;
+                    out[i].limit = 0;
+                } else {
+                    out[i].type = UBITZ_WIN_RANGE;
+                    out[i].win.mask = 0;
+                    out[i].limit = hi;
+                }
+                out[j] = out[--count];
+                merged = true;
+                break;
+            }
+        }
+    }
+    return count;
+}
+
+// Build window map bindings; returns false on required-missing or collisions.
+bool ubitz_build_window_map(const ubitz_cpu_desc_t *cpu,
+                            const ubitz_dev_desc_t *devs, const uint8_t *slots,
+                            int dev_count, int max_range,
+                            ubitz_decode_binding_t *out, int *out_count) {
+    int o = 0;
+    // Collisions: identical mask+IOWin for different functions are undefined; reject.
+    for (int i = 0; i < 16; ++i) {
+        const ubitz_window_entry_t *wi = &cpu->window[i];
+        if (wi->function == 0x00) {
+            continue;
+        }
+        for (int j = i + 1; j < 16; ++j) {
+            const ubitz_window_entry_t *wj = &cpu->window[j];
+            if (wj->function == 0x00) {
+                continue;
+            }
+            if (wi->iowin == wj->iowin && wi->mask == wj->mask && wi->opsel == wj->opsel &&
+                (wi->function != wj->function || wi->instance != wj->instance)) {
+                return false; // ambiguous decode
+            }
+        }
+    }
+
+    for (int i = 0; i < 16; ++i) {
+        const ubitz_window_entry_t *w = &cpu->window[i];
+        if (w->function == 0x00) {
+            continue;
+        }
+        if (w->function == UBITZ_DOCK_IRQ_FUNCTION) {
+            out[o++] = (ubitz_decode_binding_t){ .win = *w, .slot = UBITZ_SLOT_DOCK,
+                                                 .width_ok = 1, .type = UBITZ_WIN_MASK };
+            continue;
+        }
+        int found = -1;
+        int found_inst = -1;
+        for (int d = 0; d < dev_count; ++d) {
+            for (int inst = 0; inst < 7; ++inst) {
+                if (devs[d].inst[inst].function == w->function &&
+                    devs[d].inst[inst].instance == w->instance) {
+                    found = d;
+                    found_inst = inst;
+                    break;
+                }
+            }
+            if (found >= 0) {
+                break;
+            }
+        }
+        if (found < 0) {
+            if (w->flags & UBITZ_WIN_FLAG_REQUIRED) {
+                return false; // required but missing
+            }
+            continue; // optional missing: ignore
+        }
+        uint8_t dev_width = devs[found].inst[found_inst].data_bus_width;
+        bool width_ok = dev_width <= cpu->data_bus_width;
+        out[o++] = (ubitz_decode_binding_t){ .win = *w, .slot = slots[found], .width_ok = width_ok,
+                                             .type = UBITZ_WIN_MASK };
+    }
+    // Merge touching windows of the same Function instance and target; a
+    // merge that would overlap a window with another target is refused.
+    o = merge_range_windows(out, o, cpu->addr_bus_width, max_range);
+    // Write order: highest mask specificity first (popcount of mask).
+    const uint32_t width_mask = addr_width_mask(cpu->addr_bus_width);
+    for (int i = 1; i < o; ++i) {
+        ubitz_decode_binding_t key = out[i];
+        int key_pc = binding_specificity(&key, width_mask);
+        int j = i - 1;
+        while (j >= 0 && binding_specificity(&out[j], width_mask) < key_pc) {
+            out[j + 1] = out[j];
+            --j;
+        }
+        out[j + 1] = key;
+    }
+    // Range bindings first, onto the windows with range comparators. A range
+    // never overlaps a binding with another target, so moving it up leaves
+    // the decode unchanged.
+    for (int i = 1; i < o; ++i) {
+        ubitz_decode_binding_t key = out[i];
+        int j = i - 1;
+        if (key.type != UBITZ_WIN_RANGE) {
+            continue;
+        }
+        while (j >= 0 && out[j].type != UBITZ_WIN_RANGE) {
+            out[j + 1] = out[j];
+            --j;
+        }
+        out[j + 1] = key;
+    }
+    *out_count = o;
+    return true;
+}
+
+static bool route_dup(const ubitz_introute_entry_t *a, const ubitz_introute_entry_t *b) {
+    return a->function == b->function && a->instance == b->instance && a->channel == b->channel;
+}
+
+bool ubitz_build_irq_map(const ubitz_cpu_desc_t *cpu,
+                         const ubitz_dev_desc_t *devs, const uint8_t *slots,
+                         int dev_count, ubitz_irq_binding_t *out, int *out_count) {
+    int o = 0;
+    // Reject duplicate routing entries.
+    for (int i = 0; i < 16; ++i) {
+        if (cpu->introute[i].function == 0x00) {
+            continue;
+        }
+        for (int j = i + 1; j < 16; ++j) {
+            if (cpu->introute[j].function == 0x00) {
+                continue;
+            }
+            if (route_dup(&cpu->introute[i], &cpu->introute[j])) {
+                return false;
+            }
+        }
+    }
+
+    // Ensure each declared device channel has routing.
+    for (int d = 0; d < dev_count; ++d) {
+        for (int inst = 0; inst < 7; ++inst) {
+            const uint8_t chmask = devs[d].inst[inst].int_channel;
+            if (chmask == 0) {
+                continue;
+            }
+            // INT_CH[0..3]
+            for (int bit = 0; bit < UBITZ_MAX_INT_CH; ++bit) {
+                if ((chmask & (1 << bit)) == 0) {
+                    continue;
+                }
+                bool ok = false;
+                for (int r = 0; r < 16; ++r) {
+                    const ubitz_introute_entry_t *e = &cpu->introute[r];
+                    if (e->function == 0x00) {
+                        continue;
+                    }
+                    if (e->function == devs[d].inst[inst].function &&
+                        e->instance == devs[d].inst[inst].instance &&
+                        (e->channel & (1 << bit))) {
+                        ok = true;
+                        out[o++] = (ubitz_irq_binding_t){ .route = *e, .slot = slots[d] };
+                        break;
+                    }
+                }
+                if (!ok) {
+                    return false;
+                }
+            }
+            // NMI_CH bit (0x10)
+            if (chmask & 0x10) {
+                bool ok = false;
+                for (int r = 0; r < 16; ++r) {
+                    const ubitz_introute_entry_t *e = &cpu->introute[r];
+                    if (e->function == 0x00) {
+                        continue;
+                    }
+                    if (e->function == devs[d].inst[inst].function &&
+                        e->instance == devs[d].inst[inst].instance &&
+                        (e->channel & 0x10)) {
+                        ok = true;
+                        out[o++] = (ubitz_irq_binding_t){ .route = *e, .slot = slots[d] };
+                        break;
+                    }
+                }
+                if (!ok) {
+                    return false;
+                }
+            }
+        }
+    }
+    // Write order: more specific channel bitmasks first (popcount of channel).
+    for (int i = 1; i < o; ++i) {
+        ubitz_irq_binding_t key = out[i];
+        int key_pc = popcount8(key.route.channel);
+        int j = i - 1;
+        while (j >= 0 && popcount8(out[j].route.channel) < key_pc) {
+            out[j + 1] = out[j];
+            --j;
+        }
+        out[j + 1] = key;
+    }
+    *out_count = o;
+    return true;
+}
+
+static bool memmap_present(const ubitz_cpu_memmap_t *m) {
+    return m && m->magic[0] == 'U' && m->magic[1] == 'M' && m->magic[2] == 'E' && m->magic[3] == 'M';
+}
+
+bool ubitz_build_mem_map(const ubitz_cpu_desc_t *cpu, const ubitz_cpu_memmap_t *memmap,
+                         const ubitz_bank_desc_t *bank,
+                         ubitz_mem_binding_t *out, int *out_count) {
+    uint8_t aw = cpu->addr_bus_width;
+    int o = 0;
+    if (memmap_present(memmap)) {
+        // Entries in table order: the CPU card lists overlays before what they cover.
+        for (int i = 0; i < UBITZ_MAX_MEM_REGIONS; ++i) {
+            const ubitz_mem_entry_t *m = &memmap->region[i];
+            if (m->space == UBITZ_MEM_UNUSED) {
+                continue;
+            }
+            if (m->space > UBITZ_MEM_ROM2 || m->size_log2 > aw || m->size_log2 > 31) {
+                return false;
+            }
+            uint32_t span = (1u << m->size_log2) - 1u;
+            if ((m->base & span) || (m->base & ~addr_width_mask(aw))) {
+                return false;
+            }
+            uint8_t bank_w = (m->space == UBITZ_MEM_RAM) ? bank->ram_addr_width : bank->rom_addr_width;
+            if (bank_w == 0) {
+                return false;
+            }
+            out[o].base      = m->base;
+            out[o].size_log2 = m->size_log2;
+            out[o].space     = m->space;
+            ++o;
+        }
+        *out_count = o;
+        return true;
+    }
+    // No memory map: ROM0 over RAM, each as large as the Bank implements (up to
+    // the Host address space). ROM0 sits where the CPU fetches its reset
+    // vector: the top of memory on the 6502 and 6809, address 0 otherwise.
+    // SIZE stops at 31, so a full 32-bit RAM takes two halves.
+    uint8_t cap   = (aw > 31) ? 31 : aw;
+    uint8_t rom_w = (bank->rom_addr_width > cap) ? cap : bank->rom_addr_width;
+    uint8_t ram_w = (bank->ram_addr_width > cap) ? cap : bank->ram_addr_width;
+    if (rom_w) {
+        bool top = (cpu->cpu_type == UBITZ_CPU_6502 || cpu->cpu_type == UBITZ_CPU_6809);
+        out[o].base      = top ? (addr_width_mask(aw) & ~((1u << rom_w) - 1u)) : 0;
+        out[o].size_log2 = rom_w;
+        out[o].space     = UBITZ_MEM_ROM0;
+        ++o;
+    }
+    if (ram_w) {
+        out[o].base      = 0;
+        out[o].size_log2 = ram_w;
+        out[o].space     = UBITZ_MEM_RAM;
+        ++o;
+    }
+    if (ram_w == 31 && aw > 31 && bank->ram_addr_width > 31) {
+        out[o].base      = 0x80000000u;
+        out[o].size_log2 = 31;
+        out[o].space     = UBITZ_MEM_RAM;
+        ++o;
+    }
+    *out_count = o;
+    return true;
+}
+
+bool ubitz_chain_split_map(int hop, const uint8_t *bridge_slot, uint8_t num_int_ch,
+                           const ubitz_decode_binding_t *wins, int win_count,
+                           const ubitz_irq_binding_t *irqs, int irq_count,
+                           ubitz_decode_binding_t *out_wins, int *out_win_count,
+                           ubitz_irq_binding_t *out_irqs, int *out_irq_count) {
+    int o = 0;
+    // Windows keep their order, so priority between targets is unchanged.
+    for (int i = 0; i < win_count; ++i) {
+        ubitz_decode_binding_t b = wins[i];
+        // DOCK windows: instance h is the IRQ status window of Dock h.
+        bool dock = (b.slot == UBITZ_SLOT_DOCK);
+        int tgt = dock ? b.win.instance : (b.slot >> 3);
+        if (tgt < hop || (tgt > hop && bridge_slot[hop] == UBITZ_NO_BRIDGE)) {
+            continue;
+        }
+        if (tgt > hop) {
+            b.slot = bridge_slot[hop];
+            b.bridge = 1;
+            b.win.flags &= (uint8_t)~UBITZ_WIN_FLAG_POSTED; // the leaf Dock posts
+        } else if (!dock) {
+            b.slot &= 0x07;
+        }
+        out_wins[o++] = b;
+    }
+    *out_win_count = o;
+
+    o = 0;
+    for (int i = 0; i < irq_count; ++i) {
+        ubitz_irq_binding_t b = irqs[i];
+        int tgt = b.slot >> 3;
+        if (tgt < hop || (tgt > hop && bridge_slot[hop] == UBITZ_NO_BRIDGE)) {
+            continue;
+        }
+        bool nmi = (b.route.channel & 0x10) != 0;
+        if (!nmi && (b.route.dest_pin & 0x0F) >= num_int_ch && tgt > 0) {
+            return false; // no bridge channel carries this CPU pin
+        }
+        if (tgt > hop) {
+            // Bridge slot channel = the downstream Dock's CPU pin; rate limit at the leaf.
+            b.slot = bridge_slot[hop];
+            b.route.channel = nmi ? 0x10 : (uint8_t)(1u << (b.route.dest_pin & 0x0F));
+            b.route.coalesce = 0;
+        } else {
+            b.slot &= 0x07;
+        }
+        if (nmi && hop > 0) {
+            b.route.dest_pin = 0x10; // only NMI 0 is wired upstream
+        }
+        out_irqs[o++] = b;
+    }
+    *out_irq_count = o;
+    return true;
+}
+
+uint8_t ubitz_map_slot_byte(const ubitz_decode_binding_t *b) {
+    uint8_t type = (b->type == UBITZ_WIN_RANGE) ? 0x80 : 0x00;
+    if (b->slot == UBITZ_SLOT_DOCK) {
+        return 0x20 | type;
+    }
+    if (b->bridge) {
+        return 0x10 | (b->slot & 0x07) | type;
+    }
+    return (b->slot & 0x07) | type | ((b->win.flags & UBITZ_WIN_FLAG_POSTED) ? 0x40 : 0x00);
+}
+
+uint8_t ubitz_map_op_byte(uint8_t opsel) {
+    if (opsel == UBITZ_OP_READ) {
+        return 0x01;
+    }
+    if (opsel == UBITZ_OP_WRITE) {
+        return 0x00;
+    }
+    return 0xFF; // ANY
+}
+
+uint8_t ubitz_map_route_byte(uint8_t dest_pin) {
+    return 0x80 | (dest_pin & 0x0F); // bit7 enable, low nibble dest
+}
+
+uint8_t ubitz_map_mem_attr(const ubitz_mem_binding_t *b) {
+    return 0x80 | ((b->space & 0x03) << 5) | (b->size_log2 & 0x1F);
+}
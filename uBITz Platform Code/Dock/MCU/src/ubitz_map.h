@@ -0,0 +1,191 @@
+#pragma once
+// uBITz descriptor and binding types, the window / IRQ map builders and the
+// CPLD config-bus encoding of a binding. Free of ESP-IDF dependencies so host
+// tools (the Dock emulator in ../../Emu) build the same tables as the Dock.
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UBITZ_MAX_TILES       8   // upper bound; the Dock build reports its slot count
+#define UBITZ_MAX_WINDOWS     16
+#define UBITZ_MAX_IRQ_ROUTES  32
+#define UBITZ_MAX_INT_CH      4   // INT_CH[3:0] = channel bits 0-3; bit 4 = NMI
+#define UBITZ_MAX_MEM_REGIONS 7   // entries of the CPU card memory map
+
+typedef enum { UBITZ_OP_ANY = 0xFF, UBITZ_OP_READ = 0x01, UBITZ_OP_WRITE = 0x00 } ubitz_opsel_t;
+// Window entry flags.
+#define UBITZ_WIN_FLAG_REQUIRED  0x01
+#define UBITZ_WIN_FLAG_POSTED    0x02  // writes may be posted (Dock releases /READY early)
+
+// Vendor-specific window Function answered by the Dock itself: the IRQ status
+// window (cause / pending / mask). Bound to UBITZ_SLOT_DOCK, not to a Tile.
+#define UBITZ_DOCK_IRQ_FUNCTION  0x11
+#define UBITZ_SLOT_DOCK          0x20  // binding slot value: Dock registers (decoder SLOT bit 5)
+
+// Chained Docks: a bridge card in a slot forwards that slot's windows to a
+// downstream Dock. Tiles of a chain are numbered hop * 8 + slot while the map
+// is built; ubitz_chain_split_map() turns that into one map per Dock.
+#define UBITZ_MAX_HOPS           4   // Docks in a chain, head included
+#define UBITZ_CHAIN_SLOT(hop, slot)  ((uint8_t)(((hop) << 3) | ((slot) & 0x07)))
+#define UBITZ_NO_BRIDGE          0xFF
+
+// Decoder window type: BASE/MASK equality or inclusive BASE/LIMIT range.
+typedef enum { UBITZ_WIN_MASK = 0, UBITZ_WIN_RANGE = 1 } ubitz_wintype_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  function;
+    uint8_t  instance;
+    uint32_t iowin;
+    uint32_t mask;
+    uint8_t  opsel;
+    uint8_t  flags;   // bit0: Required, bit1: Posted writes allowed
+    uint8_t  reserved[2];
+} ubitz_window_entry_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t function;
+    uint8_t instance;
+    uint8_t channel;   // bitfield per spec
+    uint8_t dest_pin;  // 0-3 = CPU_INT, 0x10-0x11 = CPU_NMI
+    uint8_t mode;      // 0=edge, 1=level
+    uint8_t stretch_us;
+    uint8_t coalesce;  // Dock rate limit: bit7 0=min gap/1=hold-off, [6:0] ticks (0=off)
+    uint8_t reserved[1];
+} ubitz_introute_entry_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  magic[4];      // "UPCI"
+    uint8_t  version;
+    uint8_t  device_type;   // 0x01=CPU
+    uint8_t  reserved1[10];
+    char     manufacturer[16];
+    char     platform_id[28];
+    uint8_t  cpu_type;
+    uint8_t  data_bus_width;
+    uint8_t  addr_bus_width;
+    uint8_t  int_ack_mode;
+    ubitz_window_entry_t   window[16];
+    ubitz_introute_entry_t introute[16];
+} ubitz_cpu_desc_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  magic[4];      // "UPCI"
+    uint8_t  version;
+    uint8_t  device_type;   // 0x02 = Peripheral
+    uint8_t  reserved1[10];
+    struct {
+        uint8_t function;
+        uint8_t instance;
+        uint8_t data_bus_width;
+        uint8_t addr_bus_width;
+        uint8_t int_ack_mode;
+        uint8_t int_channel;   // bitmask per spec
+        uint8_t hw_version;
+        uint8_t fw_version;
+        char    name[16];
+        uint8_t reserved2[7];
+    } inst[7];
+    uint8_t reserved3[16];
+} ubitz_dev_desc_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t  magic[4];       // "UPCI"
+    uint8_t  spec_version;   // Must be 0x01 for this layout
+    uint8_t  device_type;    // 0x03 = Bank (Memory Board)
+    uint8_t  reserved1[10];
+    char     vendor_id[16];
+    char     board_id[16];
+    uint8_t  bank_revision;
+    uint8_t  ram_addr_width;
+    uint8_t  rom_addr_width;
+    uint8_t  data_bus_width; // Must equal Host data bus width
+    uint8_t  reserved2[204];
+} ubitz_bank_desc_t;
+
+// CPU types with their reset vector at the top of memory (CPUType field)
+#define UBITZ_CPU_6502           0x04
+#define UBITZ_CPU_6809           0x05
+
+// Bank memory spaces, selected by /MEM0_CS and /MEM1_CS (Dock spec 0.10)
+typedef enum {
+    UBITZ_MEM_RAM = 0, UBITZ_MEM_ROM0 = 1, UBITZ_MEM_ROM1 = 2, UBITZ_MEM_ROM2 = 3
+} ubitz_memspace_t;
+#define UBITZ_MEM_UNUSED         0xFF  // memory map entry not in use
+
+// Optional memory map of the CPU card: 64 bytes after the 416-byte CPU
+// descriptor in its EEPROM. Lists the Bank regions the Dock decodes for
+// /MREQ cycles; without it they are derived from the Bank descriptor.
+typedef struct __attribute__((packed)) {
+    uint32_t base;
+    uint8_t  size_log2;   // region of 2^size_log2 bytes, base aligned to it
+    uint8_t  space;       // ubitz_memspace_t, UBITZ_MEM_UNUSED = empty
+    uint8_t  reserved[2];
+} ubitz_mem_entry_t;
+
+typedef struct __attribute__((packed)) {
+    uint8_t           magic[4];   // "UMEM"
+    ubitz_mem_entry_t region[UBITZ_MAX_MEM_REGIONS];
+    uint8_t           reserved[4];
+} ubitz_cpu_memmap_t;
+
+typedef struct {
+    ubitz_window_entry_t  win;
+    uint8_t               slot;
+    uint8_t               width_ok;   // 1 if device width <= CPU width
+    uint8_t               type;       // ubitz_wintype_t; RANGE uses win.iowin..limit
+    uint32_t              limit;      // inclusive upper bound for RANGE windows
+    uint8_t               bridge;     // 1: slot holds a bridge card (decoder SLOT bit 4)
+} ubitz_decode_binding_t;
+
+typedef struct {
+    ubitz_introute_entry_t route;
+    uint8_t                slot;
+} ubitz_irq_binding_t;
+
+// Bank region, in decode priority order (the first match wins)
+typedef struct {
+    uint32_t base;
+    uint8_t  size_log2;
+    uint8_t  space;       // ubitz_memspace_t
+} ubitz_mem_binding_t;
+
+// Window bindings, most specific first. Touching windows of one Function
+// instance are merged, into at most max_range BASE/LIMIT ranges (the fewest
+// range comparators of the Docks the map is for); ranges come first so they
+// land on windows 0..max_range-1.
+bool    ubitz_build_window_map(const ubitz_cpu_desc_t *cpu,
+                               const ubitz_dev_desc_t *devs, const uint8_t *slots,
+                               int dev_count, int max_range,
+                               ubitz_decode_binding_t *out, int *out_count);
+bool    ubitz_build_irq_map(const ubitz_cpu_desc_t *cpu,
+                            const ubitz_dev_desc_t *devs, const uint8_t *slots,
+                            int dev_count, ubitz_irq_binding_t *out, int *out_count);
+// Bank regions from the CPU memory map; with NULL or a map without the
+// "UMEM" magic, ROM0 over RAM sized from the Bank descriptor. Fails on
+// misaligned or out-of-range regions and on spaces the Bank does not have.
+bool    ubitz_build_mem_map(const ubitz_cpu_desc_t *cpu, const ubitz_cpu_memmap_t *memmap,
+                            const ubitz_bank_desc_t *bank,
+                            ubitz_mem_binding_t *out, int *out_count);
+
+// Split a chain map (slots numbered UBITZ_CHAIN_SLOT) into the map of one Dock.
+// bridge_slot[h] is the slot of Dock h holding the bridge to Dock h + 1
+// (UBITZ_NO_BRIDGE on the last Dock). The IRQ status window with instance h
+// belongs to Dock h. Windows of later Docks become BRIDGE windows to
+// bridge_slot[hop] (never posted); IRQ routes of later Docks pass through the bridge slot on the
+// same CPU pin, which must therefore be one of its num_int_ch channels (NMIs
+// use the downstream Dock's NMI 0). Returns false if a route cannot pass.
+bool    ubitz_chain_split_map(int hop, const uint8_t *bridge_slot, uint8_t num_int_ch,
+                              const ubitz_decode_binding_t *wins, int win_count,
+                              const ubitz_irq_binding_t *irqs, int irq_count,
+                              ubitz_decode_binding_t *out_wins, int *out_win_count,
+                              ubitz_irq_binding_t *out_irqs, int *out_irq_count);
+
+// Decoder SLOT byte of a binding: slot[2:0], bit7 TYPE (range), bit6 POSTED,
+// bit4 BRIDGE, or bit5 DOCK (plus TYPE) for UBITZ_SLOT_DOCK bindings.
+uint8_t ubitz_map_slot_byte(const ubitz_decode_binding_t *b);
+// Decoder OP byte for a window OpSel: 0xFF any, 0x01 read, 0x00 write.
+uint8_t ubitz_map_op_byte(uint8_t opsel);
+// irq_router INT/NMI route entry: bit7 enable, [3:0] CPU pin index.
+uint8_t ubitz_map_route_byte(uint8_t dest_pin);
+// Bank region ATTR byte: bit7 enable, [6:5] space, [4:0] size log2.
+uint8_t ubitz_map_mem_attr(const ubitz_mem_binding_t *b);
@@ -5,6 +5,10 @@
 #include "esp_log.h"
 #include "esp_system.h"
 #include "ubitz_enumerator.h"
+#include "ubitz_cpld_cfg.h"
+#include "ubitz_dock_svc.h"
+#include "ubitz_fpga.h"
+#include <stdlib.h>
 #include <string.h>
 
 static const char *TAG = "ubitz_monitor";
@@ -22,6 +26,11 @@ static const char *fail_reason_str(ubitz_enum_fail_t r) {
     case UBITZ_ENUM_ROUTE_MISSING: return "route_missing";
     case UBITZ_ENUM_DEV_WIDTH_INCOMPAT: return "dev_width_incompat";
     case UBITZ_ENUM_I2C_ERROR: return "i2c_error";
+    case UBITZ_ENUM_CHAIN_LINK_FAIL: return "chain_link_fail";
+    case UBITZ_ENUM_FPGA_CONFIG_FAIL: return "fpga_config_fail";
+    case UBITZ_ENUM_MEM_MAP_BAD: return "mem_map_bad";
+    case UBITZ_ENUM_DECODER_FULL: return "decoder_full";
+    case UBITZ_ENUM_CHAIN_MAP_FAIL: return "chain_map_fail";
     default: return "unknown_fail";
     }
 }
@@ -75,8 +84,9 @@ static void print_host(const ubitz_enum_snapshot_t *snap) {
             continue;
         }
         snprintf(buf, sizeof(buf),
-                 "irq[%d]: func=0x%02X inst=%d chan=0x%02X dest=0x%02X mode=%u stretch=%u\r\n",
-                 i, r->function, r->instance, r->channel, r->dest_pin, r->mode, r->stretch_us);
+                 "irq[%d]: func=0x%02X inst=%d chan=0x%02X dest=0x%02X mode=%u stretch=%u coal=0x%02X\r\n",
+                 i, r->function, r->instance, r->channel, r->dest_pin, r->mode, r->stretch_us,
+                 r->coalesce);
         uart_write(buf);
     }
 }
@@ -97,15 +107,235 @@ static void print_errors(const ubitz_enum_snapshot_t *snap) {
     uart_write(buf);
     // Windows with width_ok flag (if populated)
     for (int i = 0; i < snap->window_count; ++i) {
+        const ubitz_decode_binding_t *b = &snap->windows[i];
+        if (b->type == UBITZ_WIN_RANGE) {
+            snprintf(buf, sizeof(buf),
+                     "winbind[%d]: func=0x%02X inst=%d slot=%d range=0x%08lX-0x%08lX width_ok=%d\r\n",
+                     i, b->win.function, b->win.instance, b->slot,
+                     b->win.iowin, b->limit, b->width_ok);
+        } else {
+            snprintf(buf, sizeof(buf),
+                     "winbind[%d]: func=0x%02X inst=%d slot=%d mask_pop=%d width_ok=%d\r\n",
+                     i, b->win.function, b->win.instance, b->slot,
+                     __builtin_popcount(b->win.mask), b->width_ok);
+        }
+        uart_write(buf);
+    }
+}
+
+// Per-route coalescing counters since the previous irqstat (read clears them).
+static void print_irqstat(const ubitz_enum_snapshot_t *snap) {
+    char buf[128];
+    for (int i = 0; i < snap->irq_route_count; ++i) {
+        const ubitz_irq_binding_t *b = &snap->irq_routes[i];
+        for (int ch = 0; ch < ubitz_cpld_get_caps()->num_int_ch && ch < UBITZ_MAX_INT_CH; ++ch) {
+            if ((b->route.channel & (1 << ch)) == 0) {
+                continue;
+            }
+            uint8_t delivered = 0, coalesced = 0;
+            ubitz_cpld_read_irq_coal_stats(b->slot, ch, &delivered, &coalesced);
+            snprintf(buf, sizeof(buf),
+                     "irqstat: slot=%d ch=%d coal=0x%02X delivered=%u coalesced=%u\r\n",
+                     b->slot, ch, b->route.coalesce, delivered, coalesced);
+            uart_write(buf);
+        }
+    }
+}
+
+static void print_caps(void) {
+    const ubitz_cpld_caps_t *c = ubitz_cpld_get_caps();
+    char buf[192];
+    snprintf(buf, sizeof(buf),
+             "caps: present=%d ver=%u addr_w=%u win=%u range_win=%u slots=%u int_ch=%u "
+             "cpu_int=%u cpu_nmi=%u features=0x%02X\r\n",
+             c->present, c->version, c->addr_w, c->num_win, c->num_range_win, c->num_slots,
+             c->num_int_ch, c->num_cpu_int, c->num_cpu_nmi, c->features);
+    uart_write(buf);
+    const ubitz_fpga_variant_t *v = ubitz_fpga_loaded();
+    if (v) {
+        snprintf(buf, sizeof(buf), "bitstream: %s addr_w=%u win=%u slots=%u\r\n",
+                 v->part->label, v->addr_w, v->num_win, v->num_slots);
+    } else {
+        snprintf(buf, sizeof(buf), "bitstream: iCE40 configuration flash\r\n");
+    }
+    uart_write(buf);
+    snprintf(buf, sizeof(buf),
+             "layout: cfg_bytes=%u base=0x%02X mask=0x%02X slot=0x%02X op=0x%02X "
+             "irq_base=0x%02X nmi=+%u coal=+%u snap=+%u tick_w=%u trace=0x%02X depth=%u\r\n",
+             c->cfg_bytes, c->base_off, c->mask_off, c->slot_off, c->op_off,
+             c->irq_base, c->nmi_off, c->coal_off, c->coal_snap, c->coal_tick_w,
+             c->trace_base, c->trace_depth_log2 ? (1u << c->trace_depth_log2) : 0u);
+    uart_write(buf);
+    if (c->features & UBITZ_CAP_FEAT_SVC) {
+        snprintf(buf, sizeof(buf), "services: slot=%u fifo=%u\r\n",
+                 c->svc_slot, 1u << c->svc_fifo_log2);
+        uart_write(buf);
+    }
+    if (c->features & UBITZ_CAP_FEAT_CFG_INIT) {
+        snprintf(buf, sizeof(buf), "baked map: sum=0x%04X\r\n", c->cfg_init_sum);
+        uart_write(buf);
+    }
+    if (c->num_mem_region) {
+        snprintf(buf, sizeof(buf), "bank regions: %u at 0x%02X\r\n",
+                 c->num_mem_region, c->mem_off);
+        uart_write(buf);
+    }
+}
+
+// Dock services mailbox levels and flags.
+static void print_svcstat(void) {
+    char buf[128];
+    ubitz_svc_status_t st;
+    if (ubitz_svc_status(&st) != ESP_OK) {
+        uart_write("svcstat: services slot not available\r\n");
+        return;
+    }
+    snprintf(buf, sizeof(buf), "svcstat: h2m=%u m2h_free=%u flags=0x%02X%s%s\r\n",
+             st.h2m_count, st.m2h_free, st.flags,
+             (st.flags & UBITZ_SVC_S_MCU_READY) ? " ready" : "",
+             (st.flags & UBITZ_SVC_S_TX_OVF) ? " host_overflow" : "");
+    uart_write(buf);
+}
+
+// Enumerated bindings in gen_cfg_init.sh map-file syntax, to bake as the
+// power-on map, with its checksum against the one baked into this build.
+static void print_cfgmap(const ubitz_enum_snapshot_t *snap) {
+    const ubitz_cpld_caps_t *c = ubitz_cpld_get_caps();
+    char buf[128];
+    uint16_t sum = ubitz_cpld_map_sum(snap->windows, snap->window_count,
+                                      snap->irq_routes, snap->irq_route_count,
+                                      snap->mem_regions, snap->mem_region_count);
+    if (c->features & UBITZ_CAP_FEAT_CFG_INIT) {
+        snprintf(buf, sizeof(buf), "# sum=0x%04X baked=0x%04X%s\r\n", sum, c->cfg_init_sum,
+                 sum == c->cfg_init_sum ? " (match)" : " (patched)");
+    } else {
+        snprintf(buf, sizeof(buf), "# sum=0x%04X (no baked map in this build)\r\n", sum);
+    }
+    uart_write(buf);
+    for (int i = 0; i < snap->window_count; ++i) {
+        const ubitz_decode_binding_t *b = &snap->windows[i];
+        char slot[8];
+        if (b->slot == UBITZ_SLOT_DOCK) {
+            snprintf(slot, sizeof(slot), "dock");
+        } else {
+            snprintf(slot, sizeof(slot), "%u", b->slot);
+        }
+        snprintf(buf, sizeof(buf), "win %d 0x%lX 0x%lX %s %s%s%s%s\r\n", i,
+                 (unsigned long)b->win.iowin,
+                 (unsigned long)(b->type == UBITZ_WIN_RANGE ? b->limit : b->win.mask), slot,
+                 b->win.opsel == UBITZ_OP_READ ? "rd" : b->win.opsel == UBITZ_OP_WRITE ? "wr" : "any",
+                 b->type == UBITZ_WIN_RANGE ? " range" : "",
+                 (b->win.flags & UBITZ_WIN_FLAG_POSTED) ? " posted" : "",
+                 b->bridge ? " bridge" : "");
+        uart_write(buf);
+    }
+    for (int i = 0; i < snap->irq_route_count; ++i) {
+        const ubitz_irq_binding_t *b = &snap->irq_routes[i];
+        for (int ch = 0; ch < c->num_int_ch && ch < UBITZ_MAX_INT_CH; ++ch) {
+            if (b->route.channel & (1 << ch)) {
+                snprintf(buf, sizeof(buf), "int %u %d %u coal=0x%02X\r\n",
+                         b->slot, ch, b->route.dest_pin & 0x0F, b->route.coalesce);
+                uart_write(buf);
+            }
+        }
+        if (b->route.channel & 0x10) {
+            uint8_t dest = b->route.dest_pin;
+            snprintf(buf, sizeof(buf), "nmi %u %u\r\n", b->slot, (dest >= 0x10) ? dest - 0x10 : dest);
+            uart_write(buf);
+        }
+    }
+    static const char *const space_names[] = {"ram", "rom0", "rom1", "rom2"};
+    for (int i = 0; i < snap->mem_region_count && i < c->num_mem_region; ++i) {
+        const ubitz_mem_binding_t *m = &snap->mem_regions[i];
+        snprintf(buf, sizeof(buf), "mem %d 0x%lX %u %s\r\n", i, (unsigned long)m->base,
+                 m->size_log2, space_names[m->space & 3]);
+        uart_write(buf);
+    }
+}
+
+// bustrace            dump the trace (stops recording)
+// bustrace run        clear and record continuously
+// bustrace arm [addr=X] [mask=X] [unmapped] [vec] [wait=N] [rd|wr] [posted] [post=N]
+//                     clear and freeze post=N cycles after the first matching cycle
+// bustrace off        stop recording
+static ubitz_trace_entry_t s_trace[256];
+
+static void print_bustrace(void) {
+    char buf[160];
+    uint8_t st = ubitz_cpld_trace_status();
+    int n = ubitz_cpld_trace_read(s_trace, sizeof(s_trace) / sizeof(s_trace[0]));
+    snprintf(buf, sizeof(buf), "bustrace: %d entries%s%s\r\n", n,
+             (st & UBITZ_TRACE_S_TRIGGERED) ? " triggered" : "",
+             (st & UBITZ_TRACE_S_FROZEN) ? " frozen" : "");
+    uart_write(buf);
+    for (int i = 0; i < n; ++i) {
+        const ubitz_trace_entry_t *t = &s_trace[i];
+        uint32_t dt = i ? ((t->timestamp - s_trace[i - 1].timestamp) & 0xFFFFFF) : 0;
         snprintf(buf, sizeof(buf),
-                 "winbind[%d]: func=0x%02X inst=%d slot=%d mask_pop=%d width_ok=%d\r\n",
-                 i, snap->windows[i].win.function, snap->windows[i].win.instance,
-                 snap->windows[i].slot, __builtin_popcount(snap->windows[i].win.mask),
-                 snap->windows[i].width_ok);
+                 "%3d t=%8lu dt=%6lu %c addr=0x%08lX win=%2u slot=%u wait=%3u%s%s%s%s\r\n",
+                 i, (unsigned long)t->timestamp, (unsigned long)dt,
+                 (t->flags & UBITZ_TRACE_F_READ) ? 'R' : 'W', (unsigned long)t->addr,
+                 t->win, t->slot, t->wait,
+                 (t->flags & UBITZ_TRACE_F_UNMAPPED) ? " unmapped" : "",
+                 (t->flags & UBITZ_TRACE_F_VECTOR) ? " vector" : "",
+                 (t->flags & UBITZ_TRACE_F_POSTED) ? " posted" : "",
+                 (t->flags & UBITZ_TRACE_F_TRIGGER) ? " <trigger" : "");
         uart_write(buf);
     }
 }
 
+static void handle_bustrace(const char *args) {
+    if (!(ubitz_cpld_get_caps()->features & UBITZ_CAP_FEAT_TRACE)) {
+        uart_write("bustrace: not in this Dock build\r\n");
+        return;
+    }
+    while (*args == ' ') {
+        ++args;
+    }
+    if (*args == 0) {
+        print_bustrace();
+    } else if (strcmp(args, "off") == 0) {
+        ubitz_cpld_trace_stop();
+    } else if (strcmp(args, "run") == 0) {
+        ubitz_cpld_trace_start(NULL);
+    } else if (strncmp(args, "arm", 3) == 0) {
+        ubitz_trace_trigger_t trig = { .mask = 0xFFFFFFFF };
+        char tmp[128];
+        char *save = NULL;
+        strncpy(tmp, args + 3, sizeof(tmp) - 1);
+        tmp[sizeof(tmp) - 1] = 0;
+        for (char *tok = strtok_r(tmp, " ", &save); tok; tok = strtok_r(NULL, " ", &save)) {
+            if (strncmp(tok, "addr=", 5) == 0) {
+                trig.qual |= UBITZ_TRACE_Q_ADDR;
+                trig.addr = strtoul(tok + 5, NULL, 0);
+            } else if (strncmp(tok, "mask=", 5) == 0) {
+                trig.mask = strtoul(tok + 5, NULL, 0);
+            } else if (strncmp(tok, "wait=", 5) == 0) {
+                trig.qual |= UBITZ_TRACE_Q_WAIT;
+                trig.wait_thr = (uint8_t)strtoul(tok + 5, NULL, 0);
+            } else if (strncmp(tok, "post=", 5) == 0) {
+                trig.post_cnt = (uint8_t)strtoul(tok + 5, NULL, 0);
+            } else if (strcmp(tok, "unmapped") == 0) {
+                trig.qual |= UBITZ_TRACE_Q_UNMAPPED;
+            } else if (strcmp(tok, "vec") == 0) {
+                trig.qual |= UBITZ_TRACE_Q_VECTOR;
+            } else if (strcmp(tok, "rd") == 0) {
+                trig.qual |= UBITZ_TRACE_Q_READ;
+            } else if (strcmp(tok, "wr") == 0) {
+                trig.qual |= UBITZ_TRACE_Q_WRITE;
+            } else if (strcmp(tok, "posted") == 0) {
+                trig.qual |= UBITZ_TRACE_Q_POSTED;
+            } else {
+                uart_write("bustrace: unknown trigger term\r\n");
+                return;
+            }
+        }
+        ubitz_cpld_trace_start(&trig);
+    } else {
+        uart_write("bustrace: usage bustrace [run|off|arm ...]\r\n");
+    }
+}
+
 static void handle_command(const char *cmd) {
     const ubitz_enum_snapshot_t *snap = ubitz_snapshot_get();
     if (strcmp(cmd, "lstiles") == 0) {
@@ -116,6 +346,16 @@ static void handle_command(const char *cmd) {
         print_bank(snap);
     } else if (strcmp(cmd, "showerrors") == 0) {
         print_errors(snap);
+    } else if (strcmp(cmd, "caps") == 0) {
+        print_caps();
+    } else if (strcmp(cmd, "irqstat") == 0) {
+        print_irqstat(snap);
+    } else if (strcmp(cmd, "svcstat") == 0) {
+        print_svcstat();
+    } else if (strcmp(cmd, "cfgmap") == 0) {
+        print_cfgmap(snap);
+    } else if (strncmp(cmd, "bustrace", 8) == 0 && (cmd[8] == 0 || cmd[8] == ' ')) {
+        handle_bustrace(cmd + 8);
     } else if (strcmp(cmd, "reset") == 0) {
         uart_write("resetting platform + MCU...\r\n");
         ubitz_reset_assert();
@@ -6,14 +6,18 @@
 #define UBITZ_I2C_SCL_PIN   0   // default SCL0
 #define UBITZ_I2C_SDA_PIN   1   // default SDA0
 
+// Dock link role strap: low = downstream Dock of a chain (I2C target on its
+// segment, see ubitz_chain.h), high/open = head or standalone Dock
+#define UBITZ_LINK_ROLE_GPIO 2
+
 // Platform reset (/RESET drives Host/Bank/Tiles/decoder), active-low
 #define UBITZ_RESET_GPIO    21
 
 // CPLD configuration bus (address decoder / IRQ router)
 #define UBITZ_CFG_CLK_GPIO   33
-#define UBITZ_CFG_WE_GPIO    34   // Decoder cfg_we
-#define UBITZ_CFG_WR_GPIO    35   // IRQ cfg_wr_en
-#define UBITZ_CFG_RD_GPIO    36   // IRQ cfg_rd_en (unused in current HDL)
+#define UBITZ_CFG_WE_GPIO    34   // cfg_we (decoder; IRQ too on builds with a capability block)
+#define UBITZ_CFG_WR_GPIO    35   // IRQ cfg_wr_en (standalone irq_router builds only)
+#define UBITZ_CFG_RD_GPIO    36   // cfg_re / cfg_rd_en: capability + IRQ readback
 #define UBITZ_CFG_ADDR0_GPIO 37
 #define UBITZ_CFG_ADDR1_GPIO 38
 #define UBITZ_CFG_ADDR2_GPIO 39
@@ -31,6 +35,20 @@
 #define UBITZ_CFG_DATA6_GPIO 19
 #define UBITZ_CFG_DATA7_GPIO 20
 
+// Dock services slot mailbox (SPI master to the CPLD, H2M-not-empty IRQ)
+#define UBITZ_SVC_SPI_CS_GPIO   10
+#define UBITZ_SVC_SPI_MOSI_GPIO 11
+#define UBITZ_SVC_SPI_SCK_GPIO  12
+#define UBITZ_SVC_SPI_MISO_GPIO 13
+#define UBITZ_SVC_IRQ_GPIO      14
+
+// iCE40 configuration (SPI slave mode, bitstream variants from flash)
+#define UBITZ_FPGA_CRESET_GPIO  4    // CRESET_B, active-low
+#define UBITZ_FPGA_CDONE_GPIO   5
+#define UBITZ_FPGA_SS_GPIO      6    // SPI_SS_B, driven by hand across the bitstream
+#define UBITZ_FPGA_SCK_GPIO     7
+#define UBITZ_FPGA_MOSI_GPIO    8
+
 // UART monitor (command interface)
 #define UBITZ_MONITOR_TX_PIN 17
 #define UBITZ_MONITOR_RX_PIN 18